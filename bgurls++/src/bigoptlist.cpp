@@ -21,14 +21,14 @@ void BGurlsOptionsList::init(const std::string& sharedDir, bool usedefopt)
 
     if(usedefopt)
     {
-        (*table)["nb_pred"] = new OptNumber(1);
-        (*table)["memlimit"] = new OptNumber(std::pow(2.0, 30)); // default 1 GB
+        addOpt("nb_pred", new OptNumber(1));
+        addOpt("memlimit", new OptNumber(std::pow(2.0, 30))); // default 1 GB
 
-        (*table)["shared_dir"] = new OptString(sharedDir);
+        addOpt("shared_dir", new OptString(sharedDir));
 
         path sharedDirPath(sharedDir);
 
-        (*table)["tmpfile"] = new OptString(path(sharedDirPath / "tmp").native());
+        addOpt("tmpfile", new OptString(path(sharedDirPath / "tmp").native()));
 
         GurlsOptionsList* files = new GurlsOptionsList("files");
         files->addOpt("Xva_filename", path(sharedDirPath / "Xva.h5").native());
@@ -42,7 +42,7 @@ void BGurlsOptionsList::init(const std::string& sharedDir, bool usedefopt)
         files->addOpt("optimizer_C_filename", path(sharedDirPath / "optimizer_C.h5").native());
         files->addOpt("optimizer_X_filename", path(sharedDirPath / "optimizer_X.h5").native());
 
-        (*table)["files"] = files;
+        addOpt("files", files);
 
     }
 }
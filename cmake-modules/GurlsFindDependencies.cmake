@@ -133,6 +133,29 @@ if(GURLS_USE_EXTERNAL_BOOST) #if GURLS_USE_EXTERNAL_BOOST was enabled by the use
     include(BuildBoost)
 endif()
 
+# boost::mutex needs the system threads library
+find_package(Threads)
+
+
+#################### OPENMP
+
+# The blocked kernel evaluations, the random features and the text parsers split their work
+# among OpenMP threads; without OpenMP the same code runs on a single thread
+option(GURLS_USE_OPENMP "Parallelize the blocked computations with OpenMP" ON)
+
+if(GURLS_USE_OPENMP)
+    find_package(OpenMP)
+
+    if(OPENMP_FOUND)
+        set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${OpenMP_C_FLAGS}")
+        set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${OpenMP_CXX_FLAGS}")
+        set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${OpenMP_CXX_FLAGS}")
+        set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${OpenMP_CXX_FLAGS}")
+    else(OPENMP_FOUND)
+        message(WARNING "OpenMP was enabled, but the compiler does not support it: GURLS will run on a single thread.")
+    endif(OPENMP_FOUND)
+endif(GURLS_USE_OPENMP)
+
 
 # HDF_5
 if(GURLS_BUILD_BGURLSPP)
@@ -0,0 +1,302 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/**
+ * \ingroup Tutorials
+ * \file
+ */
+
+#include <iostream>
+#include <new>
+#include <cstdlib>
+#include <vector>
+
+#include <boost/date_time/posix_time/posix_time_types.hpp>
+
+#include "gurls++/recrlswrapper.h"
+#include "gurls++/allocator.h"
+
+using namespace gurls;
+typedef double T;
+
+/**
+  * Number of heap allocations performed by the program through operator new
+  */
+static unsigned long allocations = 0;
+
+// The replacement operators must match the exception specifications of the
+// standard ones, which changed from dynamic specifications to noexcept in C++11
+#if __cplusplus >= 201103L
+#define RT_THROWS_BAD_ALLOC
+#define RT_NOTHROW noexcept
+#else
+#define RT_THROWS_BAD_ALLOC throw(std::bad_alloc)
+#define RT_NOTHROW throw()
+#endif
+
+// Once the replacement operators are inlined, GCC sees free() applied to the result
+// of operator new, or delete applied to the result of malloc(), and warns about
+// mismatched functions
+#if defined(__GNUC__)
+#define RT_NOINLINE __attribute__((noinline))
+#else
+#define RT_NOINLINE
+#endif
+
+/**
+  * Counts and performs an allocation for the replacement operators new and new[],
+  * which do not call each other, so that each buffer is paired with its own delete
+  */
+static void* countedAlloc(std::size_t size)
+{
+    ++allocations;
+    return std::malloc(size? size: 1);
+}
+
+RT_NOINLINE void* operator new(std::size_t size) RT_THROWS_BAD_ALLOC
+{
+    void* p = countedAlloc(size);
+    if(p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+RT_NOINLINE void* operator new[](std::size_t size) RT_THROWS_BAD_ALLOC
+{
+    void* p = countedAlloc(size);
+    if(p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+RT_NOINLINE void* operator new(std::size_t size, const std::nothrow_t&) RT_NOTHROW
+{
+    return countedAlloc(size);
+}
+
+RT_NOINLINE void* operator new[](std::size_t size, const std::nothrow_t&) RT_NOTHROW
+{
+    return countedAlloc(size);
+}
+
+RT_NOINLINE void operator delete(void* p) RT_NOTHROW
+{
+    std::free(p);
+}
+
+RT_NOINLINE void operator delete[](void* p) RT_NOTHROW
+{
+    std::free(p);
+}
+
+RT_NOINLINE void operator delete(void* p, const std::nothrow_t&) RT_NOTHROW
+{
+    std::free(p);
+}
+
+RT_NOINLINE void operator delete[](void* p, const std::nothrow_t&) RT_NOTHROW
+{
+    std::free(p);
+}
+
+#if defined(__cpp_sized_deallocation)
+RT_NOINLINE void operator delete(void* p, std::size_t) RT_NOTHROW
+{
+    std::free(p);
+}
+
+RT_NOINLINE void operator delete[](void* p, std::size_t) RT_NOTHROW
+{
+    std::free(p);
+}
+#endif
+
+/**
+  * Number of heap allocations, including the buffers of the GURLS memory layer,
+  * which do not go through operator new
+  */
+static unsigned long long heapAllocations()
+{
+    return allocations + Allocator::stats().allocations;
+}
+
+/**
+  * Latency histogram with power of two bins, in microseconds
+  */
+class LatencyHistogram
+{
+public:
+    LatencyHistogram(): bins(32, 0ul), total(0), worst(0) {}
+
+    void add(long us)
+    {
+        unsigned long bin = 0;
+        while((1l << bin) <= us && bin < bins.size()-1)
+            ++bin;
+
+        ++bins[bin];
+        ++total;
+        worst = std::max(worst, us);
+    }
+
+    void print(const std::string& title) const
+    {
+        std::cout << title << " (" << total << " updates, worst case " << worst << " us)" << std::endl;
+
+        long lower = 0;
+        for(unsigned long i=0; i<bins.size(); lower = (1l << i), ++i)
+            if(bins[i] > 0)
+                std::cout << "  [" << lower << ", " << (1l << i) << ") us: " << bins[i] << std::endl;
+    }
+
+private:
+    std::vector<unsigned long> bins;
+    unsigned long total;
+    long worst;
+};
+
+/**
+  * Main function
+  *
+  * Benchmarks the per-sample update of RecursiveRLSWrapper on synthetic data, comparing
+  * update() with the preallocated realTimeUpdate() path. For both, the latency of every
+  * update is collected into a histogram and the heap allocations are counted.
+  *
+  * Usage: recursiveRLS_rt [d] [t] [number of updates]
+  */
+int main(int argc, char* argv[])
+{
+    const unsigned long d = (argc > 1)? std::atol(argv[1]) : 50;
+    const unsigned long t = (argc > 2)? std::atol(argv[2]) : 3;
+    const unsigned long nup = (argc > 3)? std::atol(argv[3]) : 10000;
+    const unsigned long ntr = 10*d;
+
+    srand(0);
+
+    try
+    {
+        // y = X*w + noise
+        gMat2D<T> w(d, t);
+        for(T* it = w.getData(), *end = it+w.getSize(); it != end; ++it)
+            *it = rand()/(T)RAND_MAX - 0.5;
+
+        gMat2D<T> X(ntr+nup, d);
+        for(T* it = X.getData(), *end = it+X.getSize(); it != end; ++it)
+            *it = rand()/(T)RAND_MAX - 0.5;
+
+        gMat2D<T> y(ntr+nup, t);
+        gemm(CblasNoTrans, CblasNoTrans, ntr+nup, t, d, (T)1.0, X.getData(), ntr+nup, w.getData(), d, (T)0.0, y.getData(), ntr+nup);
+        for(T* it = y.getData(), *end = it+y.getSize(); it != end; ++it)
+            *it += 0.01*(rand()/(T)RAND_MAX - 0.5);
+
+        gMat2D<T> Xtr(ntr, d), ytr(ntr, t);
+        for(unsigned long j=0; j<d; ++j)
+            copy(Xtr.getData()+j*ntr, X.getData()+j*(ntr+nup), ntr);
+        for(unsigned long j=0; j<t; ++j)
+            copy(ytr.getData()+j*ntr, y.getData()+j*(ntr+nup), ntr);
+
+        // Samples are stored row-wise, so that each of them is contiguous in memory
+        gMat2D<T> Xup(d, nup), yup(t, nup);
+        for(unsigned long i=0; i<nup; ++i)
+        {
+            getRow(X.getData(), ntr+nup, d, ntr+i, Xup.getData()+i*d);
+            getRow(y.getData(), ntr+nup, t, ntr+i, yup.getData()+i*t);
+        }
+
+        std::cout << "Training on " << ntr << " samples, d = " << d << ", t = " << t << std::endl;
+
+        RecursiveRLSWrapper<T> reference("reference");
+        RecursiveRLSWrapper<T> realtime("realtime");
+        reference.train(Xtr, ytr);
+        realtime.train(Xtr, ytr);
+
+        realtime.prepareRealTimeUpdate(nup);
+
+        LatencyHistogram refHist, rtHist;
+        boost::posix_time::ptime begin, end;
+        gVec<T> x_v(d), y_v(t);
+
+        unsigned long long refAllocations = heapAllocations();
+        for(unsigned long i=0; i<nup; ++i)
+        {
+            copy(x_v.getData(), Xup.getData()+i*d, d);
+            copy(y_v.getData(), yup.getData()+i*t, t);
+
+            begin = boost::posix_time::microsec_clock::universal_time();
+            reference.update(x_v, y_v);
+            end = boost::posix_time::microsec_clock::universal_time();
+
+            refHist.add((end-begin).total_microseconds());
+        }
+        refAllocations = heapAllocations() - refAllocations;
+
+        unsigned long long rtAllocations = heapAllocations();
+        for(unsigned long i=0; i<nup; ++i)
+        {
+            begin = boost::posix_time::microsec_clock::universal_time();
+            realtime.realTimeUpdate(Xup.getData()+i*d, yup.getData()+i*t);
+            end = boost::posix_time::microsec_clock::universal_time();
+
+            rtHist.add((end-begin).total_microseconds());
+        }
+        rtAllocations = heapAllocations() - rtAllocations;
+
+        refHist.print("update()");
+        std::cout << "  heap allocations: " << refAllocations << std::endl;
+        rtHist.print("realTimeUpdate()");
+        std::cout << "  heap allocations: " << rtAllocations << std::endl;
+
+        const gMat2D<T>& refW = reference.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+        const gMat2D<T>& rtW = realtime.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+
+        T maxdiff = 0;
+        for(unsigned long i=0; i<refW.getSize(); ++i)
+            maxdiff = std::max(maxdiff, std::abs(refW.getData()[i]-rtW.getData()[i]));
+
+        std::cout << "Max difference between the estimators: " << maxdiff << std::endl;
+
+        return EXIT_SUCCESS;
+    }
+    catch (gException& e)
+    {
+        std::cout << e.getMessage() << std::endl;
+        return EXIT_FAILURE;
+    }
+}
@@ -0,0 +1,200 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_ALLOCATOR_H_
+#define _GURLS_ALLOCATOR_H_
+
+#include <cstddef>
+
+#include "gurls++/exports.h"
+
+namespace gurls {
+
+/**
+ * \ingroup Common
+ * \brief Allocation statistics of the GURLS memory layer
+ */
+struct GURLS_EXPORT MemoryStats
+{
+    unsigned long long currentBytes;    ///< Bytes currently in use
+    unsigned long long peakBytes;       ///< Maximum of currentBytes since the last call to Allocator::resetPeak()
+    unsigned long long pooledBytes;     ///< Bytes held by the pool, ready to be reused
+    unsigned long long allocations;     ///< Number of allocations
+    unsigned long long allocatedBytes;  ///< Total number of bytes allocated, including the buffers served by the pool
+    unsigned long long deallocations;   ///< Number of deallocations
+    unsigned long long poolHits;        ///< Number of allocations served by the pool
+};
+
+/**
+ * \ingroup Common
+ * \brief Allocator is the memory layer used by BaseArray and by the scratch buffers of the tasks.
+ *
+ * All the buffers are aligned to Allocator::alignment bytes. Buffers of at least
+ * poolThreshold bytes are rounded up to a size class (four classes per power of two)
+ * and, when released, are kept in a pool of at most poolLimit bytes, so that the large
+ * buffers allocated at every iteration of the parameter selection reuse the same pages.
+ * Optionally, fresh large buffers are advised as transparent huge pages and are
+ * touched by all the OpenMP threads with a static schedule (NUMA first-touch).
+ * All the methods are thread safe.
+ */
+class GURLS_EXPORT Allocator
+{
+public:
+    static const std::size_t alignment = 64;    ///< Alignment in bytes of every buffer
+
+    /**
+     * Allocates an aligned buffer of \a bytes bytes, throwing gException on failure
+     */
+    static void* allocate(std::size_t bytes);
+
+    /**
+     * Releases a buffer returned by allocate(), possibly keeping it in the pool. NULL is ignored.
+     */
+    static void deallocate(void* ptr);
+
+    /**
+     * Returns the allocation statistics
+     */
+    static MemoryStats stats();
+
+    /**
+     * Sets the peak to the current number of bytes in use
+     */
+    static void resetPeak();
+
+    /**
+     * Sets the maximum number of bytes in use (default 0, no limit). Allocations exceeding
+     * the budget throw gException instead of allocating; the pooled buffers do not count,
+     * and neither does the memory allocated without the Allocator (e.g. with new T[]).
+     */
+    static void setBudget(std::size_t bytes);
+
+    /**
+     * Returns the maximum number of bytes in use, 0 if there is no limit
+     */
+    static std::size_t getBudget();
+
+    /**
+     * Returns the peak resident memory of the process in bytes since it started (ru_maxrss),
+     * as reported by the operating system, or 0 where it is not available. Unlike peakBytes,
+     * it cannot be reset and includes all the memory of the process, not only GURLS buffers.
+     */
+    static std::size_t processResidentPeakBytes();
+
+    /**
+     * Frees all the buffers held by the pool
+     */
+    static void releasePool();
+
+    /**
+     * Sets the maximum number of bytes held by the pool (default 512MB, 0 disables the pool) and empties the pool
+     */
+    static void setPoolLimit(std::size_t bytes);
+
+    /**
+     * Sets the minimum size of the pooled buffers (default 256KB)
+     */
+    static void setPoolThreshold(std::size_t bytes);
+
+    /**
+     * Enables transparent huge pages for fresh buffers of at least 2MB (default off, Linux only)
+     */
+    static void setHugePages(bool value);
+
+    /**
+     * Enables the first touch of fresh pooled buffers by all the OpenMP threads (default off)
+     */
+    static void setFirstTouch(bool value);
+};
+
+/**
+ * \ingroup Common
+ * \brief MemoryBudgetScope sets the memory budget of the Allocator and restores the previous one when destroyed.
+ */
+class MemoryBudgetScope
+{
+public:
+    /**
+     * Sets the budget to \a bytes if it is not 0, otherwise keeps the current one
+     */
+    explicit MemoryBudgetScope(std::size_t bytes): previous(Allocator::getBudget())
+    {
+        if(bytes != 0)
+            Allocator::setBudget(bytes);
+    }
+
+    /**
+     * Restores the previous budget
+     */
+    ~MemoryBudgetScope()
+    {
+        Allocator::setBudget(previous);
+    }
+
+private:
+    MemoryBudgetScope(const MemoryBudgetScope&);
+    MemoryBudgetScope& operator=(const MemoryBudgetScope&);
+
+    std::size_t previous;
+};
+
+/**
+ * Allocates an aligned, uninitialized buffer of \a n elements of a plain type through the Allocator,
+ * to be released with \ref free_buffer
+ */
+template <typename T>
+T* alloc_buffer(const unsigned long n)
+{
+    return static_cast<T*>(Allocator::allocate(n*sizeof(T)));
+}
+
+/**
+ * Releases a buffer allocated with \ref alloc_buffer
+ */
+template <typename T>
+void free_buffer(T* buffer)
+{
+    Allocator::deallocate(buffer);
+}
+
+}
+
+#endif // _GURLS_ALLOCATOR_H_
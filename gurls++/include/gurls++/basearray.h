@@ -53,6 +53,8 @@
 #include <boost/serialization/base_object.hpp>
 #include <boost/serialization/split_member.hpp>
 
+#include "gurls++/allocator.h"
+#include "gurls++/mappedfile.h"
 #include "gurls++/exceptions.h"
 
 namespace gurls {
@@ -76,20 +78,22 @@ protected:
     T* data;                    ///< Pointer to the data buffer
     unsigned long size;         ///< Data buffer length
     bool isowner;               ///< Flag indicating whether vector has ownership of (and has to deallocate in destructor) the pointed buffer or not
+    MappedFile* mapping;        ///< File mapped in the data buffer, NULL if the buffer is not a file mapping
 
     void alloc(unsigned long n); ///< Allocates the \c n elements data buffer
+    void release();             ///< Deallocates the owned data buffer or unmaps the mapped file
 
 public:
 
     /**
       * Default constructor, initializes an empty vector
       */
-    BaseArray() : data(0), size(0), isowner(false) { /* TO BE DISCUSSED*/}
+    BaseArray() : data(0), size(0), isowner(false), mapping(0) { /* TO BE DISCUSSED*/}
 
     /**
       * Initializes a vector of n elements.
       */
-    BaseArray(unsigned long n) {this->alloc(n);}
+    BaseArray(unsigned long n) : mapping(0) {this->alloc(n);}
 
     /**
       * Initializes a vector copying elements from another vector
@@ -101,6 +105,23 @@ public:
       */
     BaseArray<T>& operator=(const BaseArray<T>& other);
 
+#ifdef GURLS_RVALUE_REFS
+    /**
+      * Takes the buffer of vector \c other, which is left empty
+      */
+    BaseArray(BaseArray<T>&& other) : data(0), size(0), isowner(false), mapping(0) { this->swap(other); }
+
+    /**
+      * Exchanges the buffers of vector \c other and of this one
+      */
+    BaseArray<T>& operator=(BaseArray<T>&& other) { this->swap(other); return *this; }
+#endif
+
+    /**
+      * Exchanges buffer, size and ownership with vector \c other, without copying
+      */
+    void swap(BaseArray<T>& other);
+
     /**
       * Sets all elements of the vector to the value specified in \c val
       */
@@ -109,7 +130,7 @@ public:
     /**
       * Destructor
       */
-    ~BaseArray(){ if (this->isowner && data != NULL && size > 0) { delete[] this->data; } }
+    ~BaseArray(){ this->release(); }
 
     /**
       * Copies \c n elements of a given vector \c v to this vector starting from \c start
@@ -131,6 +152,11 @@ public:
       */
     void randomize();
 
+    /**
+      * Returns true if the buffer of the vector is a memory-mapped file
+      */
+    bool isMapped() const { return this->mapping != 0; }
+
     /**
       * Returns vector length
       */
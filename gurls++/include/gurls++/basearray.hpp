@@ -4,7 +4,7 @@ namespace gurls {
 // IMPLEMENTATION OF TEMPLATE METHODS
 
 template <typename T>
-BaseArray<T>::BaseArray(const BaseArray<T>& other) {
+BaseArray<T>::BaseArray(const BaseArray<T>& other) : data(0), size(0), isowner(false), mapping(0) {
     // TO BE DISCUSSED: do we need to allocate memory here?
     // this->alloc(other.size);
     *this = other;
@@ -12,12 +12,21 @@ BaseArray<T>::BaseArray(const BaseArray<T>& other) {
 
 template <typename T>
 BaseArray<T>& BaseArray<T>::operator=(const BaseArray<T>& other) {
-    if (this == &other) {
-        return *this;
-    } else {
+    if (this != &other) {
+        this->release();
+
         this->alloc(other.size);
         this->set(other.data, other.size);
     }
+    return *this;
+}
+
+template <typename T>
+void BaseArray<T>::swap(BaseArray<T>& other) {
+    std::swap(this->data, other.data);
+    std::swap(this->size, other.size);
+    std::swap(this->isowner, other.isowner);
+    std::swap(this->mapping, other.mapping);
 }
 
 template <typename T>
@@ -35,8 +44,16 @@ template <typename T>
 void BaseArray<T>::alloc(unsigned long n) {
     this->isowner = true;
     this->size = n;
-    if ( this->size > 0 )
-        this->data = new T[this->size];
+    this->data = (this->size > 0)? alloc_buffer<T>(this->size): NULL;
+}
+
+template <typename T>
+void BaseArray<T>::release() {
+    if (this->isowner)
+        free_buffer(this->data);
+
+    delete this->mapping;
+    this->mapping = 0;
 }
 
 template <typename T>
@@ -65,8 +82,7 @@ void BaseArray<T>::resize(unsigned long n) {
         unsigned long oldsize = this->size;
         this->alloc(n);
         this->set(tmp, std::min(n, oldsize));
-        if(tmp != NULL)
-            delete[] tmp;
+        free_buffer(tmp);
     };
 }
 
@@ -239,9 +255,12 @@ void BaseArray<T>::save(Archive & ar, const unsigned int /* file_version */) con
 template <typename T>
 template<class Archive>
 void BaseArray<T>::load(Archive & ar, const unsigned int /* file_version */){
+    this->release();
+
     ar & this->size;
     ar & this->isowner;
-    this->data = new T[this->size];
+    this->isowner = true;
+    this->data = alloc_buffer<T>(this->size);
     T* ptr = this->data;
     T* ptr_end = this->data+this->size;
     while (ptr!=ptr_end){
@@ -144,6 +144,20 @@ void drotg_ (   double *        a,
                 double *        s 
             );
 
+/**
+  * \brief Prototype for Blas SROT
+  *
+  * Applies a plane rotation to the single precision pairs \f$(x_i, y_i)\f$, see DROT.
+  */
+void srot_(int *n, float *x, int *incx, float *y, int *incy, float *c, float *s);
+
+/**
+  * \brief Prototype for Blas SROTG
+  *
+  * Computes the elements of a single precision Givens plane rotation, see DROTG.
+  */
+void srotg_(float *a, float *b, float *c, float *s);
+
 /**
   * \brief Prototype for Blas SDOT
   *
@@ -221,6 +235,28 @@ void strsm_(char *side, char *uplo, char *transa, char *diag, int *m, int *n, fl
   */
 void sswap_(int *n, float *sx, int *incx, float *sy, int *incy);
 
+/**
+  * \brief Prototype for Blas SSYRK
+  *
+  * Performs one of the symmetric rank k operations
+  * \f[C = \alpha A A^T + \beta C\f] or \f[C = \alpha A^T A + \beta C\f],
+  * where \f$\alpha\f$ and \f$\beta\f$ are scalars, \f$C\f$ is an n by n symmetric matrix
+  * and \f$A\f$ is an n by k matrix in the first case and a k by n matrix in the second case.
+  * Only the triangle of \f$C\f$ selected by uplo is referenced and updated.
+  */
+void ssyrk_(char *uplo, char *trans, int *n, int *k, float *alpha, float *a, int *lda, float *beta, float *c, int *ldc);
+
+/**
+  * \brief Prototype for Blas SSYMM
+  *
+  * Performs one of the matrix-matrix operations
+  * \f[C = \alpha A B + \beta C\f] or \f[C = \alpha B A + \beta C\f],
+  * where \f$\alpha\f$ and \f$\beta\f$ are scalars, \f$A\f$ is a symmetric matrix
+  * of which only the triangle selected by uplo is referenced,
+  * and \f$B\f$ and \f$C\f$ are m by n matrices.
+  */
+void ssymm_(char *side, char *uplo, int *m, int *n, float *alpha, float *a, int *lda, float *b, int *ldb, float *beta, float *c, int *ldc);
+
 /**
   * \brief Prototype for Blas DDOT
   *
@@ -298,6 +334,28 @@ void dtrsm_(char *side, char *uplo, char *transa, char *diag, int *m, int *n, do
   */
 void dswap_(int *n, double *sx, int *incx, double *sy, int *incy);
 
+/**
+  * \brief Prototype for Blas DSYRK
+  *
+  * Performs one of the symmetric rank k operations
+  * \f[C = \alpha A A^T + \beta C\f] or \f[C = \alpha A^T A + \beta C\f],
+  * where \f$\alpha\f$ and \f$\beta\f$ are scalars, \f$C\f$ is an n by n symmetric matrix
+  * and \f$A\f$ is an n by k matrix in the first case and a k by n matrix in the second case.
+  * Only the triangle of \f$C\f$ selected by uplo is referenced and updated.
+  */
+void dsyrk_(char *uplo, char *trans, int *n, int *k, double *alpha, double *a, int *lda, double *beta, double *c, int *ldc);
+
+/**
+  * \brief Prototype for Blas DSYMM
+  *
+  * Performs one of the matrix-matrix operations
+  * \f[C = \alpha A B + \beta C\f] or \f[C = \alpha B A + \beta C\f],
+  * where \f$\alpha\f$ and \f$\beta\f$ are scalars, \f$A\f$ is a symmetric matrix
+  * of which only the triangle selected by uplo is referenced,
+  * and \f$B\f$ and \f$C\f$ are m by n matrices.
+  */
+void dsymm_(char *side, char *uplo, int *m, int *n, double *alpha, double *a, int *lda, double *b, int *ldb, double *beta, double *c, int *ldc);
+
 
 
 // ------ LAPACK
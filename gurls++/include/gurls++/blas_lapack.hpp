@@ -132,6 +132,35 @@ void gemm(const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB,
           const T *B, const int ldb,
           const T beta, T *C, const int ldc);
 
+/**
+  * Template function to call BLAS *ROT routines
+  */
+template<typename T>
+void rot(const int N, T *X, const int incX, T *Y, const int incY, const T c, const T s);
+
+/**
+  * Template function to call BLAS *ROTG routines
+  */
+template<typename T>
+void rotg(T *a, T *b, T *c, T *s);
+
+/**
+  * Template function to call BLAS *SYRK routines
+  */
+template<typename T>
+void syrk(const CBLAS_UPLO Uplo, const CBLAS_TRANSPOSE Trans,
+          const int N, const int K, const T alpha, const T *A, const int lda,
+          const T beta, T *C, const int ldc);
+
+/**
+  * Template function to call BLAS *SYMM routines
+  */
+template<typename T>
+void symm(const CBLAS_SIDE Side, const CBLAS_UPLO Uplo,
+          const int M, const int N, const T alpha, const T *A, const int lda,
+          const T *B, const int ldb,
+          const T beta, T *C, const int ldc);
+
 /**
   * Template function to call LAPACK *GEQP3 routines
   */
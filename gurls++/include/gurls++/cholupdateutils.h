@@ -1,6 +1,5 @@
-// Temporary file, content needs to be integrated properly in GURLS
 // Author: Arjan Gijsberts
-// Content: Utility functions performing the rank-k update of a Cholesky factor R
+// Content: Utility functions performing rank-1 and rank-k updates and downdates of an upper Cholesky factor R
 
 /*
  * Permission is granted to copy, distribute, and/or modify this program
@@ -16,137 +15,191 @@
  * Public LicenseNULL for more details
  */
 
-#include "gurls++/gmat2d.h"
+#ifndef _GURLS_CHOLUPDATEUTILS_H_
+#define _GURLS_CHOLUPDATEUTILS_H_
+
+#include <cmath>
+
+#include "gurls++/gmath.h"
+#include "gurls++/exceptions.h"
 
 namespace gurls {
 
-void dchud(double* r, int ldr, int p, double* x, double* z, int ldz, int nz,
-           double* y, double* rho, double* c, double* s,
-           unsigned char rtrans, unsigned char ztrans) {
-  
-    // WARNING: This function only updates R. The update of z and rho is not implemented.
-    //
-    // Performs the rank-1 update of the Cholesky factor r with the input vector x by applying p Givens rotations.
-    //
-    // Arguments:
-    //
-    // r:           Upper Cholesky factor buffer
-    // ldr:         Unknown, not used (probably it's the order of r, which must be == p)
-    // p:           Dimension of vector x and order of matrix r
-    // x:           Update sample buffer
-    // z:           Known terms matrix
-    // ldz:         Number of columns of z
-    // nz:          Number of rows of z
-    // y:           Output labels vector
-    // rho:         On entry, the norms of the residual vectors that are to be updated. On exit, RHO has been updated. If RHO(i) is negative on entry then it is not changed.
-    // c:           Cosines of the transforming rotations
-    // s:           Sines of the transforming rotations
-    // rtrans:      Bool to transpose r
-    // ztrans:      Bool to transpose z    
-    
-    unsigned int i;
-    unsigned int stp;   // Step to apply to r to get the next row element
-    //unsigned int stp2;
-    double* work = (double*) 0x0;   // Pointer to the elements of the update sample
-    double* tbuff = (double*) 0x0;  // Pointer to the elements of the diagonal of R
-    //double scale, workscale, rhoscale;
-
-    // create working copy of x
-    work = (double*) malloc(p * sizeof(double));
-    int one = 1;
-    dcopy_(&p, x, &one, work, &one);
-
-    stp = (rtrans == 1) ? p : 1;
-
-    // Update r and fill c and s on the go
-    for(i = 0, tbuff = r; (int)i < p; tbuff += (p+1), i++) {
-        
-        // Compute i-th Givens rotation
-        drotg_(tbuff, work+i, c+i, s+i);   
-
-        // force positive values on the diagonal (not strictly necessary)
-        //if(*tbuff < 0) {
-        //    *tbuff = -(*tbuff);
-        //    c[i] = -c[i];
-        //    s[i] = -s[i];
-        //}
-
-        // Apply Givens rotation
-        if((int)i < p - 1) {
-            
-            int n = p - i - 1;
-            int one = 1;
-            int step = stp;
-            double* xcoord = tbuff + stp;
-            double* ycoord = work + i + 1;
-            double* costh = c + i;
-            double* sinth = s + i;
-            
-            drot_(&n, xcoord, &step, ycoord, &one, costh, sinth);
-            
+/**
+  * Returns the number of elements of the workspace needed by \ref cholupdate
+  * for a rank-k update of a factor of order d
+  */
+inline unsigned long cholupdateWorkSize(const unsigned long d, const unsigned long k)
+{
+    return (2*d+1)*k;
+}
+
+/**
+  * Returns the number of elements of the workspace needed by \ref choldowndate
+  * for a factor of order d
+  */
+inline unsigned long choldowndateWorkSize(const unsigned long d)
+{
+    return 3*d;
+}
+
+/**
+  * Performs the rank-k update of an upper Cholesky factor, such that on exit
+  * R'*R = R0'*R0 + X'*X, where R0 is the factor on entry.
+  *
+  * The k updates are applied as k sequences of Givens rotations, but R is swept
+  * one column at a time and every column receives the rotations of all the k
+  * samples while it is in cache. The diagonal of R is kept positive.
+  * No memory is allocated.
+  *
+  * \param R upper triangular d-by-d factor (column-major), updated in place
+  * \param d order of R
+  * \param X k-by-d matrix of update samples (column-major), one sample per row
+  * \param ldx leading dimension of X
+  * \param k number of update samples
+  * \param work workspace of at least cholupdateWorkSize(d, k) elements
+  */
+template<typename T>
+void cholupdate(T* R, const int d, const T* X, const int ldx, const int k, T* work)
+{
+    T* c = work;            // c[l + i*k] cosine of the i-th rotation of the l-th sample
+    T* s = work + k*d;      // s[l + i*k] sine of the i-th rotation of the l-th sample
+    T* x = work + 2*k*d;    // current value of the j-th element of each sample
+
+    for(int j=0; j<d; ++j)
+    {
+        T* Rj = R + j*d;
+
+        copy(x, X + j*ldx, k);
+
+        // apply the rotations found on the previous columns
+        for(int i=0; i<j; ++i)
+        {
+            const T* ci = c + i*k;
+            const T* si = s + i*k;
+            T r = Rj[i];
+
+            for(int l=0; l<k; ++l)
+            {
+                const T tmp = ci[l]*r + si[l]*x[l];
+                x[l] = ci[l]*x[l] - si[l]*r;
+                r = tmp;
+            }
+
+            Rj[i] = r;
+        }
+
+        // compute the rotations zeroing the j-th element of each sample
+        T* cj = c + j*k;
+        T* sj = s + j*k;
+        for(int l=0; l<k; ++l)
+        {
+            T b = x[l];
+            rotg(Rj+j, &b, cj+l, sj+l);
+
+            if(Rj[j] < 0)
+            {
+                Rj[j] = -Rj[j];
+                cj[l] = -cj[l];
+                sj[l] = -sj[l];
+            }
+        }
+    }
+}
+
+/**
+  * Performs the rank-1 update of an upper Cholesky factor, such that on exit
+  * R'*R = R0'*R0 + x*x', where R0 is the factor on entry.
+  *
+  * \param R upper triangular d-by-d factor (column-major), updated in place
+  * \param d order of R
+  * \param x update vector of length d
+  * \param incx stride between the elements of x
+  * \param work workspace of at least cholupdateWorkSize(d, 1) elements
+  */
+template<typename T>
+void cholupdate(T* R, const int d, const T* x, const int incx, T* work)
+{
+    cholupdate(R, d, x, incx, 1, work);
+}
+
+/**
+  * Performs the rank-1 downdate of an upper Cholesky factor, such that on exit
+  * R'*R = R0'*R0 - x*x', where R0 is the factor on entry (LINPACK DCHDD).
+  *
+  * The triangular system R0'*a = x is solved first; the downdate exists only if
+  * norm(a) < 1, otherwise an exception is thrown and R is left untouched.
+  * No memory is allocated.
+  *
+  * \param R upper triangular d-by-d factor (column-major), updated in place
+  * \param d order of R
+  * \param x downdate vector of length d
+  * \param incx stride between the elements of x
+  * \param work workspace of at least choldowndateWorkSize(d) elements
+  */
+template<typename T>
+void choldowndate(T* R, const int d, const T* x, const int incx, T* work)
+{
+    T* a = work;
+    T* c = work + d;
+    T* s = work + 2*d;
+
+    //  a = R'\x;
+    copy(a, x, d, 1, incx);
+    trsm(CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, d, 1, (T)1.0, R, d, a, d);
+
+    const T norm = nrm2(d, a, 1);
+    if(!(norm < (T)1.0))
+        throw gException("Cholesky downdate failed: the downdated matrix is not positive definite");
+
+    // compute the rotations
+    T alpha = std::sqrt((T)1.0 - norm*norm);
+    for(int i=d-1; i>=0; --i)
+    {
+        const T scale = alpha + std::abs(a[i]);
+        const T ra = alpha/scale;
+        const T rb = a[i]/scale;
+        const T rnorm = std::sqrt(ra*ra + rb*rb);
+
+        c[i] = ra/rnorm;
+        s[i] = rb/rnorm;
+        alpha = scale*rnorm;
+    }
+
+    // apply the rotations column by column
+    for(int j=0; j<d; ++j)
+    {
+        T* Rj = R + j*d;
+        T xx = (T)0.0;
+
+        for(int i=j; i>=0; --i)
+        {
+            const T tmp = c[i]*xx + s[i]*Rj[i];
+            Rj[i] = c[i]*Rj[i] - s[i]*xx;
+            xx = tmp;
         }
     }
-    
-    free(work);
-        
-    // WARNING: The update of z and rho is not implemented
-    // update z and rho if applicable
-//     if(nz > 0) {
-//         work = (double*) malloc(nz * sizeof(double));
-//         dcopy_(&nz, y, &one, work, &one); 
-// 
-//         stp = (ztrans == 1) ? 1 : nz;
-//         stp2 = (ztrans == 1) ? ldz : 1;
-// 
-//         // update z
-//         for(i = 0; (int)i < p; i++) {
-//             //drot_(nz, z+i*stp, stp2, work, 1, c[i], s[i]);  // WARNING: to be implemented!! 
-//         }
-// 
-//         // update rho
-//         for(i = 0; (int)i < nz; i++) {
-//             if(work[i] < 0) {
-//                 work[i] = -work[i];
-//             }
-//             if(rho[i] > 0) {
-//                 scale = work[i] + rho[i];
-//                 workscale = work[i] / scale;
-//                 rhoscale = rho[i] / scale;
-//                 rho[i] = scale * sqrt((workscale)*(workscale) + (rhoscale)*(rhoscale));
-//                 // above is equal to line below, but less sensitive to numerical instability
-//                 //rho[i] = sqrt(work[i]*work[i] + rho[i]*rho[i]);
-//             }
-//         }
-//         free(work);
-//     }
 }
 
-// WARNING: cholupdate works with double parameters, not generic typename T
-// WARNING: x should be of type const double&, but for compatibility with dchud "const" is omitted.
-void cholupdate(gMat2D<double>& R, double& x, bool rtrans) {  
-   
-    // rPtr points to the vectorized R matrix
-    double* rPtr = R.getData();
-    
-    int d = (int) R.cols();     // TODO: Need to add <climits> like this:
-                                //      #include <climits>
-                                //      unsigned long int uid = ...;
-                                //      int abbreviated_uid = uid & INT_MAX;    
-    
-    double* xPtr = &x;          // Initialize pointer to the x vector
-    double* c = new double[d];  
-    double* s = new double[d];  
-
-    // dchud should be called in place of gsl_linalg_cholesky_update, since GSL is not available in GURLS
-    dchud(rPtr, 0, d, xPtr, 0, 0, 0,
-          0, 0, c, s,
-          (unsigned char) rtrans, 0);
-    
-    // Store the updated matrix in R    
-    R = gMat2D<double>(rPtr, (unsigned long) d, (unsigned long) d, 1);
-
-    // Free memory
-    delete[] c;
-    delete[] s;
+/**
+  * Performs the rank-k downdate of an upper Cholesky factor, such that on exit
+  * R'*R = R0'*R0 - X'*X, where R0 is the factor on entry.
+  * The samples are removed one at a time with \ref choldowndate.
+  *
+  * \param R upper triangular d-by-d factor (column-major), updated in place
+  * \param d order of R
+  * \param X k-by-d matrix of downdate samples (column-major), one sample per row
+  * \param ldx leading dimension of X
+  * \param k number of downdate samples
+  * \param work workspace of at least choldowndateWorkSize(d) elements
+  */
+template<typename T>
+void choldowndate(T* R, const int d, const T* X, const int ldx, const int k, T* work)
+{
+    for(int l=0; l<k; ++l)
+        choldowndate(R, d, X+l, ldx, work);
 }
-}
\ No newline at end of file
+
+}
+
+#endif // _GURLS_CHOLUPDATEUTILS_H_
@@ -0,0 +1,174 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_CHUNKREADER_H_
+#define _GURLS_CHUNKREADER_H_
+
+#include <string>
+#include <fstream>
+
+#include "gurls++/gmat2d.h"
+#include "gurls++/gmath.h"
+
+namespace gurls {
+
+/**
+  * \brief ChunkReader is the interface of the sequential readers of a dataset,
+  * which deliver the samples in chunks of rows so that the whole dataset never
+  * needs to be held in memory.
+  * \tparam T Cells type.
+  */
+template <typename T>
+class ChunkReader {
+
+public:
+
+    /**
+      * Destructor
+      */
+    virtual ~ChunkReader() {}
+
+    /**
+      * Returns the number of input variables
+      */
+    virtual unsigned long cols() const = 0;
+
+    /**
+      * Returns the number of outputs
+      */
+    virtual unsigned long outputs() const = 0;
+
+    /**
+      * Reads the next samples of the dataset
+      *
+      * \param X output maxRows-by-cols() matrix of inputs, with leading dimension ldx
+      * \param ldx leading dimension of X
+      * \param y output maxRows-by-outputs() matrix of outputs, with leading dimension ldy
+      * \param ldy leading dimension of y
+      * \param maxRows maximum number of samples to read
+      *
+      * \return the number of samples read, 0 when the end of the dataset is reached
+      */
+    virtual unsigned long read(T* X, unsigned long ldx, T* y, unsigned long ldy, unsigned long maxRows) = 0;
+
+    /**
+      * Restarts reading from the first sample
+      */
+    virtual void rewind() = 0;
+};
+
+/**
+  * \brief MatrixChunkReader is a ChunkReader on a pair of matrices held in memory.
+  * The matrices are not copied and must outlive the reader.
+  * \tparam T Cells type.
+  */
+template <typename T>
+class MatrixChunkReader: public ChunkReader<T> {
+
+public:
+
+    /**
+      * Initializes a reader on the rows of the input matrix X and of the output matrix y
+      */
+    MatrixChunkReader(const gMat2D<T>& inputs, const gMat2D<T>& outputs);
+
+    unsigned long cols() const {return X.cols(); }
+    unsigned long outputs() const {return y.cols(); }
+    unsigned long read(T* Xc, unsigned long ldx, T* yc, unsigned long ldy, unsigned long maxRows);
+    void rewind() {next = 0; }
+
+protected:
+
+    const gMat2D<T>& X;     ///< Input matrix
+    const gMat2D<T>& y;     ///< Output matrix
+    unsigned long next;     ///< Next row to be read
+};
+
+/**
+  * \brief CSVChunkReader is a ChunkReader on a pair of text files, holding respectively
+  * the inputs and the outputs of one sample per line, in the format read by gMat2D::readCSV().
+  * \tparam T Cells type.
+  */
+template <typename T>
+class CSVChunkReader: public ChunkReader<T> {
+
+public:
+
+    /**
+      * Opens the files of inputs and outputs, and reads the number of columns from their first line
+      */
+    CSVChunkReader(const std::string& Xfile, const std::string& yfile);
+
+    unsigned long cols() const {return d; }
+    unsigned long outputs() const {return t; }
+    unsigned long read(T* X, unsigned long ldx, T* y, unsigned long ldy, unsigned long maxRows);
+    void rewind();
+
+protected:
+
+    /**
+      * Reads the next non-empty line of in and parses its values in row, with stride inc.
+      * Returns false at the end of the file.
+      */
+    bool readLine(std::ifstream& in, const std::string& fileName, T* row, unsigned long inc, unsigned long length);
+
+    /**
+      * Returns the number of values in the first non-empty line of in, and rewinds it
+      */
+    unsigned long countColumns(std::ifstream& in, const std::string& fileName);
+
+    std::string Xname;      ///< Inputs file name
+    std::string yname;      ///< Outputs file name
+    std::ifstream Xin;      ///< Inputs file
+    std::ifstream yin;      ///< Outputs file
+    unsigned long d;        ///< Number of input variables
+    unsigned long t;        ///< Number of outputs
+    std::string line;       ///< Line buffer
+
+private:
+
+    CSVChunkReader(const CSVChunkReader<T>&);
+    CSVChunkReader<T>& operator=(const CSVChunkReader<T>&);
+};
+
+}
+
+#include "chunkreader.hpp"
+
+#endif // _GURLS_CHUNKREADER_H_
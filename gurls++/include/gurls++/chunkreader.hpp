@@ -0,0 +1,148 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gurls++/exceptions.h"
+#include "gurls++/csvparser.h"
+
+namespace gurls {
+
+template <typename T>
+MatrixChunkReader<T>::MatrixChunkReader(const gMat2D<T>& inputs, const gMat2D<T>& outputs): X(inputs), y(outputs), next(0)
+{
+    if(X.rows() != y.rows())
+        throw gException(Exception_Inconsistent_Size);
+}
+
+template <typename T>
+unsigned long MatrixChunkReader<T>::read(T* Xc, unsigned long ldx, T* yc, unsigned long ldy, unsigned long maxRows)
+{
+    const unsigned long n = X.rows();
+    const unsigned long rows = std::min(maxRows, n-next);
+
+    for(unsigned long j=0; j<X.cols(); ++j)
+        copy(Xc + j*ldx, X.getData() + next + j*n, rows);
+
+    for(unsigned long j=0; j<y.cols(); ++j)
+        copy(yc + j*ldy, y.getData() + next + j*n, rows);
+
+    next += rows;
+    return rows;
+}
+
+template <typename T>
+CSVChunkReader<T>::CSVChunkReader(const std::string& Xfile, const std::string& yfile): Xname(Xfile), yname(yfile),
+    Xin(Xfile.c_str()), yin(yfile.c_str())
+{
+    d = countColumns(Xin, Xname);
+    t = countColumns(yin, yname);
+}
+
+template <typename T>
+unsigned long CSVChunkReader<T>::countColumns(std::ifstream& in, const std::string& fileName)
+{
+    if(!in.is_open())
+        throw gException("Cannot open file " + fileName);
+
+    unsigned long count = 0;
+    while(count == 0 && std::getline(in, line))
+        count = countCSVFields(line.data(), line.data()+line.size());
+
+    in.clear();
+    in.seekg(0, std::ios::beg);
+
+    return count;
+}
+
+template <typename T>
+bool CSVChunkReader<T>::readLine(std::ifstream& in, const std::string& fileName, T* row, unsigned long inc, unsigned long length)
+{
+    while(std::getline(in, line))
+    {
+        if(line.empty())
+            continue;
+
+        bool valid;
+        const unsigned long count = parseCSVLine(line.data(), line.data()+line.size(), row, inc, length, valid);
+
+        if(count == 0)
+            continue;
+
+        if(count != length)
+            throw gException("Wrong number of columns in file " + fileName);
+
+        if(!valid)
+            throw gException("Invalid value in file " + fileName);
+
+        return true;
+    }
+
+    return false;
+}
+
+template <typename T>
+unsigned long CSVChunkReader<T>::read(T* X, unsigned long ldx, T* y, unsigned long ldy, unsigned long maxRows)
+{
+    unsigned long rows = 0;
+
+    for(; rows < maxRows; ++rows)
+    {
+        const bool hasX = readLine(Xin, Xname, X+rows, ldx, d);
+        const bool hasy = readLine(yin, yname, y+rows, ldy, t);
+
+        if(hasX != hasy)
+            throw gException(Exception_Inconsistent_Size);
+
+        if(!hasX)
+            break;
+    }
+
+    return rows;
+}
+
+template <typename T>
+void CSVChunkReader<T>::rewind()
+{
+    Xin.clear();
+    Xin.seekg(0, std::ios::beg);
+
+    yin.clear();
+    yin.seekg(0, std::ios::beg);
+}
+
+}
@@ -0,0 +1,452 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_CSVPARSER_H_
+#define _GURLS_CSVPARSER_H_
+
+#include <cstdlib>
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <limits>
+#include <sstream>
+
+#include <boost/lexical_cast.hpp>
+
+#include "gurls++/exceptions.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace gurls {
+
+/**
+  * Returns true if c separates two values of a line of a text matrix file
+  */
+inline bool isCSVSeparator(const char c)
+{
+    return c == ' ' || c == ',' || c == ';' || c == '|' || c == '\t' || c == '\r';
+}
+
+/**
+  * Returns the number of values in the line [begin, end)
+  */
+inline unsigned long countCSVFields(const char* begin, const char* end)
+{
+    unsigned long count = 0;
+    bool inField = false;
+
+    for(const char* it = begin; it != end; ++it)
+    {
+        const bool sep = isCSVSeparator(*it);
+        if(!sep && !inField)
+            ++count;
+        inField = !sep;
+    }
+
+    return count;
+}
+
+/**
+  * Converts the token [begin, end) with std::strtod, std::strtof or boost::lexical_cast
+  */
+inline bool convertCSVToken(const char* begin, const char* end, double& value)
+{
+    const std::string token(begin, end);
+    char* stop;
+    value = std::strtod(token.c_str(), &stop);
+    return !token.empty() && stop == token.c_str()+token.size();
+}
+
+inline bool convertCSVToken(const char* begin, const char* end, float& value)
+{
+    const std::string token(begin, end);
+    char* stop;
+    value = std::strtof(token.c_str(), &stop);
+    return !token.empty() && stop == token.c_str()+token.size();
+}
+
+template<typename T>
+bool convertCSVToken(const char* begin, const char* end, T& value)
+{
+    try
+    {
+        value = boost::lexical_cast<T>(std::string(begin, end));
+    }
+    catch(boost::bad_lexical_cast&)
+    {
+        return false;
+    }
+    return true;
+}
+
+/**
+  * Parses the decimal floating point number [begin, end).
+  *
+  * Numbers whose significand and power of ten are both exactly representable in T
+  * (up to 2^53 and 1e22 for doubles) are computed with a single multiplication or
+  * division, which is correctly rounded; everything else, including inf and nan, is
+  * left to the standard library.
+  */
+template<typename T>
+bool parseCSVFloatingPoint(const char* begin, const char* end, T& value)
+{
+    static const T powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                               1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    const int maxPower = (std::numeric_limits<T>::digits >= 53)? 22: 10;
+    const unsigned long long maxMantissa = 1ull << std::numeric_limits<T>::digits;
+
+    const char* p = begin;
+    bool negative = false;
+    if(p != end && (*p == '-' || *p == '+'))
+        negative = (*p++ == '-');
+
+    unsigned long long mantissa = 0;
+    int digits = 0;
+    int exponent = 0;
+    bool exact = true;
+    bool any = false;
+
+    for(; p != end && *p >= '0' && *p <= '9'; ++p)
+    {
+        any = true;
+        if(digits < 19)
+        {
+            mantissa = mantissa*10 + (*p - '0');
+            digits += (mantissa != 0);
+        }
+        else
+        {
+            ++exponent;
+            exact &= (*p == '0');
+        }
+    }
+
+    if(p != end && *p == '.')
+    {
+        for(++p; p != end && *p >= '0' && *p <= '9'; ++p)
+        {
+            any = true;
+            if(digits < 19)
+            {
+                mantissa = mantissa*10 + (*p - '0');
+                digits += (mantissa != 0);
+                --exponent;
+            }
+            else
+                exact &= (*p == '0');
+        }
+    }
+
+    if(any && p != end && (*p == 'e' || *p == 'E'))
+    {
+        ++p;
+        bool negativeExp = false;
+        if(p != end && (*p == '-' || *p == '+'))
+            negativeExp = (*p++ == '-');
+
+        if(p == end)
+            return false;
+
+        int e = 0;
+        for(; p != end && *p >= '0' && *p <= '9'; ++p)
+            e = std::min(e*10 + (*p - '0'), 100000);
+
+        exponent += negativeExp? -e: e;
+    }
+
+    if(!any || p != end || !exact || mantissa > maxMantissa || exponent < -maxPower || exponent > maxPower)
+        return convertCSVToken(begin, end, value);
+
+    value = static_cast<T>(mantissa);
+    if(exponent < 0)
+        value /= powers[-exponent];
+    else
+        value *= powers[exponent];
+
+    if(negative)
+        value = -value;
+
+    return true;
+}
+
+/**
+  * Parses the value [begin, end) of a text matrix file
+  */
+template<typename T>
+bool parseCSVValue(const char* begin, const char* end, T& value)
+{
+    return convertCSVToken(begin, end, value);
+}
+
+template<>
+inline bool parseCSVValue(const char* begin, const char* end, double& value)
+{
+    return parseCSVFloatingPoint(begin, end, value);
+}
+
+template<>
+inline bool parseCSVValue(const char* begin, const char* end, float& value)
+{
+    return parseCSVFloatingPoint(begin, end, value);
+}
+
+/**
+  * Parses the values of the line [begin, end) into row, with stride inc.
+  *
+  * \param begin first character of the line
+  * \param end end of the line
+  * \param row output buffer
+  * \param inc stride between consecutive values in row
+  * \param length maximum number of values stored in row
+  * \param valid set to false if a value cannot be parsed
+  * \return the number of values found in the line
+  */
+template<typename T>
+unsigned long parseCSVLine(const char* begin, const char* end, T* row, const unsigned long inc, const unsigned long length, bool& valid)
+{
+    unsigned long count = 0;
+    valid = true;
+
+    const char* it = begin;
+    while(it != end)
+    {
+        while(it != end && isCSVSeparator(*it))
+            ++it;
+
+        if(it == end)
+            break;
+
+        const char* tokenEnd = it;
+        while(tokenEnd != end && !isCSVSeparator(*tokenEnd))
+            ++tokenEnd;
+
+        if(count < length && !parseCSVValue(it, tokenEnd, row[count*inc]))
+            valid = false;
+
+        ++count;
+        it = tokenEnd;
+    }
+
+    return count;
+}
+
+/**
+  * \ingroup Common
+  * \brief CSVParser parses a text matrix file held in memory, one row per non-empty line.
+  *
+  * The values of a line can be separated by any combination of spaces, tabs, commas,
+  * semicolons and vertical bars. The text is split on line boundaries in one chunk per
+  * OpenMP thread; a counting pass finds the number of rows of each chunk, so that every
+  * thread then parses its chunk directly into the final buffer.
+  * \tparam T Cells type.
+  */
+template<typename T>
+class CSVParser
+{
+public:
+
+    /**
+      * Splits the text and counts its rows and columns
+      *
+      * \param text beginning of the text
+      * \param size length of the text
+      * \param fileName name of the file, used in the error messages
+      * \param nchunks number of chunks; if 0, one per OpenMP thread, each of at least 64KB
+      */
+    CSVParser(const char* text, std::size_t size, const std::string& fileName, std::size_t nchunks = 0);
+
+    unsigned long rows() const {return nrows;}  ///< Number of rows
+    unsigned long cols() const {return ncols;}  ///< Number of columns, i.e. values in the first non-empty line
+
+    /**
+      * Parses the text into data, which must hold rows()*cols() elements,
+      * in column-major order if colMajor is true and in row-major order otherwise
+      */
+    void parse(T* data, bool colMajor) const;
+
+protected:
+
+    /**
+      * Returns true if the line [begin, end) holds at least one value
+      */
+    static bool isDataLine(const char* begin, const char* end);
+
+    const char* text;                       ///< Text to be parsed
+    std::size_t size;                       ///< Length of the text
+    std::string fileName;                   ///< File name for the error messages
+    std::vector<std::size_t> bounds;        ///< Offsets of the chunks, at line boundaries
+    std::vector<unsigned long> firstRows;   ///< Index of the first row of each chunk
+    unsigned long nrows;                    ///< Number of rows
+    unsigned long ncols;                    ///< Number of columns
+};
+
+template<typename T>
+bool CSVParser<T>::isDataLine(const char* begin, const char* end)
+{
+    for(const char* it = begin; it != end; ++it)
+        if(!isCSVSeparator(*it))
+            return true;
+
+    return false;
+}
+
+template<typename T>
+CSVParser<T>::CSVParser(const char* text, std::size_t size, const std::string& fileName, std::size_t nchunks)
+    : text(text), size(size), fileName(fileName), nrows(0), ncols(0)
+{
+    if(nchunks == 0)
+    {
+#ifdef _OPENMP
+        const std::size_t nthreads = static_cast<std::size_t>(omp_get_max_threads());
+#else
+        const std::size_t nthreads = 1;
+#endif
+        nchunks = std::max<std::size_t>(1, std::min(nthreads, size >> 16));
+    }
+
+    bounds.push_back(0);
+    for(std::size_t k=1; k<nchunks; ++k)
+    {
+        const std::size_t start = std::max(bounds.back(), k*(size/nchunks));
+        const char* nl = static_cast<const char*>(std::memchr(text+start, '\n', size-start));
+        bounds.push_back((nl != NULL)? static_cast<std::size_t>(nl-text)+1: size);
+    }
+    bounds.push_back(size);
+
+    firstRows.assign(nchunks+1, 0);
+    const long n = static_cast<long>(nchunks);
+
+#pragma omp parallel for schedule(static, 1)
+    for(long k=0; k<n; ++k)
+    {
+        const char* it = text+bounds[k];
+        const char* end = text+bounds[k+1];
+        unsigned long count = 0;
+
+        while(it < end)
+        {
+            const char* nl = static_cast<const char*>(std::memchr(it, '\n', end-it));
+            const char* lineEnd = (nl != NULL)? nl: end;
+
+            count += isDataLine(it, lineEnd);
+            it = (nl != NULL)? nl+1: end;
+        }
+
+        firstRows[k+1] = count;
+    }
+
+    for(std::size_t k=0; k<nchunks; ++k)
+        firstRows[k+1] += firstRows[k];
+
+    nrows = firstRows[nchunks];
+
+    // the number of columns is given by the first non-empty line
+    for(const char* it = text, *end = text+size; it < end && ncols == 0; )
+    {
+        const char* nl = static_cast<const char*>(std::memchr(it, '\n', end-it));
+        const char* lineEnd = (nl != NULL)? nl: end;
+
+        ncols = countCSVFields(it, lineEnd);
+        it = (nl != NULL)? nl+1: end;
+    }
+}
+
+template<typename T>
+void CSVParser<T>::parse(T* data, bool colMajor) const
+{
+    const long n = static_cast<long>(bounds.size()-1);
+    const unsigned long inc = colMajor? nrows: 1;
+
+    // first bad row of each chunk, nrows if none
+    std::vector<unsigned long> badRows(n, nrows);
+    std::vector<char> badValues(n, 0);
+
+#pragma omp parallel for schedule(static, 1)
+    for(long k=0; k<n; ++k)
+    {
+        const char* it = text+bounds[k];
+        const char* end = text+bounds[k+1];
+        unsigned long row = firstRows[k];
+
+        while(it < end)
+        {
+            const char* nl = static_cast<const char*>(std::memchr(it, '\n', end-it));
+            const char* lineEnd = (nl != NULL)? nl: end;
+
+            if(isDataLine(it, lineEnd))
+            {
+                T* out = data + (colMajor? row: row*ncols);
+
+                bool valid;
+                const unsigned long count = parseCSVLine(it, lineEnd, out, inc, ncols, valid);
+
+                if(count != ncols || !valid)
+                {
+                    badRows[k] = row;
+                    badValues[k] = !valid;
+                    break;
+                }
+
+                ++row;
+            }
+
+            it = (nl != NULL)? nl+1: end;
+        }
+    }
+
+    for(long k=0; k<n; ++k)
+    {
+        if(badRows[k] != nrows)
+        {
+            std::stringstream str;
+            str << (badValues[k]? "Invalid value": "Wrong number of columns") << " in row " << badRows[k]+1 << " of file " << fileName;
+            throw gException(str.str());
+        }
+    }
+}
+
+}
+
+#endif // _GURLS_CSVPARSER_H_
@@ -0,0 +1,267 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_DATASET_H_
+#define _GURLS_DATASET_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <fstream>
+
+#include "gurls++/exports.h"
+#include "gurls++/gmat2d.h"
+#include "gurls++/chunkreader.h"
+#include "gurls++/mappedfile.h"
+
+namespace gurls {
+
+/**
+ * \ingroup Common
+ * \brief Header of the binary dataset files written by DatasetWriter.
+ *
+ * A dataset file holds the inputs and the outputs of rows samples, split in chunks
+ * of chunkRows samples. The file is made of
+ *   - this 128 bytes header;
+ *   - the chunks, each one holding the cols+outputs columns of its samples, either
+ *     one column after the other (COLUMN_CHUNKS) or one sample after the other (ROW_CHUNKS);
+ *   - if statsOffset is not 0, the means followed by the standard deviations of
+ *     the cols+outputs columns, as doubles;
+ *   - the index, i.e. the file offsets of the chunks, as 64 bits integers.
+ *
+ * All the values are in the native byte order.
+ */
+struct GURLS_EXPORT DatasetFileHeader
+{
+    /**
+     * Layout of the samples inside a chunk
+     */
+    enum Layout {COLUMN_CHUNKS = 0, ROW_CHUNKS = 1};
+
+    char magic[8];                  ///< "GURLSDST"
+    unsigned int version;           ///< Format version, currently 1
+    unsigned int elementSize;       ///< sizeof of the element type
+    unsigned int integer;           ///< 1 if the elements are integers, 0 if they are floating point values
+    unsigned int layout;            ///< Layout of the chunks
+    unsigned long long rows;        ///< Number of samples
+    unsigned long long cols;        ///< Number of input variables
+    unsigned long long outputs;     ///< Number of outputs
+    unsigned long long chunkRows;   ///< Number of samples of every chunk but the last one
+    unsigned long long chunks;      ///< Number of chunks
+    unsigned long long statsOffset; ///< Offset of the column statistics, 0 if they are not stored
+    unsigned long long indexOffset; ///< Offset of the chunk index
+    char padding[48];
+
+    static const std::size_t headerSize = 128;  ///< Size of the header in the file
+
+    /**
+     * Builds the header of an empty dataset
+     */
+    DatasetFileHeader(unsigned long long cols, unsigned long long outputs, unsigned long long chunkRows,
+                      unsigned int elementSize, bool integer, Layout layout);
+
+    /**
+     * Reads and validates the header at the beginning of a buffer of fileSize bytes.
+     * An exception is thrown if the header, the index or the chunks do not fit in the buffer.
+     */
+    static DatasetFileHeader read(const char* buffer, std::size_t fileSize, const std::string& fileName);
+
+    /**
+     * Returns the number of samples of the k-th chunk
+     */
+    unsigned long long chunkSize(unsigned long long k) const;
+};
+
+/**
+ * \ingroup Common
+ * \brief DatasetWriter writes a dataset file (see \ref DatasetFileHeader) one block of samples at a time.
+ *
+ * The samples are buffered until a chunk is complete; the mean and the standard
+ * deviation (normalized by n-1, as in NormZScore) of every column are accumulated
+ * while writing. The statistics, the index and the final header are written by close().
+ * \tparam T Cells type.
+ */
+template <typename T>
+class DatasetWriter
+{
+public:
+
+    /**
+     * Creates the file fileName
+     *
+     * \param fileName path of the file
+     * \param cols number of input variables
+     * \param outputs number of outputs
+     * \param chunkRows number of samples per chunk
+     * \param layout layout of the samples inside a chunk
+     * \param stats whether to store the column statistics
+     */
+    DatasetWriter(const std::string& fileName, unsigned long cols, unsigned long outputs, unsigned long chunkRows = 65536,
+                  DatasetFileHeader::Layout layout = DatasetFileHeader::COLUMN_CHUNKS, bool stats = true);
+
+    /**
+     * Closes the file if close() was not called, discarding the errors
+     */
+    ~DatasetWriter();
+
+    /**
+     * Appends rows samples
+     *
+     * \param X rows-by-cols matrix of inputs, with leading dimension ldx
+     * \param ldx leading dimension of X
+     * \param y rows-by-outputs matrix of outputs, with leading dimension ldy
+     * \param ldy leading dimension of y
+     * \param rows number of samples
+     */
+    void write(const T* X, unsigned long ldx, const T* y, unsigned long ldy, unsigned long rows);
+
+    /**
+     * Appends the samples of the matrices X and y
+     */
+    void write(const gMat2D<T>& X, const gMat2D<T>& y);
+
+    /**
+     * Appends all the samples delivered by reader, read in blocks of chunkRows samples
+     */
+    void write(ChunkReader<T>& reader);
+
+    /**
+     * Writes the last chunk, the statistics, the index and the header, and closes the file
+     */
+    void close();
+
+protected:
+
+    /**
+     * Writes the buffered samples as a chunk
+     */
+    void flush();
+
+    std::string fileName;           ///< Name of the file
+    std::ofstream out;              ///< Output file
+    DatasetFileHeader header;       ///< Header, completed by close()
+    std::vector<T> chunk;           ///< Samples of the current chunk, column-major
+    unsigned long buffered;         ///< Number of samples in chunk
+    std::vector<unsigned long long> index;  ///< Offsets of the written chunks
+    bool stats;                     ///< Whether the statistics are stored
+    std::vector<double> means;      ///< Running means of the columns
+    std::vector<double> m2;         ///< Running sums of the squared deviations of the columns
+
+private:
+
+    DatasetWriter(const DatasetWriter<T>&);
+    DatasetWriter<T>& operator=(const DatasetWriter<T>&);
+};
+
+/**
+ * \ingroup Common
+ * \brief DatasetChunkReader is a ChunkReader on a dataset file written by DatasetWriter.
+ *
+ * The file is memory-mapped, hence the samples are read from the page cache
+ * without loading the whole dataset. Files of floats can be read as doubles and
+ * vice versa; any other element type must match T.
+ * \tparam T Cells type.
+ */
+template <typename T>
+class DatasetChunkReader: public ChunkReader<T> {
+
+public:
+
+    /**
+     * Opens the dataset file fileName
+     */
+    DatasetChunkReader(const std::string& fileName, MappedFile::AccessHint hint = MappedFile::SEQUENTIAL);
+
+    unsigned long cols() const {return static_cast<unsigned long>(header.cols); }
+    unsigned long outputs() const {return static_cast<unsigned long>(header.outputs); }
+    unsigned long read(T* X, unsigned long ldx, T* y, unsigned long ldy, unsigned long maxRows);
+    void rewind() {next = 0; }
+
+    /**
+     * Returns the number of samples of the dataset
+     */
+    unsigned long rows() const {return static_cast<unsigned long>(header.rows); }
+
+    /**
+     * Moves to the sample row, which is returned by the next call to read()
+     */
+    void seek(unsigned long row);
+
+    /**
+     * Returns true if the file stores the column statistics
+     */
+    bool hasStats() const {return header.statsOffset != 0; }
+
+    /**
+     * Returns the means and the standard deviations of the inputs and of the outputs, as 1-by-cols()
+     * and 1-by-outputs() matrices. An exception is thrown if the file stores no statistics.
+     */
+    void getStats(gMat2D<T>& meanX, gMat2D<T>& stdX, gMat2D<T>& meanY, gMat2D<T>& stdY) const;
+
+    /**
+     * Reads the whole dataset in the matrices X and y
+     */
+    void readAll(gMat2D<T>& X, gMat2D<T>& y);
+
+protected:
+
+    /**
+     * Copies count samples of the k-th chunk, starting from its sample offset, with source element type S
+     */
+    template<typename S>
+    void readChunk(unsigned long long k, unsigned long long offset, unsigned long count, T* X, unsigned long ldx, T* y, unsigned long ldy) const;
+
+    MappedFile file;                        ///< Mapped dataset file
+    DatasetFileHeader header;               ///< Header of the file
+    const unsigned long long* index;        ///< Offsets of the chunks
+    unsigned long next;                     ///< Next sample to be read
+
+private:
+
+    DatasetChunkReader(const DatasetChunkReader<T>&);
+    DatasetChunkReader<T>& operator=(const DatasetChunkReader<T>&);
+};
+
+}
+
+#include "dataset.hpp"
+
+#endif // _GURLS_DATASET_H_
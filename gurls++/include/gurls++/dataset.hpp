@@ -0,0 +1,368 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <algorithm>
+
+#include "gurls++/exceptions.h"
+
+namespace gurls {
+
+template <typename T>
+DatasetWriter<T>::DatasetWriter(const std::string& fileName, unsigned long cols, unsigned long outputs, unsigned long chunkRows,
+                                DatasetFileHeader::Layout layout, bool stats)
+    : fileName(fileName), out(fileName.c_str(), std::ios::out | std::ios::binary | std::ios::trunc),
+      header(cols, outputs, chunkRows, sizeof(T), std::numeric_limits<T>::is_integer, layout),
+      buffered(0), stats(stats), means(cols+outputs, 0.0), m2(cols+outputs, 0.0)
+{
+    if(chunkRows == 0)
+        throw gException(Exception_Illegal_Argument_Value);
+
+    if(!out.is_open())
+        throw gException("Could not create file " + fileName);
+
+    chunk.resize(chunkRows*(cols+outputs));
+
+    // placeholder, rewritten by close()
+    out.write(reinterpret_cast<const char*>(&header), DatasetFileHeader::headerSize);
+}
+
+template <typename T>
+DatasetWriter<T>::~DatasetWriter()
+{
+    try
+    {
+        close();
+    }
+    catch(gException&)
+    {}
+}
+
+template <typename T>
+void DatasetWriter<T>::write(const T* X, unsigned long ldx, const T* y, unsigned long ldy, unsigned long rows)
+{
+    const unsigned long d = static_cast<unsigned long>(header.cols);
+    const unsigned long t = static_cast<unsigned long>(header.outputs);
+    const unsigned long chunkRows = static_cast<unsigned long>(header.chunkRows);
+
+    if(!out.is_open())
+        throw gException("File " + fileName + " has already been closed");
+
+    for(unsigned long done = 0; done < rows; )
+    {
+        const unsigned long count = std::min(rows-done, chunkRows-buffered);
+
+        for(unsigned long j=0; j<d; ++j)
+            copy(&chunk[buffered + j*chunkRows], X + done + j*ldx, count);
+
+        for(unsigned long j=0; j<t; ++j)
+            copy(&chunk[buffered + (d+j)*chunkRows], y + done + j*ldy, count);
+
+        buffered += count;
+        done += count;
+
+        if(buffered == chunkRows)
+            flush();
+    }
+}
+
+template <typename T>
+void DatasetWriter<T>::write(const gMat2D<T>& X, const gMat2D<T>& y)
+{
+    if(X.rows() != y.rows() || X.cols() != header.cols || y.cols() != header.outputs)
+        throw gException(Exception_Inconsistent_Size);
+
+    write(X.getData(), X.rows(), y.getData(), y.rows(), X.rows());
+}
+
+template <typename T>
+void DatasetWriter<T>::write(ChunkReader<T>& reader)
+{
+    const unsigned long d = static_cast<unsigned long>(header.cols);
+    const unsigned long chunkRows = static_cast<unsigned long>(header.chunkRows);
+
+    if(reader.cols() != header.cols || reader.outputs() != header.outputs)
+        throw gException(Exception_Inconsistent_Size);
+
+    if(!out.is_open())
+        throw gException("File " + fileName + " has already been closed");
+
+    // the samples are read straight into the chunk buffer
+    unsigned long rows;
+    do
+    {
+        T* X = chunk.empty()? NULL: &chunk[0];
+        rows = reader.read(X + buffered, chunkRows, X + d*chunkRows + buffered, chunkRows, chunkRows-buffered);
+        buffered += rows;
+
+        if(buffered == chunkRows)
+            flush();
+    }
+    while(rows > 0);
+}
+
+template <typename T>
+void DatasetWriter<T>::flush()
+{
+    if(buffered == 0)
+        return;
+
+    const unsigned long width = static_cast<unsigned long>(header.cols + header.outputs);
+    const unsigned long chunkRows = static_cast<unsigned long>(header.chunkRows);
+
+    if(stats)
+    {
+        // merge the mean and the sum of squared deviations of the chunk into the running ones
+        const double n = static_cast<double>(header.rows);
+        const double nc = static_cast<double>(buffered);
+
+        for(unsigned long j=0; j<width; ++j)
+        {
+            const T* column = &chunk[j*chunkRows];
+
+            double mean = 0.0;
+            for(unsigned long i=0; i<buffered; ++i)
+                mean += column[i];
+            mean /= nc;
+
+            double sq = 0.0;
+            for(unsigned long i=0; i<buffered; ++i)
+                sq += (column[i]-mean)*(column[i]-mean);
+
+            const double delta = mean - means[j];
+            means[j] += delta*nc/(n+nc);
+            m2[j] += sq + delta*delta*n*nc/(n+nc);
+        }
+    }
+
+    index.push_back(static_cast<std::streamoff>(out.tellp()));
+
+    if(header.layout == DatasetFileHeader::COLUMN_CHUNKS)
+    {
+        for(unsigned long j=0; j<width; ++j)
+            out.write(reinterpret_cast<const char*>(&chunk[j*chunkRows]), buffered*sizeof(T));
+    }
+    else
+    {
+        std::vector<T> rowChunk(buffered*width);
+        for(unsigned long j=0; j<width; ++j)
+            copy(&rowChunk[j], &chunk[j*chunkRows], buffered, width, 1);
+
+        out.write(reinterpret_cast<const char*>(&rowChunk[0]), rowChunk.size()*sizeof(T));
+    }
+
+    if(!out)
+        throw gException("Error writing file " + fileName);
+
+    header.rows += buffered;
+    buffered = 0;
+}
+
+template <typename T>
+void DatasetWriter<T>::close()
+{
+    if(!out.is_open())
+        return;
+
+    flush();
+
+    const unsigned long width = static_cast<unsigned long>(header.cols + header.outputs);
+    const char zeros[sizeof(double)] = {0};
+
+    // the statistics and the index are aligned to 8 bytes
+    const unsigned long long end = static_cast<std::streamoff>(out.tellp());
+    out.write(zeros, (sizeof(double) - end%sizeof(double))%sizeof(double));
+
+    if(stats)
+    {
+        std::vector<double> values(means);
+        for(unsigned long j=0; j<width; ++j)
+            values.push_back((header.rows > 1)? std::sqrt(m2[j]/(header.rows-1)): 0.0);
+
+        header.statsOffset = static_cast<std::streamoff>(out.tellp());
+        if(!values.empty())
+            out.write(reinterpret_cast<const char*>(&values[0]), values.size()*sizeof(double));
+    }
+
+    header.chunks = index.size();
+    header.indexOffset = static_cast<std::streamoff>(out.tellp());
+    if(!index.empty())
+        out.write(reinterpret_cast<const char*>(&index[0]), index.size()*sizeof(unsigned long long));
+
+    out.seekp(0, std::ios::beg);
+    out.write(reinterpret_cast<const char*>(&header), DatasetFileHeader::headerSize);
+    out.close();
+
+    if(!out)
+        throw gException("Error writing file " + fileName);
+}
+
+
+template <typename T>
+DatasetChunkReader<T>::DatasetChunkReader(const std::string& fileName, MappedFile::AccessHint hint)
+    : file(fileName, hint), header(DatasetFileHeader::read(file.getData(), file.getSize(), fileName)), next(0)
+{
+    const bool floating = !std::numeric_limits<T>::is_integer;
+    const bool converted = floating && header.integer == 0 && (header.elementSize == sizeof(float) || header.elementSize == sizeof(double));
+
+    if(!converted && (header.elementSize != sizeof(T) || header.integer != (floating? 0u: 1u)))
+        throw gException("The element type of " + fileName + " does not match the type of the reader");
+
+    index = reinterpret_cast<const unsigned long long*>(file.getData() + header.indexOffset);
+}
+
+template <typename T>
+template <typename S>
+void DatasetChunkReader<T>::readChunk(unsigned long long k, unsigned long long offset, unsigned long count,
+                                      T* X, unsigned long ldx, T* y, unsigned long ldy) const
+{
+    const unsigned long d = cols();
+    const unsigned long t = outputs();
+    const unsigned long long n = header.chunkSize(k);
+    const S* data = reinterpret_cast<const S*>(file.getData() + index[k]);
+
+    if(header.layout == DatasetFileHeader::COLUMN_CHUNKS)
+    {
+        for(unsigned long j=0; j<d+t; ++j)
+        {
+            const S* src = data + j*n + offset;
+            T* dst = (j<d)? X + j*ldx: y + (j-d)*ldy;
+
+            for(unsigned long i=0; i<count; ++i)
+                dst[i] = static_cast<T>(src[i]);
+        }
+    }
+    else
+    {
+        for(unsigned long i=0; i<count; ++i)
+        {
+            const S* src = data + (offset+i)*(d+t);
+
+            for(unsigned long j=0; j<d; ++j)
+                X[i + j*ldx] = static_cast<T>(src[j]);
+
+            for(unsigned long j=0; j<t; ++j)
+                y[i + j*ldy] = static_cast<T>(src[d+j]);
+        }
+    }
+}
+
+template <typename T>
+unsigned long DatasetChunkReader<T>::read(T* X, unsigned long ldx, T* y, unsigned long ldy, unsigned long maxRows)
+{
+    unsigned long rows = 0;
+
+    while(rows < maxRows && next < header.rows)
+    {
+        const unsigned long long k = next/header.chunkRows;
+        const unsigned long long offset = next%header.chunkRows;
+        const unsigned long count = static_cast<unsigned long>(std::min<unsigned long long>(header.chunkSize(k)-offset, maxRows-rows));
+
+        if(header.elementSize == sizeof(T))
+            readChunk<T>(k, offset, count, X+rows, ldx, y+rows, ldy);
+        else if(header.elementSize == sizeof(float))
+            readChunk<float>(k, offset, count, X+rows, ldx, y+rows, ldy);
+        else
+            readChunk<double>(k, offset, count, X+rows, ldx, y+rows, ldy);
+
+        rows += count;
+        next += count;
+    }
+
+    return rows;
+}
+
+template <typename T>
+void DatasetChunkReader<T>::seek(unsigned long row)
+{
+    if(row > header.rows)
+        throw gException(Exception_Index_Out_of_Bound);
+
+    next = row;
+}
+
+template <typename T>
+void DatasetChunkReader<T>::getStats(gMat2D<T>& meanX, gMat2D<T>& stdX, gMat2D<T>& meanY, gMat2D<T>& stdY) const
+{
+    if(!hasStats())
+        throw gException("File " + file.getFileName() + " does not store the column statistics");
+
+    const unsigned long d = cols();
+    const unsigned long t = outputs();
+
+    std::vector<double> values(2*(d+t));
+    if(!values.empty())
+        std::memcpy(&values[0], file.getData() + header.statsOffset, values.size()*sizeof(double));
+
+    meanX.resize(1, d);
+    stdX.resize(1, d);
+    meanY.resize(1, t);
+    stdY.resize(1, t);
+
+    for(unsigned long j=0; j<d; ++j)
+    {
+        meanX.getData()[j] = static_cast<T>(values[j]);
+        stdX.getData()[j] = static_cast<T>(values[d+t+j]);
+    }
+
+    for(unsigned long j=0; j<t; ++j)
+    {
+        meanY.getData()[j] = static_cast<T>(values[d+j]);
+        stdY.getData()[j] = static_cast<T>(values[2*d+t+j]);
+    }
+}
+
+template <typename T>
+void DatasetChunkReader<T>::readAll(gMat2D<T>& X, gMat2D<T>& y)
+{
+    const unsigned long n = rows();
+
+    X.resize(n, cols());
+    y.resize(n, outputs());
+
+    next = 0;
+    read(X.getData(), n, y.getData(), n, n);
+    next = 0;
+}
+
+}
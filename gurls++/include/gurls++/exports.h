@@ -13,4 +13,9 @@
 #  define GURLS_EXPORT
 #endif
 
+// move constructors and move assignments are declared when the compiler supports rvalue references
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#  define GURLS_RVALUE_REFS
+#endif
+
 #endif // GURLS_EXP_H
\ No newline at end of file
@@ -59,6 +59,7 @@
 #include "gurls++/exceptions.h"
 #include "gurls++/gvec.h"
 #include "gurls++/gmath.h"
+#include "gurls++/csvparser.h"
 
 namespace gurls {
 
@@ -104,6 +105,23 @@ public:
       */
     gMat2D<T>& operator=(const gMat2D<T>& other);
 
+#ifdef GURLS_RVALUE_REFS
+    /**
+      * Move constructor, takes the buffer of \a other, which is left empty
+      */
+    gMat2D(gMat2D<T>&& other);
+
+    /**
+      * Move assignment, exchanges the buffers of the two matrices
+      */
+    gMat2D<T>& operator=(gMat2D<T>&& other);
+#endif
+
+    /**
+      * Exchanges buffers, sizes and ownership with \a other, without copying
+      */
+    void swap(gMat2D<T>& other);
+
     /**
       * Returns a r-by-c matrix of all zeros
       */
@@ -530,6 +548,22 @@ public:
       */
     void saveCSV(const std::string& fileName) const;
 
+    /**
+      * Saves the matrix into a binary file (see \ref MatrixFileHeader) that can be mapped with mapBinary
+      */
+    void saveBinary(const std::string& fileName) const;
+
+    /**
+      * Maps a binary file written by saveBinary, without copying its content.
+      * The matrix does not own the mapped buffer and cannot be resized; changes to
+      * its elements are private to the process and are not written to the file.
+      *
+      * \param fileName path of the file
+      * \param hint expected access pattern
+      * \param populate if true the whole file is read in memory before returning
+      */
+    void mapBinary(const std::string& fileName, MappedFile::AccessHint hint = MappedFile::NORMAL, bool populate = false);
+
 };
 
 }
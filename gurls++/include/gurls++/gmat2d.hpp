@@ -25,7 +25,6 @@ typedef boost::archive::text_oarchive oarchive;
 #endif
 
 #include <boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
 
 #include <fstream>
 #include <string>
@@ -76,6 +75,30 @@ gMat2D<T>::gMat2D(const gMat2D<T>& other) : numcols(other.numcols), numrows(othe
     *this = other;
 }
 
+#ifdef GURLS_RVALUE_REFS
+template <typename T>
+gMat2D<T>::gMat2D(gMat2D<T>&& other) : numcols(0), numrows(0)
+{
+    this->swap(other);
+}
+
+template <typename T>
+gMat2D<T>& gMat2D<T>::operator=(gMat2D<T>&& other)
+{
+    this->swap(other);
+
+    return *this;
+}
+#endif
+
+template <typename T>
+void gMat2D<T>::swap(gMat2D<T>& other)
+{
+    BaseArray<T>::swap(other);
+    std::swap(this->numrows, other.numrows);
+    std::swap(this->numcols, other.numcols);
+}
+
 // WARNING: TO BE DISCUSSED
 template <typename T>
 gMat2D<T>& gMat2D<T>::operator=(const gMat2D<T>& other)
@@ -675,12 +698,15 @@ template <typename T>
 template<class Archive>
 void gMat2D<T>::load(Archive & ar, const unsigned int /* file_version */)
 {
+    this->release();
+
     ar & this->numrows;
     ar & this->numcols;
     ar & this->isowner;
 
+    this->isowner = true;
     this->size = this->numrows*this->numcols;
-    this->data = new T[this->size];
+    this->data = alloc_buffer<T>(this->size);
     T* ptr = this->data;
     T* ptr_end = this->data+this->size;
 
@@ -735,51 +761,27 @@ void gMat2D<T>::save(const std::string& fileName) const
 template <typename T>
 void gMat2D<T>::readCSV(const std::string& fileName, bool colMajor)
 {
-    std::vector<std::vector< T > > matrix;
-    std::ifstream in(fileName.c_str());
+    std::ifstream in(fileName.c_str(), std::ios_base::binary);
 
     if(!in.is_open())
         throw gurls::gException("Cannot open file " + fileName);
 
-    unsigned long rows = 0;
-    unsigned long cols = 0;
-
-    std::string line;
-    typedef boost::tokenizer<boost::char_separator<char> > tokenizer;
-    boost::char_separator<char> sep(" ;|,");
+    in.seekg(0, std::ios::end);
+    const std::streamoff fileSize = in.tellg();
+    in.close();
 
-    while (std::getline(in, line))
+    if(fileSize <= 0)
     {
-        if(!line.empty())
-        {
-            std::vector<T> tf;
-
-            tokenizer tokens(line, sep);
-            for (tokenizer::iterator it = tokens.begin(); it != tokens.end(); ++it)
-                tf.push_back(boost::lexical_cast<T>(*it));
-
-            matrix.push_back(tf);
-            ++rows;
-        }
+        this->resize(0, 0);
+        return;
     }
 
-    in.close();
-
-    if(!matrix.empty())
-        cols = matrix[0].size();
-
-    this->resize(rows, cols);
+    // the file is mapped and parsed in parallel straight into the matrix
+    MappedFile file(fileName, MappedFile::SEQUENTIAL);
+    CSVParser<T> parser(file.getData(), file.getSize(), fileName);
 
-    if(colMajor)
-    {
-        for(unsigned long i=0; i<rows; ++i)
-            gurls::copy(this->data + i, &(*(matrix[i].begin())), cols, rows, 1);
-    }
-    else
-    {
-        for(unsigned long i=0; i<rows; ++i)
-            gurls::copy(this->data + i*cols, &(*(matrix[i].begin())), rows);
-    }
+    this->resize(parser.rows(), parser.cols());
+    parser.parse(this->data, colMajor);
 }
 
 template <typename T>
@@ -803,4 +805,49 @@ void gMat2D<T>::saveCSV(const std::string& fileName) const
     out.close();
 }
 
+template <typename T>
+void gMat2D<T>::saveBinary(const std::string& fileName) const
+{
+    std::ofstream out(fileName.c_str(), std::ios_base::binary);
+
+    if(!out.is_open())
+        throw gException("Could not open file " + fileName);
+
+    const MatrixFileHeader header(this->numrows, this->numcols, sizeof(T), std::numeric_limits<T>::is_integer);
+
+    out.write(reinterpret_cast<const char*>(&header), MatrixFileHeader::headerSize);
+    out.write(reinterpret_cast<const char*>(this->data), this->size*sizeof(T));
+
+    if(!out)
+        throw gException("Could not write file " + fileName);
+
+    out.close();
+}
+
+template <typename T>
+void gMat2D<T>::mapBinary(const std::string& fileName, MappedFile::AccessHint hint, bool populate)
+{
+    MappedFile* file = new MappedFile(fileName, hint, populate);
+
+    MatrixFileHeader header(0, 0, 0, false);
+    try
+    {
+        header = MatrixFileHeader::read(file->getData(), file->getSize(), sizeof(T), std::numeric_limits<T>::is_integer, fileName);
+    }
+    catch(gException&)
+    {
+        delete file;
+        throw;
+    }
+
+    this->release();
+
+    this->mapping = file;
+    this->isowner = false;
+    this->data = reinterpret_cast<T*>(file->getData() + MatrixFileHeader::headerSize);
+    this->numrows = static_cast<unsigned long>(header.rows);
+    this->numcols = static_cast<unsigned long>(header.cols);
+    this->size = this->numrows*this->numcols;
+}
+
 }
@@ -316,6 +316,52 @@ GURLS_EXPORT void copy(float* dst, const float* src, const int size, const int d
 template<>
 GURLS_EXPORT void copy(double* dst, const double* src, const int size, const int dstIncr, const int srcIncr);
 
+/**
+  * Gathers the submatrix src(rows, cols) of a column-major matrix into dst.
+  *
+  * The destination is written one column segment at a time, so that the writes are
+  * sequential and every read of a segment falls in the same column of the source.
+  * The segments are distributed among the OpenMP threads when the submatrix is large.
+  *
+  * \param dst output submatrix
+  * \param ldd leading dimension of dst
+  * \param src input matrix
+  * \param lds leading dimension of src
+  * \param rows row indices to copy, or NULL to copy the first nRows rows
+  * \param nRows number of rows of the submatrix
+  * \param cols column indices to copy, or NULL to copy the first nCols columns
+  * \param nCols number of columns of the submatrix
+  */
+template<typename T>
+void gather_submatrix(T* dst, const unsigned long ldd, const T* src, const unsigned long lds,
+                      const unsigned long* rows, const unsigned long nRows,
+                      const unsigned long* cols, const unsigned long nCols)
+{
+    const unsigned long segment = 1024;
+    const long nseg = static_cast<long>((nRows+segment-1)/segment);
+    const long ntasks = nseg*static_cast<long>(nCols);
+
+#pragma omp parallel for schedule(static) if(nRows*nCols > (1ul << 16))
+    for(long task=0; task<ntasks; ++task)
+    {
+        const unsigned long j = task/nseg;
+        const unsigned long i0 = (task%nseg)*segment;
+        const unsigned long len = std::min(segment, nRows-i0);
+
+        const T* s_col = src + ((cols != NULL)? cols[j]: j)*lds;
+        T* d_it = dst + j*ldd + i0;
+
+        if(rows == NULL)
+            copy(d_it, s_col+i0, static_cast<int>(len));
+        else
+        {
+            const unsigned long* r_it = rows+i0;
+            for(T* end = d_it+len; d_it != end; ++d_it, ++r_it)
+                *d_it = s_col[*r_it];
+        }
+    }
+}
+
 /**
   * Generates a submatrix from an input matrix
   *
@@ -328,15 +374,9 @@ GURLS_EXPORT void copy(double* dst, const double* src, const int size, const int
   * \param indices_cols vector containing the column indices to copy (length must be == sizeCols)
   */
 template<typename T>
-void copy_submatrix(T* dst, const T* src, const int src_Rows, const int sizeRows, const int sizeCols, unsigned long *indices_rows, unsigned long *indices_cols)
+void copy_submatrix(T* dst, const T* src, const int src_Rows, const int sizeRows, const int sizeCols, const unsigned long *indices_rows, const unsigned long *indices_cols)
 {
-  int t=0;
-  for (int j = 0; j < sizeCols; ++j)
-    for (int i = 0; i < sizeRows; ++i)
-    {
-        dst[t] = src[ indices_rows[i] + indices_cols[j]*src_Rows ];
-        ++t;
-    }
+    gather_submatrix(dst, sizeRows, src, src_Rows, indices_rows, sizeRows, indices_cols, sizeCols);
 }
 
 /**
@@ -355,8 +395,7 @@ void subMatrixFromRows(const T* matrix, const int mRows, const int mCols, const
     if(mRows < nIndices)
         throw gException(Exception_Inconsistent_Size);
 
-    for(const unsigned long *it = rowsIndices, *end = rowsIndices+nIndices; it != end; ++it)
-        copy(submat + (it-rowsIndices), matrix+(*it), mCols, nIndices, mRows);
+    gather_submatrix(submat, nIndices, matrix, mRows, rowsIndices, nIndices, (const unsigned long*)NULL, mCols);
 }
 
 
@@ -408,6 +447,34 @@ void clearLowerTriangular(T* matrix, int rows, int cols)
     }
 }
 
+/**
+  * Copies the lower triangle of a square matrix onto its upper triangle,
+  * making the matrix symmetric
+  *
+  * \param matrix input matrix
+  * \param n number of rows and columns
+  */
+template <typename T>
+void copyLowerToUpper(T* matrix, int n)
+{
+    for (int j = 1; j < n; ++j)
+        copy(matrix + j*n, matrix + j, j, 1, n);
+}
+
+/**
+  * Copies the upper triangle of a square matrix onto its lower triangle,
+  * making the matrix symmetric
+  *
+  * \param matrix input matrix
+  * \param n number of rows and columns
+  */
+template <typename T>
+void copyUpperToLower(T* matrix, int n)
+{
+    for (int j = 1; j < n; ++j)
+        copy(matrix + j, matrix + j*n, j, n, 1);
+}
+
 /**
   * Computes the pseudo-inverse of a matrix
   *
@@ -22,6 +22,9 @@ template<typename T>
 class GPRWrapper: public KernelWrapper<T>
 {
 public:
+    enum GPMode{EXACT, FITC, DTC};                  ///< Exact GP inference or sparse approximations with inducing points
+    enum InducingSelection{UNIFORM, KMEANSPP};      ///< Strategies for the selection of the inducing points
+
     /**
       * Constructor
       *
@@ -51,16 +54,54 @@ public:
     gMat2D<T>* eval(const gMat2D<T> &X);
 
     /**
-      * Estimates label for an input matrix
+      * Estimates label for an input matrix, together with the predictive variances
       *
       * \param[in] X Input matrix
+      * \param[out] vars Matrix of predictive variances
       * \returns Matrix of predicted labels
       */
     gMat2D<T>* eval(const gMat2D<T> &X, gMat2D<T> &vars);
 
+    /**
+      * Sets the inference method:
+      * - EXACT: exact GP inference, O(n^3) training (default)
+      * - FITC: sparse GP with m inducing points and the diagonal of the residual covariance
+      *   added to the noise, O(n*m^2) training
+      * - DTC: sparse GP with m inducing points and homoscedastic noise, O(n*m^2) training
+      *
+      * In the sparse modes the hyperparameters are selected on the hold-out split with the sparse
+      * estimator itself (see \ref ParamSelHoSparseGPRegr), so the n-by-n kernel matrix is never formed.
+      */
+    void setGPMode(GPMode value);
+
+    /**
+      * Sets the number of inducing points of the sparse modes
+      */
+    void setNInducing(unsigned long value);
+
+    /**
+      * Sets the strategy used to select the inducing points among the training samples:
+      * - UNIFORM: uniform sampling (default)
+      * - KMEANSPP: k-means++ seeding in the feature space of the kernel
+      */
+    void setInducingSelection(InducingSelection value);
+
 protected:
 
+    /**
+      * Replaces opt.kernel with a list holding only the kernel type, which is all the sparse modes need
+      */
+    void resetKernel();
+
+    /**
+      * Computes the predictive means and, if vars is not NULL, the predictive variances
+      */
+    gMat2D<T>* predict(const gMat2D<T> &X, gMat2D<T> *vars);
+
     GurlsOptionsList *norm;
+
+    GPMode gpMode;                  ///< Inference method
+    InducingSelection iSelection;   ///< Inducing points selection strategy
 };
 
 }
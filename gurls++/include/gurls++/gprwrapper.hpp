@@ -11,7 +11,7 @@ namespace gurls
 {
 
 template <typename T>
-GPRWrapper<T>::GPRWrapper(const std::string &name): KernelWrapper<T>(name), norm(NULL) { }
+GPRWrapper<T>::GPRWrapper(const std::string &name): KernelWrapper<T>(name), norm(NULL), gpMode(EXACT), iSelection(UNIFORM) { }
 
 template <typename T>
 GPRWrapper<T>::~GPRWrapper()
@@ -41,6 +41,14 @@ void GPRWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     const unsigned long nlambda = static_cast<unsigned long>(this->opt->getOptAsNumber("nlambda"));
     const unsigned long nsigma = static_cast<unsigned long>(this->opt->getOptAsNumber("nsigma"));
 
+    const bool sparse = (gpMode != EXACT);
+    if(sparse)
+    {
+        GurlsOptionsList* sparsegp = this->opt->template getOptAs<GurlsOptionsList>("sparsegp");
+        sparsegp->template getOptValue<OptString>("approx") = (gpMode == FITC)? "fitc": "dtc";
+        sparsegp->template getOptValue<OptString>("selection") = (iSelection == KMEANSPP)? "kmeans++": "uniform";
+    }
+
 
     OptTaskSequence *seq = new OptTaskSequence();
     GurlsOptionsList * process = new GurlsOptionsList("processes", false);
@@ -54,15 +62,26 @@ void GPRWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     {
         if(nlambda > 1ul)
         {
-            *seq << "split:ho" << "kernel:linear" << "paramsel:hogpregr";
-            *process1 << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave;
+            if(!sparse)
+            {
+                *seq << "split:ho" << "kernel:linear" << "paramsel:hogpregr";
+                *process1 << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave;
+            }
+            else
+            {
+                *seq << "split:ho" << "paramsel:hosparsegpregr";
+                *process1 << GURLS::computeNsave << GURLS::computeNsave;
+            }
         }
         else if(nlambda == 1ul)
         {
             if(this->opt->hasOpt("paramsel.lambdas"))
             {
-                *seq << "kernel:linear";
-                *process1 << GURLS::computeNsave;
+                if(!sparse)
+                {
+                    *seq << "kernel:linear";
+                    *process1 << GURLS::computeNsave;
+                }
             }
             else
                 throw gException("Please set a valid value for the regularization parameter, calling setParam(value)");
@@ -76,15 +95,31 @@ void GPRWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
         {
             if(nsigma > 1ul)
             {
-                *seq << "split:ho" << "paramsel:siglamhogpregr" << "kernel:rbf";
-                *process1 << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave;
+                if(!sparse)
+                {
+                    *seq << "split:ho" << "paramsel:siglamhogpregr" << "kernel:rbf";
+                    *process1 << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave;
+                }
+                else
+                {
+                    *seq << "split:ho" << "paramsel:hosparsegpregr";
+                    *process1 << GURLS::computeNsave << GURLS::computeNsave;
+                }
             }
             else if(nsigma == 1ul)
             {
                 if(this->opt->hasOpt("paramsel.sigma"))
                 {
-                    *seq << "split:ho" << "kernel:rbf" << "paramsel:hogpregr";
-                    *process1 << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave;
+                    if(!sparse)
+                    {
+                        *seq << "split:ho" << "kernel:rbf" << "paramsel:hogpregr";
+                        *process1 << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave;
+                    }
+                    else
+                    {
+                        *seq << "split:ho" << "paramsel:hosparsegpregr";
+                        *process1 << GURLS::computeNsave << GURLS::computeNsave;
+                    }
                 }
                 else
                     throw gException("Please set a valid value for the kernel parameter, calling setSigma(value)");
@@ -98,8 +133,11 @@ void GPRWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
             {
                 if(this->opt->hasOpt("paramsel.sigma") && this->opt->hasOpt("paramsel.lambdas"))
                 {
-                    *seq << "kernel:rbf";
-                    *process1 << GURLS::computeNsave;
+                    if(!sparse)
+                    {
+                        *seq << "kernel:rbf";
+                        *process1 << GURLS::computeNsave;
+                    }
                 }
                 else
                     throw gException("Please set a valid value for kernel and regularization parameters, calling setParam(value) and setSigma(value)");
@@ -111,24 +149,30 @@ void GPRWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
             throw gException("Please set a valid value for NParam, calling setNParam(value)");
     }
 
-    *seq << "optimizer:rlsgpregr";
+    *seq << (sparse? "optimizer:rlssparsegpregr": "optimizer:rlsgpregr");
     *process1 << GURLS::computeNsave;
 
+    if(sparse)
+        resetKernel();
+
     GURLS G;
     G.run(norm->getOptValue<OptMatrix<gMat2D<T> > >("X"), norm->getOptValue<OptMatrix<gMat2D<T> > >("Y"), *(this->opt), "one");
-
 }
 
 template <typename T>
 gMat2D<T>* GPRWrapper<T>::eval(const gMat2D<T> &X)
 {
-    gMat2D<T> vars;
-
-    return eval(X, vars);
+    return predict(X, NULL);
 }
 
 template <typename T>
 gMat2D<T>* GPRWrapper<T>::eval(const gMat2D<T> &X, gMat2D<T> &vars)
+{
+    return predict(X, &vars);
+}
+
+template <typename T>
+gMat2D<T>* GPRWrapper<T>::predict(const gMat2D<T> &X, gMat2D<T> *vars)
 {
     gMat2D<T> empty;
 
@@ -144,15 +188,20 @@ gMat2D<T>* GPRWrapper<T>::eval(const gMat2D<T> &X, gMat2D<T> &vars)
     this->opt->removeOpt("predkernel");
     this->opt->addOpt("predkernel", predkTrainTest.execute(Xresc, empty, *(this->opt)));
 
+    this->opt->removeOpt("predvars");
+    if(vars == NULL)
+        this->opt->addOpt("predvars", new OptNumber(0));
+
     GurlsOptionsList *pred = predTask.execute(Xresc, empty, *(this->opt));
 
+    this->opt->removeOpt("predvars");
+
     delete normX;
 
     OptMatrix<gMat2D<T> >* pmeans = pred->getOptAs<OptMatrix<gMat2D<T> > >("means");
     pmeans->detachValue();
 
     gMat2D<T> &predMeans = pmeans->getValue();
-    gMat2D<T> &predVars = pred->getOptValue<OptMatrix<gMat2D<T> > >("vars");
 
     const unsigned long n = predMeans.rows();
     const unsigned long t = predMeans.cols();
@@ -160,19 +209,27 @@ gMat2D<T>* GPRWrapper<T>::eval(const gMat2D<T> &X, gMat2D<T> &vars)
     T* column = predMeans.getData();
     const T* std_it = norm->getOptValue<OptMatrix<gMat2D<T> > >("stdY").getData();
     const T* mean_it = norm->getOptValue<OptMatrix<gMat2D<T> > >("meanY").getData();
-    const T* pvars_it = predVars.getData();
-
-    vars.resize(n, t);
 
-    T* vars_it = vars.getData();
-
-    for(unsigned long i=0; i<t; ++i, column+=n, ++std_it, ++mean_it, vars_it+=n)
+    for(unsigned long i=0; i<t; ++i, column+=n, ++std_it, ++mean_it)
     {
         scal(n, *std_it, column, 1);
         axpy(n, (T)1.0, mean_it, 0, column, 1);
+    }
+
+    if(vars != NULL)
+    {
+        const T* pvars_it = pred->getOptValue<OptMatrix<gMat2D<T> > >("vars").getData();
+
+        vars->resize(n, t);
 
-        copy(vars_it, pvars_it, n);
-        scal(n, (*std_it)*(*std_it), vars_it, 1);
+        T* vars_it = vars->getData();
+        std_it = norm->getOptValue<OptMatrix<gMat2D<T> > >("stdY").getData();
+
+        for(unsigned long i=0; i<t; ++i, ++std_it, vars_it+=n)
+        {
+            copy(vars_it, pvars_it, n);
+            scal(n, (*std_it)*(*std_it), vars_it, 1);
+        }
     }
 
     delete pred;
@@ -180,4 +237,35 @@ gMat2D<T>* GPRWrapper<T>::eval(const gMat2D<T> &X, gMat2D<T> &vars)
     return &predMeans;
 }
 
+template <typename T>
+void GPRWrapper<T>::setGPMode(GPMode value)
+{
+    gpMode = value;
+}
+
+template <typename T>
+void GPRWrapper<T>::setNInducing(unsigned long value)
+{
+    if(value == 0)
+        throw gException(Exception_Illegal_Argument_Value);
+
+    this->opt->template getOptValue<OptNumber>("sparsegp.m") = value;
+}
+
+template <typename T>
+void GPRWrapper<T>::setInducingSelection(InducingSelection value)
+{
+    iSelection = value;
+}
+
+template <typename T>
+void GPRWrapper<T>::resetKernel()
+{
+    GurlsOptionsList* kernel = new GurlsOptionsList("kernel");
+    kernel->addOpt("type", (this->kType == KernelWrapper<T>::LINEAR)? "linear": "rbf");
+
+    this->opt->removeOpt("kernel");
+    this->opt->addOpt("kernel", kernel);
+}
+
 }
@@ -53,6 +53,7 @@
 
 #include "gurls++/exports.h"
 #include "gurls++/exceptions.h"
+#include "gurls++/allocator.h"
 #include "gurls++/gmat2d.h"
 #include "gurls++/optlist.h"
 #include "gurls++/options.h"
@@ -78,6 +79,7 @@
 #include "gurls++/rlsdualr.h"
 #include "gurls++/rlspegasos.h"
 #include "gurls++/rlsgp.h"
+#include "gurls++/rlssparsegp.h"
 #include "gurls++/rlsprimalrecinit.h"
 #include "gurls++/rlsprimalrecupdate.h"
 #include "gurls++/rlsrandfeats.h"
@@ -97,6 +99,7 @@
 #include "gurls++/loogpregr.h"
 #include "gurls++/siglamhogpregr.h"
 #include "gurls++/siglamloogpregr.h"
+#include "gurls++/hosparsegpregr.h"
 
 #include "gurls++/pred.h"
 #include "gurls++/primal.h"
@@ -145,6 +148,19 @@ namespace gurls {
         /**
          * Implements a GURLS process and stores results of each GULRS task in opt.
          *
+         * The elapsed time of every task is stored in opt.time.<processid>, a 1 x #tasks matrix;
+         * its memory usage in opt.time.<processid>_memory, a 4 x #tasks matrix whose rows hold
+         * the peak bytes in use by the GURLS buffers during the task, the bytes and the number
+         * of buffers allocated by the task, and the growth of the peak resident bytes of the
+         * process during the task, as reported by the operating system. The last row also
+         * counts the memory allocated with new T[], but it is 0 for a task that stays below the
+         * peak reached by an earlier one.
+         * If opt.memorybudget is greater than 0, no task can hold more than that many megabytes
+         * of GURLS buffers: an allocation exceeding the budget throws gException. The budget
+         * only covers the buffers of the Allocator (the matrices and the scratch buffers that
+         * use it), while most tasks still allocate part of their scratch memory with new T[],
+         * which is neither counted nor limited.
+         *
          * \param X input data matrix
          * \param y labels matrix
          * \param opt initial GURLS options
@@ -244,6 +260,19 @@ void GURLS::run(const gMat2D<T>& X, const gMat2D<T>& y,
         T *process_time = process_time_vector->getData();
         set(process_time, (T)0.0, seq->size());
 
+        gMat2D<T>* process_memory_vector = new gMat2D<T>(4, seq->size());
+        T *process_memory = process_memory_vector->getData();
+        set(process_memory, (T)0.0, 4*seq->size());
+
+        MemoryStats memBegin, memEnd;
+        std::size_t residentBegin = 0;
+
+        std::size_t budget = 0;
+        if (opt.hasOpt("memorybudget") && opt.getOptAsNumber("memorybudget") > 0)
+            budget = static_cast<std::size_t>(opt.getOptAsNumber("memorybudget")*1048576.0);
+
+        MemoryBudgetScope budgetScope(budget);
+
         //%for i = 1:numel(opt.process) % Go by the length of process.
         //opt.time{jobid} = struct;
         //%end
@@ -279,6 +308,9 @@ void GURLS::run(const gMat2D<T>& X, const gMat2D<T>& y,
                 //	case {CPT, CSV, ~isfield(opt,reg{1})}
 
                 begin = boost::posix_time::microsec_clock::local_time();
+                Allocator::resetPeak();
+                memBegin = Allocator::stats();
+                residentBegin = Allocator::processResidentPeakBytes();
 
                 if (!reg1.compare("optimizer"))
                 {
@@ -372,6 +404,12 @@ void GURLS::run(const gMat2D<T>& X, const gMat2D<T>& y,
 
                 process_time[i] = ((T)diff.total_milliseconds())/1000.0;
 
+                memEnd = Allocator::stats();
+                process_memory[4*i] = (T)memEnd.peakBytes;
+                process_memory[4*i+1] = (T)(memEnd.allocatedBytes - memBegin.allocatedBytes);
+                process_memory[4*i+2] = (T)(memEnd.allocations - memBegin.allocations);
+                process_memory[4*i+3] = (T)(Allocator::processResidentPeakBytes() - residentBegin);
+
                 //		fName = [reg{1} '_' reg{2}];
                 //		fun = str2func(fName);
                 //		tic;
@@ -416,6 +454,8 @@ void GURLS::run(const gMat2D<T>& X, const gMat2D<T>& y,
 //        timelist->addOpt(processid, new OptNumberList(process_time));
         timelist->removeOpt(processid);
         timelist->addOpt(processid, new OptMatrix<gMat2D<T> >(*process_time_vector));
+        timelist->removeOpt(processid + "_memory");
+        timelist->addOpt(processid + "_memory", new OptMatrix<gMat2D<T> >(*process_memory_vector));
 
         //fprintf('\nSave cycle...\n');
         //% Delete whats not necessary
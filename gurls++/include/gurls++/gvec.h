@@ -89,6 +89,18 @@ public:
       */
     gVec<T>& operator=(const gVec<T>& other);
 
+#ifdef GURLS_RVALUE_REFS
+    /**
+      * Move constructor, takes the buffer of \a other, which is left empty
+      */
+    gVec(gVec<T>&& other) : BaseArray<T>(static_cast<BaseArray<T>&&>(other)) {}
+
+    /**
+      * Move assignment, exchanges the buffers of the two vectors
+      */
+    gVec<T>& operator=(gVec<T>&& other) { this->swap(other); return *this; }
+#endif
+
     /**
       * Returns a vector of all zeros
       */
@@ -57,6 +57,7 @@
 #include "gurls++/gmat2d.h"
 #include "gurls++/gvec.h"
 #include "gurls++/gmath.h"
+#include "gurls++/matrixview.h"
 
 #include "gurls++/paramsel.h"
 #include "gurls++/perf.h"
@@ -159,14 +160,12 @@ GurlsOptionsList *ParamSelHoDual<T>::execute(const gMat2D<T>& X, const gMat2D<T>
     const unsigned long y_rows = Y.rows();
     const unsigned long t = Y.cols();
 
-    const unsigned long x_rows = X.rows();
     const unsigned long d = X.cols();
 
 
+    // the predictions on the validation set are computed here from views of
+    // X and K, so that the nested options only hold opt.pred for the performance task
     GurlsOptionsList* nestedOpt = new GurlsOptionsList("nested");
-    nestedOpt->copyOpt("kernel", opt);
-
-    nestedOpt->addOpt("predkernel", new GurlsOptionsList("predkernel"));
 
 
     const GurlsOptionsList* split = opt.getOptAs<GurlsOptionsList>("split");
@@ -198,12 +197,10 @@ GurlsOptionsList *ParamSelHoDual<T>::execute(const gMat2D<T>& X, const gMat2D<T>
     set(acc_avg, (T)0.0, tot*t);
 
     //     for nh = 1:opt.nholdouts
-    GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
-
     Performance<T>* perfClass = Performance<T>::factory(opt.getOptAsString("hoperf"));
-    PredDual<T> dual;
 
-    nestedOpt->addOpt("optimizer",optimizer);
+    // the performance tasks only read Y and opt.pred
+    const gMat2D<T> emptyX;
 
     gMat2D<T>* perf_mat = new gMat2D<T>(nholdouts, tot*t);
     T* perf = perf_mat->getData();
@@ -227,7 +224,7 @@ GurlsOptionsList *ParamSelHoDual<T>::execute(const gMat2D<T>& X, const gMat2D<T>
 
 
         //Get K(tr,tr) from K
-        T* Q = new T[last*last];
+        T* Q = alloc_buffer<T>(last*last);
         copy_submatrix(Q, K.getData(), k_rows, last, last, tr, tr);
 
         T *L = new T[last];
@@ -235,92 +232,48 @@ GurlsOptionsList *ParamSelHoDual<T>::execute(const gMat2D<T>& X, const gMat2D<T>
 
         unsigned long r = getRank(last, n, d, linearKernel, opt);
 
-        if(!linearKernel)
-        {
-            // 	opt.predkernel.K = opt.kernel.K(va,tr);%nva x ntr
-            gMat2D<T>* predK = new gMat2D<T>(n-last, last);
-
-            copy_submatrix(predK->getData(), K.getData(), k_rows, n-last, last, va, tr);
-
-            GurlsOptionsList* predkernel = nestedOpt->getOptAs<GurlsOptionsList>("predkernel");
-
-            predkernel->removeOpt("K");
-            predkernel->addOpt("K", new OptMatrix<gMat2D<T> >(*predK));
-        }
-
         T* guesses = lambdaguesses(L, last, r, last, tot, (T)(opt.getOptAsNumber("smallnumber")));
 
         //  ap = zeros(tot,T);
         T* ap = new T[tot*t];
 
-        T* Ytr = new T[last*t];
-        subMatrixFromRows(Y.getData(), y_rows, t, tr, last, Ytr);
-
         //    QtY = Q'*y(tr,:);
         T* Qty = new T[last*t];
-
-        dot(Q, Ytr, Qty, last, last, last, t, last, t, CblasTrans, CblasNoTrans, CblasColMajor);
-
-        delete [] Ytr;
-
-        //    for i = 1:tot
-        // 	opt.rls.X = X(tr,:);
-
-        gMat2D<T>* rlsX = new gMat2D<T>(last, d);
-        subMatrixFromRows(X.getData(), x_rows, d, tr, last, rlsX->getData());
-
-        delete [] tr;
-
-        optimizer->removeOpt("X");
-        optimizer->addOpt("X", new OptMatrix<gMat2D<T> >(*rlsX));
-
-
-        gMat2D<T>* xx = new gMat2D<T>(n-last, d);
-        subMatrixFromRows(X.getData(), x_rows, d, va, n-last, xx->getData());
+        gemm(CblasTrans, CblasNoTrans, (T)1.0, MatrixView<T>(Q, last, last, last), MatrixView<T>(Y, tr, last), (T)0.0, Qty, last);
 
         gMat2D<T>* yy = new gMat2D<T>(n-last, t);
         subMatrixFromRows(Y.getData(), y_rows, t, va, n-last, yy->getData());
 
-        delete [] va;
-
-        gMat2D<T>* C = new gMat2D<T>(last, t);
-        optimizer->removeOpt("C");
-        optimizer->addOpt("C", new OptMatrix<gMat2D<T> >(*C));
-
-
-        gMat2D<T>* W = NULL;
+        gMat2D<T>* pred = new gMat2D<T>(n-last, t);
+        nestedOpt->removeOpt("pred");
+        nestedOpt->addOpt("pred", new OptMatrix<gMat2D<T> >(*pred));
 
-        if(linearKernel)
-        {
-            W = new gMat2D<T>(d, t);
-
-            optimizer->removeOpt("W");
-            optimizer->addOpt("W", new OptMatrix<gMat2D<T> >(*W));
-        }
+        gMat2D<T> C(last, t);
+        gMat2D<T> W(d, t);
 
-        T* work = new T[last*(last+1)];
+        T* work = alloc_buffer<T>(last*(last+1));
 
         for(int i=0; i<tot; ++i)
         {
             // 	opt.rls.C = rls_eigen(Q,L,QtY,guesses(i),ntr);
-            rls_eigen(Q, L, Qty, C->getData(), guesses[i], last, last, last, last, last, t, work);
+            rls_eigen(Q, L, Qty, C.getData(), guesses[i], last, last, last, last, last, t, work);
 
             if(linearKernel)
             {
 //                opt.rls.W = X(tr,:)'*opt.rls.C; % dxT = (ntrxd)'*ntrxT   last*d last*last
-                dot(rlsX->getData(), C->getData(), W->getData(), last, d, last, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
-            }
-//            else
-//            opt.predkernel.K = opt.kernel.K(va,tr);%nva x ntr
-//            (see above)
-
+                gemm(CblasTrans, CblasNoTrans, (T)1.0, MatrixView<T>(X, tr, last), MatrixView<T>(C), (T)0.0, W.getData(), d);
 
-            OptMatrix<gMat2D<T> >* ret_pred = dual.execute(*xx, *yy, *nestedOpt);
-
-            nestedOpt->addOpt("pred", ret_pred);
+//                opt.pred = X(va,:)*opt.rls.W;
+                gemm(CblasNoTrans, CblasNoTrans, (T)1.0, MatrixView<T>(X, va, n-last), MatrixView<T>(W), (T)0.0, pred->getData(), n-last);
+            }
+            else
+            {
+//                opt.pred = opt.kernel.K(va,tr)*opt.rls.C;
+                gemm(CblasNoTrans, CblasNoTrans, (T)1.0, MatrixView<T>(K, va, n-last, tr, last), MatrixView<T>(C), (T)0.0, pred->getData(), n-last);
+            }
 
             // 	opt.perf = opt.hoperf(Xva,yva,opt);
-            GurlsOptionsList* ret_perf = perfClass->execute(*xx, *yy, *nestedOpt);
+            GurlsOptionsList* ret_perf = perfClass->execute(emptyX, *yy, *nestedOpt);
 
             gMat2D<T> &forho_vec = ret_perf->getOptValue<OptMatrix<gMat2D<T> > >("forho");
 
@@ -328,18 +281,18 @@ GurlsOptionsList *ParamSelHoDual<T>::execute(const gMat2D<T>& X, const gMat2D<T>
             //          ap(i,t) = opt.perf.forho(t);
             copy(ap+i, forho_vec.getData(), t, tot, 1);
 
-            nestedOpt->removeOpt("pred");
-
             delete ret_perf;
 
         }//for tot
 
-        delete [] Q;
+        delete [] tr;
+        delete [] va;
+
+        free_buffer(Q);
         delete [] Qty;
         delete [] L;
-        delete [] work;
+        free_buffer(work);
 
-        delete xx;
         delete yy;
 
         //[dummy,idx] = max(ap,[],1);
@@ -50,6 +50,7 @@
 #include "gurls++/gmat2d.h"
 #include "gurls++/gvec.h"
 #include "gurls++/gmath.h"
+#include "gurls++/matrixview.h"
 
 #include "gurls++/paramsel.h"
 #include "gurls++/perf.h"
@@ -88,14 +89,11 @@ public:
 };
 
 template <typename T>
-GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList &opt)
+GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& /*X*/, const gMat2D<T>& Y, const GurlsOptionsList &opt)
 {
     //    [n,T]  = size(y);
     const unsigned long y_rows = Y.rows();
     const unsigned long t = Y.cols();
-	
-    const unsigned long x_rows = X.rows();
-    const unsigned long d = X.cols();
 
 //    tot = opt.nlambda;
     int tot = static_cast<int>(opt.getOptAsNumber("nlambda"));
@@ -150,30 +148,27 @@ GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<
     nestedOpt->copyOpt("singlelambda", opt);
 
 
-    GurlsOptionsList* tmpPredKernel = new GurlsOptionsList("predkernel");
     GurlsOptionsList* tmpKernel = new GurlsOptionsList("kernel");
     GurlsOptionsList* tmpParamSel = new GurlsOptionsList("paramsel");
 
     nestedOpt->addOpt("kernel", tmpKernel);
-    nestedOpt->addOpt("predkernel", tmpPredKernel);
     nestedOpt->addOpt("paramsel", tmpParamSel);
 
-    gMat2D<T> subXtr;
+    // only the means are needed on the validation set: they are computed from a view
+    // of K(va,tr), and the nested optimizer does not need the training points
+    const gMat2D<T> emptyX;
+
     gMat2D<T> subYtr;
-    gMat2D<T> subXva;
     gMat2D<T> subYva;
 
     gMat2D<T>* subK = new gMat2D<T>();
-    gMat2D<T>* subPredK = new gMat2D<T>();
-    gMat2D<T>* subPredKTest = new gMat2D<T>();
+    gMat2D<T>* means = new gMat2D<T>();
 
     tmpKernel->addOpt("K", new OptMatrix<gMat2D<T> > (*subK));
-    tmpPredKernel->addOpt("K", new OptMatrix<gMat2D<T> > (*subPredK));
-    tmpPredKernel->addOpt("Ktest", new OptMatrix<gMat2D<T> > (*subPredKTest));
+    nestedOpt->addOpt("pred", new OptMatrix<gMat2D<T> > (*means));
 
 
     RLSGPRegr<T> rlsgp;
-    PredGPRegr<T> predgp;
     Performance<T>* perfClass = Performance<T>::factory(opt.getOptAsString("hoperf"));
 
     const int nholdouts = static_cast<int>(opt.getOptAsNumber("nholdouts"));
@@ -216,31 +211,13 @@ GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<
         copy_submatrix(subK->getData(), K.getData(), K.rows(), last, last, tr, tr);
 
 
-//        opt.predkernel.K = K(va,tr);
-        subPredK->resize(va_size, last);
-        copy_submatrix(subPredK->getData(), K.getData(), K.rows(), va_size, last, va, tr);
-
-//        opt.predkernel.Ktest = diag(K(va,va));
-        T* tmpMat = new T[va_size*va_size];
-        subPredKTest->resize(va_size, 1);
-
-        copy_submatrix(tmpMat, K.getData(), K.rows(), va_size, va_size, va, va);
-        copy(subPredKTest->getData(), tmpMat, va_size, 1, va_size+1);
-
-        delete[] tmpMat;
-
-        subXtr.resize(last, d);
-        subMatrixFromRows(X.getData(), x_rows, d, tr, last, subXtr.getData());
-
         subYtr.resize(last, t);
         subMatrixFromRows(Y.getData(), y_rows, t, tr, last, subYtr.getData());
 
-        subXva.resize(va_size, d);
-        subMatrixFromRows(X.getData(), x_rows, d, va, va_size, subXva.getData());
-
         subYva.resize(va_size, t);
         subMatrixFromRows(Y.getData(), y_rows, t, va, va_size, subYva.getData());
 
+        means->resize(va_size, t);
 
 //        for i = 1:tot
         for(int i=0; i< tot; ++i)
@@ -249,25 +226,19 @@ GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<
             lambda->getData()[0] = guesses[i];
 
 //            opt.rls = rls_gpregr(X(tr,:),y(tr,:),opt);
-            GurlsOptionsList* ret_rlsgp = rlsgp.execute(subXtr, subYtr, *nestedOpt);
+            GurlsOptionsList* ret_rlsgp = rlsgp.execute(emptyX, subYtr, *nestedOpt);
 
             nestedOpt->removeOpt("optimizer");
             nestedOpt->addOpt("optimizer", ret_rlsgp);
 
 //            tmp = pred_gpregr(X(va,:),y(va,:),opt);
-            GurlsOptionsList * pred_list = predgp.execute(subXva, subYva, *nestedOpt);
-
 //            opt.pred = tmp.means;
-            nestedOpt->removeOpt("pred");
-            nestedOpt->addOpt("pred", pred_list->getOpt("means"));
-
-            pred_list->removeOpt("means", false);
-
-            delete pred_list;
+            const gMat2D<T>& alpha = ret_rlsgp->getOptValue<OptMatrix<gMat2D<T> > >("alpha");
+            gemm(CblasNoTrans, CblasNoTrans, (T)1.0, MatrixView<T>(K, va, va_size, tr, last), MatrixView<T>(alpha), (T)0.0, means->getData(), va_size);
 
 
 //            opt.perf = opt.hoperf([],y(va,:),opt);
-            GurlsOptionsList * perf_list = perfClass->execute(subXva, subYva, *nestedOpt);
+            GurlsOptionsList * perf_list = perfClass->execute(emptyX, subYva, *nestedOpt);
             gMat2D<T>& forho = perf_list->getOptValue<OptMatrix<gMat2D<T> > >("forho");
 
 //            for t = 1:T
@@ -287,6 +258,7 @@ GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<
         copyLocations(idx, guesses, t, tot, lambdas_nh);
         copy(lambdas_round + nh, lambdas_nh, t, nholdouts, 1);
         delete [] lambdas_nh;
+        delete [] idx;
 
 //        vout.perf{nh} = perf;
         copy(perf_mat->getData()+nh, perf, tot*t, nholdouts, 1);
@@ -298,6 +270,7 @@ GurlsOptionsList *ParamSelHoGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<
 
     delete nestedOpt;
 
+    delete[] tr;
     delete[] guesses;
     delete perfClass;
     delete[] perf;
@@ -55,6 +55,7 @@
 #include "gurls++/gmat2d.h"
 #include "gurls++/gvec.h"
 #include "gurls++/gmath.h"
+#include "gurls++/matrixview.h"
 
 #include "gurls++/paramsel.h"
 #include "gurls++/perf.h"
@@ -179,14 +180,12 @@ GurlsOptionsList *ParamSelHoPrimal<T>::execute(const gMat2D<T>& X, const gMat2D<
     gMat2D<T>* lambdas_round_mat = new gMat2D<T>(nholdouts, t);
     T* lambdas_round = lambdas_round_mat->getData();
 
-    PredPrimal< T > primal;
     Performance<T>* perfClass = Performance<T>::factory(opt.getOptAsString("hoperf"));
 
-    GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
-    nestedOpt->addOpt("optimizer",optimizer);
+    // the performance tasks only read Y and opt.pred
+    const gMat2D<T> emptyX;
 
-    gMat2D<T> *W = new gMat2D<T>(d, t);
-    optimizer->addOpt("W", new OptMatrix<gMat2D<T> >(*W));
+    gMat2D<T> W(d, t);
 
 
     bool hasXt = opt.hasOpt("kernel.XtX") && opt.hasOpt("kernel.Xty");
@@ -204,33 +203,25 @@ GurlsOptionsList *ParamSelHoPrimal<T>::execute(const gMat2D<T>& X, const gMat2D<
         copy< unsigned long >(va,(indices_buffer+ n*nh+last), n-last,1,1);
 
 
-        gMat2D<T> Xva(n-last, d);
-        gMat2D<T> yva(n-last, t);
+        // X(va,:) and X(tr,:) are only accessed through views
+        const MatrixView<T> Xva(X, va, n-last);
 
-        subMatrixFromRows(X.getData(), X.rows(), d, va, n-last, Xva.getData());
+        gMat2D<T> yva(n-last, t);
         subMatrixFromRows(Y.getData(), Y.rows(), t, va, n-last, yva.getData());
 
-        T* Xtr = NULL;
         if(hasXt)
         {
-            T* XvatXva = new T[d*d];
-            dot(Xva.getData(), Xva.getData(), XvatXva, n-last, d, n-last, d, d, d, CblasTrans, CblasNoTrans, CblasColMajor);
-
             const gMat2D<T>&XtX = opt.getOptValue<OptMatrix<gMat2D<T> > >("kernel.XtX");
 
-            // Q = XtX - XvatXva
+            // Q = XtX - Xva'*Xva
             copy(Q, XtX.getData(), XtX.getSize());
-            axpy(d*d, (T)-1.0, XvatXva, 1, Q, 1);
-
-            delete [] XvatXva;
+            gemm(CblasTrans, CblasNoTrans, (T)-1.0, Xva, Xva, (T)1.0, Q, d);
         }
         else
         {
             //       K = X(tr,:)'*X(tr,:);
-            Xtr = new T[last*d];
-            subMatrixFromRows(X.getData(), n, d, tr, last, Xtr);
-
-            dot(Xtr, Xtr, Q, last, d, last, d, d, d, CblasTrans, CblasNoTrans, CblasColMajor);
+            const MatrixView<T> Xtr(X, tr, last);
+            gemm(CblasTrans, CblasNoTrans, (T)1.0, Xtr, Xtr, (T)0.0, Q, d);
         }
 
         unsigned long k = eig_function(Q, L, d, d, opt, last);
@@ -239,56 +230,41 @@ GurlsOptionsList *ParamSelHoPrimal<T>::execute(const gMat2D<T>& X, const gMat2D<
 
         T* ap = new T[tot*t];
 
+        T* Xtrtytr = new T[d*t];
 
         if(hasXt)
         {
-            T* Xvatyva = new T[d*t];
-            dot(Xva.getData(), yva.getData(), Xvatyva, n-last, d, n-last, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
-
             const gMat2D<T>&Xty = opt.getOptValue<OptMatrix<gMat2D<T> > >("kernel.Xty");
 
-
-            // QtXty = Q'*(Xty - XvatXva)
-
-            T* Xtrtytr = new T[d*t];
-
+            // Xtrtytr = Xty - Xva'*yva
             copy(Xtrtytr, Xty.getData(), Xty.getSize());
-            axpy(d*t, (T)-1.0, Xvatyva, 1, Xtrtytr, 1);
-
-            dot(Q, Xtrtytr, QtXty, d, d, d, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
-
-            delete [] Xvatyva;
-            delete [] Xtrtytr;
+            gemm(CblasTrans, CblasNoTrans, (T)-1.0, Xva, MatrixView<T>(yva), (T)1.0, Xtrtytr, d);
         }
         else
         {
-            T* ytr = new T[last*t];
-            subMatrixFromRows(Y.getData(), n, t, tr, last, ytr);
-
-
-            T* Xtrtytr = new T[d*t];
-            dot(Xtr, ytr, Xtrtytr, last, d, last, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
-            delete [] Xtr;
+            // Xtrtytr = X(tr,:)'*y(tr,:)
+            gemm(CblasTrans, CblasNoTrans, (T)1.0, MatrixView<T>(X, tr, last), MatrixView<T>(Y, tr, last), (T)0.0, Xtrtytr, d);
+        }
 
-            dot(Q, Xtrtytr, QtXty, d, d, d, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
+        // QtXty = Q'*Xtrtytr
+        dot(Q, Xtrtytr, QtXty, d, d, d, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
 
-            delete [] ytr;
-            delete [] Xtrtytr;
-        }
+        delete [] Xtrtytr;
 
+        gMat2D<T>* pred = new gMat2D<T>(n-last, t);
+        nestedOpt->removeOpt("pred");
+        nestedOpt->addOpt("pred", new OptMatrix<gMat2D<T> >(*pred));
 
-        T* work = new T[d*(d+1)];
+        T* work = alloc_buffer<T>(d*(d+1));
 
         for(int i=0; i<tot; ++i)
         {
-            rls_eigen(Q, L, QtXty, W->getData(), guesses[i], last, d, d, d, d, t, work);
-
-            OptMatrix<gMat2D<T> > *ret_pred = primal.execute(Xva, yva, *nestedOpt);
+            rls_eigen(Q, L, QtXty, W.getData(), guesses[i], last, d, d, d, d, t, work);
 
-            nestedOpt->removeOpt("pred");
-            nestedOpt->addOpt("pred", ret_pred);
+            // opt.pred = X(va,:)*W
+            gemm(CblasNoTrans, CblasNoTrans, (T)1.0, Xva, MatrixView<T>(W), (T)0.0, pred->getData(), n-last);
 
-            GurlsOptionsList* ret_perf = perfClass->execute(Xva, yva, *nestedOpt);
+            GurlsOptionsList* ret_perf = perfClass->execute(emptyX, yva, *nestedOpt);
 
             gMat2D<T> &forho_vec = ret_perf->getOptValue<OptMatrix<gMat2D<T> > >("forho");
 
@@ -299,7 +275,7 @@ GurlsOptionsList *ParamSelHoPrimal<T>::execute(const gMat2D<T>& X, const gMat2D<
 
         delete [] va;
         delete [] tr;
-        delete [] work;
+        free_buffer(work);
 
         //[dummy,idx] = max(ap,[],1);
         work = NULL;
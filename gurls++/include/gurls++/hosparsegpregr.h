@@ -0,0 +1,348 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * authors:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+
+#ifndef _GURLS_HOSPARSEGPREGR_H_
+#define _GURLS_HOSPARSEGPREGR_H_
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <algorithm>
+
+#include "gurls++/options.h"
+#include "gurls++/optlist.h"
+#include "gurls++/gmat2d.h"
+#include "gurls++/gmath.h"
+#include "gurls++/utils.h"
+
+#include "gurls++/paramsel.h"
+#include "gurls++/perf.h"
+
+#include "gurls++/rlssparsegp.h"
+
+namespace gurls {
+
+/**
+ * \ingroup ParameterSelection
+ * \brief ParamSelHoSparseGPRegr is the sub-class of ParamSelection that implements hold-out
+ * parameter selection for sparse GP regression
+ */
+
+template <typename T>
+class ParamSelHoSparseGPRegr: public ParamSelection<T>{
+
+public:
+    /**
+     * Performs parameter selection for sparse Gaussian Process regression with the hold-out approach.
+     * Every guess is trained with RLSSparseGPRegr on the training part of the split and evaluated
+     * on the validation part with the inducing points only, so that the selection costs O(n*m^2)
+     * per guess and never forms the n-by-n kernel matrix.
+     * For the rbf kernel, when nsigma is greater than 1 the kernel parameter is selected as well,
+     * among nsigma guesses between sigmamin and sigmamax; unless given in opt, these are computed
+     * as in \ref ParamSelSiglamHoGPRegr, from the distances among m samples evenly spaced in X.
+     * Otherwise the kernel parameter is read from opt.paramsel.sigma.
+     *
+     * \param X input data matrix
+     * \param Y labels matrix
+     * \param opt options with the following:
+     *  - nlambda (default)
+     *  - nsigma (default)
+     *  - nholdouts (default)
+     *  - hoperf (default)
+     *  - singlelambda (default)
+     *  - sparsegp (default)
+     *  - lambdamin, lambdamax, sigmamin, sigmamax (optional)
+     *  - split (settable with the class Split and its subclasses)
+     *  - kernel (list with the field type, either 'rbf' or 'linear')
+     *  - paramsel.sigma (for the rbf kernel when nsigma is 1)
+     *
+     * \return paramsel, a GurlsOptionList with the following fields:
+     *  - lambdas = array of the noise level minimizing the validation error, replicated for each output
+     *  - sigma = selected kernel parameter (rbf kernel only)
+     *  - guesses = array of guesses for the noise level
+     *  - perf = matrix of validation accuracies of each holdout, for each sigma and lambda guess and for each output
+     */
+    GurlsOptionsList* execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList& opt);
+};
+
+template <typename T>
+GurlsOptionsList *ParamSelHoSparseGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList &opt)
+{
+    //    [n,T]  = size(y);
+    const unsigned long y_rows = Y.rows();
+    const unsigned long t = Y.cols();
+    const unsigned long d = X.cols();
+
+    if(X.rows() != y_rows)
+        throw gException(Exception_Inconsistent_Size);
+
+    const std::string kernelType = opt.getOptAsString("kernel.type");
+    const bool linear = (kernelType == "linear");
+    if(!linear && kernelType != "rbf")
+        throw gException(Exception_Required_Parameter_Missing);
+
+    const int nlambda = static_cast<int>(opt.getOptAsNumber("nlambda"));
+    const int nsigma = linear? 1: static_cast<int>(opt.getOptAsNumber("nsigma"));
+    if(nlambda < 1 || nsigma < 1)
+        throw gException(Exception_Illegal_Argument_Value);
+
+    const GurlsOptionsList* split = opt.getOptAs<GurlsOptionsList>("split");
+
+    const gMat2D< unsigned long > &indices_mat = split->getOptValue<OptMatrix<gMat2D< unsigned long > > >("indices");
+    const gMat2D< unsigned long > &lasts_mat = split->getOptValue<OptMatrix<gMat2D< unsigned long > > >("lasts");
+
+    const unsigned long n = indices_mat.rows();
+
+    const unsigned long *lasts = lasts_mat.getData();
+    const unsigned long *indices = indices_mat.getData();
+
+    const int nholdouts = static_cast<int>(opt.getOptAsNumber("nholdouts"));
+
+
+//    guesses = lmin.*(lmax/lmin).^linspace(0,1,tot);
+    const T lmin = opt.hasOpt("lambdamin")? static_cast<T>(opt.getOptAsNumber("lambdamin")): (T)0.001;
+    const T lmax = opt.hasOpt("lambdamax")? static_cast<T>(opt.getOptAsNumber("lambdamax")): (T)10;
+
+    gMat2D<T>* guesses_mat = new gMat2D<T>(1, nlambda);
+    T* guesses = guesses_mat->getData();
+    linspace((T)0.0, (T)1.0, nlambda, guesses);
+    for(int i=0; i<nlambda; ++i)
+        guesses[i] = lmin*std::pow(lmax/lmin, guesses[i]);
+
+
+    // sigma guesses: sigmas(i) = opt.sigmamin*(q^(i-1))
+    std::vector<T> sigmas(nsigma, (T)1.0);
+    if(!linear && nsigma == 1)
+        sigmas[0] = static_cast<T>(opt.getOptAsNumber("paramsel.sigma"));
+    else if(!linear)
+    {
+        T sigmamin = 0, sigmamax = 0;
+        if(!opt.hasOpt("sigmamin") || !opt.hasOpt("sigmamax"))
+        {
+            // squared distances among s samples evenly spaced in X, in place of all the n^2 ones
+            const unsigned long m = static_cast<unsigned long>(opt.getOptAsNumber("sparsegp.m"));
+            const unsigned long s = std::min(y_rows, std::max(m, 2ul));
+            if(s < 2)
+                throw gException(Exception_Inconsistent_Size);
+
+            std::vector<unsigned long> sub(s);
+            for(unsigned long i=0; i<s; ++i)
+                sub[i] = (i*y_rows)/s;
+
+            std::vector<T> Xs(s*d);
+            subMatrixFromRows(X.getData(), y_rows, d, &sub[0], s, &Xs[0]);
+
+            std::vector<T> distance(s*s);
+            distance_transposed(&Xs[0], &Xs[0], d, s, s, &distance[0]);
+
+//            D = sort(distance(tril(true(s),-1)));
+            std::vector<T> D;
+            D.reserve(s*(s-1)/2);
+            for(unsigned long j=0; j<s; ++j)
+                D.insert(D.end(), distance.begin() + j*s + j+1, distance.begin() + (j+1)*s);
+            std::sort(D.begin(), D.end());
+
+//            firstPercentile = round(0.01*numel(D)+0.5);
+            const int firstPercentile = gurls::round((T)0.01 * D.size() + (T)0.5)-1;
+
+            sigmamin = std::sqrt(D[firstPercentile]);
+            sigmamax = std::sqrt(D.back());
+        }
+
+        if(opt.hasOpt("sigmamin"))
+            sigmamin = static_cast<T>(opt.getOptAsNumber("sigmamin"));
+        if(opt.hasOpt("sigmamax"))
+            sigmamax = static_cast<T>(opt.getOptAsNumber("sigmamax"));
+
+        sigmamin = (sigmamin > 0)? sigmamin: std::numeric_limits<T>::epsilon();
+        sigmamax = (sigmamax > 0)? sigmamax: std::numeric_limits<T>::epsilon();
+
+//        q = (opt.sigmamax/opt.sigmamin)^(1/(opt.nsigma-1));
+        const T q = std::pow(sigmamax/sigmamin, (T)1.0/(nsigma-1));
+        for(int i=0; i<nsigma; ++i)
+            sigmas[i] = sigmamin*std::pow(q, static_cast<T>(i));
+    }
+
+
+    GurlsOptionsList* nestedOpt = new GurlsOptionsList("nested");
+    nestedOpt->copyOpt("singlelambda", opt);
+    nestedOpt->copyOpt("sparsegp", opt);
+
+    GurlsOptionsList* tmpKernel = new GurlsOptionsList("kernel");
+    tmpKernel->addOpt("type", kernelType);
+    nestedOpt->addOpt("kernel", tmpKernel);
+
+    GurlsOptionsList* tmpParamSel = new GurlsOptionsList("paramsel");
+    nestedOpt->addOpt("paramsel", tmpParamSel);
+
+    gMat2D<T>* lambda = new gMat2D<T>(1,1);
+    tmpParamSel->addOpt("lambdas", new OptMatrix<gMat2D<T> >(*lambda));
+    tmpParamSel->addOpt("sigma", new OptNumber(sigmas[0]));
+
+    gMat2D<T>* means = new gMat2D<T>();
+    nestedOpt->addOpt("pred", new OptMatrix<gMat2D<T> >(*means));
+
+    const gMat2D<T> emptyX;
+    gMat2D<T> subXtr, subYtr, subXva, subYva;
+
+    RLSSparseGPRegr<T> rlsgp;
+    Performance<T>* perfClass = Performance<T>::factory(opt.getOptAsString("hoperf"));
+
+    // perf(i+nsigma*j, k) is the validation accuracy of sigmas(i), guesses(j) on output k
+    const unsigned long tot = static_cast<unsigned long>(nsigma*nlambda);
+    T* perf = new T[tot*t];
+
+    gMat2D<T>* perf_mat = new gMat2D<T>(nholdouts, tot*t);
+
+    unsigned long *tr = new unsigned long[n];
+
+//    for nh = 1:opt.nholdouts
+    for(int nh = 0; nh < nholdouts; ++nh)
+    {
+        const unsigned long last = lasts[nh];
+        copy(tr, indices+n*nh, n, 1, 1);
+        const unsigned long *va = tr+last;
+        const unsigned long va_size = n-last;
+
+        subXtr.resize(last, d);
+        subMatrixFromRows(X.getData(), y_rows, d, tr, last, subXtr.getData());
+        subYtr.resize(last, t);
+        subMatrixFromRows(Y.getData(), y_rows, t, tr, last, subYtr.getData());
+
+        subXva.resize(va_size, d);
+        subMatrixFromRows(X.getData(), y_rows, d, va, va_size, subXva.getData());
+        subYva.resize(va_size, t);
+        subMatrixFromRows(Y.getData(), y_rows, t, va, va_size, subYva.getData());
+
+        means->resize(va_size, t);
+
+        for(int i=0; i<nsigma; ++i)
+        {
+            tmpParamSel->getOptValue<OptNumber>("sigma") = sigmas[i];
+
+            for(int j=0; j<nlambda; ++j)
+            {
+                lambda->getData()[0] = guesses[j];
+
+//                opt.rls = rls_sparsegpregr(X(tr,:),y(tr,:),opt);
+                GurlsOptionsList* ret_rlsgp = rlsgp.execute(subXtr, subYtr, *nestedOpt);
+
+                nestedOpt->removeOpt("optimizer");
+                nestedOpt->addOpt("optimizer", ret_rlsgp);
+
+//                opt.pred = K(X(va,:),Z)*opt.rls.alpha;
+                const gMat2D<T>& Z = ret_rlsgp->getOptValue<OptMatrix<gMat2D<T> > >("X");
+                const gMat2D<T>& alpha = ret_rlsgp->getOptValue<OptMatrix<gMat2D<T> > >("alpha");
+                predict_kernel_blocked(kernelType, subXva.getData(), va_size, d, Z.getData(), Z.rows(),
+                                       alpha.getData(), t, sigmas[i], means->getData(), predict_kernel_blocksize(Z.rows()));
+
+//                opt.perf = opt.hoperf([],y(va,:),opt);
+                GurlsOptionsList * perf_list = perfClass->execute(emptyX, subYva, *nestedOpt);
+                gMat2D<T>& forho = perf_list->getOptValue<OptMatrix<gMat2D<T> > >("forho");
+
+                copy(perf + i + nsigma*j, forho.getData(), t, tot, 1);
+
+                delete perf_list;
+            }
+        }
+
+//        vout.perf{nh} = perf;
+        copy(perf_mat->getData()+nh, perf, tot*t, nholdouts, 1);
+    }
+
+    delete nestedOpt;
+    delete perfClass;
+    delete[] tr;
+
+
+//    M = sum(median(PERF over the holdouts),3); % sum over outputs
+    T* work = new T[std::max(static_cast<unsigned long>(nholdouts), tot*t)];
+    median(perf_mat->getData(), nholdouts, tot*t, 1, perf, work);
+    delete[] work;
+
+    for(unsigned long k=1; k<t; ++k)
+        axpy(tot, (T)1.0, perf + k*tot, 1, perf, 1);
+
+//    [dummy,i] = max(M(:));
+    const unsigned long best = std::max_element(perf, perf+tot) - perf;
+    delete[] perf;
+
+
+    GurlsOptionsList* paramsel;
+
+    if(opt.hasOpt("paramsel"))
+    {
+        GurlsOptionsList* tmp_opt = new GurlsOptionsList("tmp");
+        tmp_opt->copyOpt("paramsel", opt);
+
+        paramsel = GurlsOptionsList::dynacast(tmp_opt->getOpt("paramsel"));
+        tmp_opt->removeOpt("paramsel", false);
+        delete tmp_opt;
+
+        paramsel->removeOpt("guesses");
+        paramsel->removeOpt("perf");
+        paramsel->removeOpt("lambdas");
+    }
+    else
+        paramsel = new GurlsOptionsList("paramsel");
+
+    if(!linear)
+    {
+        paramsel->removeOpt("sigma");
+        paramsel->addOpt("sigma", new OptNumber(sigmas[best%static_cast<unsigned long>(nsigma)]));
+    }
+
+//    vout.noises = guesses(n)*ones(1,T);
+    gMat2D<T> *lambdas = new gMat2D<T>(1, t);
+    set(lambdas->getData(), guesses[best/static_cast<unsigned long>(nsigma)], t);
+
+    paramsel->addOpt("lambdas", new OptMatrix<gMat2D<T> >(*lambdas));
+    paramsel->addOpt("perf", new OptMatrix<gMat2D<T> >(*perf_mat));
+    paramsel->addOpt("guesses", new OptMatrix<gMat2D<T> >(*guesses_mat));
+
+    return paramsel;
+}
+
+}
+
+#endif // _GURLS_HOSPARSEGPREGR_H_
@@ -67,7 +67,12 @@ public:
     void train(const gMat2D<T> &X, const gMat2D<T> &y);
 
     /**
-      * Estimator update
+      * Estimator update. The sample is appended to the factor computed by
+      * train(), evaluating the kernel only against the pivots, with
+      * O(r*d + r^2*t) operations for a factor of rank r. Past samples are not
+      * stored. If pivot promotion is enabled and the rank is smaller than
+      * rank_max, the sample becomes a new pivot when its residual diagonal
+      * exceeds the smallest one among the current pivots
       *
       * \param X Input data vector
       * \param Y Labels vector
@@ -75,30 +80,57 @@ public:
     void update(const gVec<T> &X, const gVec<T> &y);
 
     /**
-      * Estimates label for an input matrix
+      * Estimates label for an input matrix. Only the kernel between X and
+      * the pivots selected during training is evaluated, in blocks of rows as in eval_ls()
       *
       * \param[in] X Input matrix
       * \returns Matrix of predicted labels
       */
     gMat2D<T>* eval(const gMat2D<T> &X);
 
+    /**
+      * Estimates label for an input matrix, processing it in blocks of rows
+      * so that the whole test kernel matrix is never stored
+      *
+      * \param[in] X Input matrix
+      * \returns Matrix of predicted labels
+      */
     gMat2D<T>* eval_ls(const gMat2D<T> &X);
 
     using GurlsWrapper<T>::eval;
 
+    /**
+      * Enables the promotion of updating samples to pivots
+      */
+    void setPromotePivots(bool value);
+
+    /**
+      * Sets the number of pivots selected at each step of the factorization
+      * computed by train(). With values larger than 1 the kernel columns are
+      * computed in blocks with level-3 BLAS, and the pivots of a block are
+      * chosen among the largest residual diagonals at the start of the block
+      */
+    void setPivotBlockSize(unsigned long value);
+
     void setRankMax(unsigned long rank);
     void setNRank(unsigned long n_rank);
     void setSigma(double sigma);
     void setXva(const gMat2D<T>& Xva);
     void setyva(const gMat2D<T>& yva);
 
+    /**
+      * Sets the number of rows of X processed at a time by eval() and eval_ls()
+      */
+    void setEvalBlockSize(unsigned long value);
+
 
 
 protected:
-    T* computeNewKcol( const T* Xtr, const unsigned long xr, const unsigned long xc,
-                         const double sigma,
-                         const unsigned long* pVec,
-                         const unsigned long start, const unsigned long n);
+    /**
+      * Computes exp(-1/sigma^2*square_distance(X',Xp'))*C, where Xp are the
+      * pivots and C the compressed coefficients, processing blocksize rows of X at a time
+      */
+    gMat2D<T>* eval_pivots(const gMat2D<T> &X, unsigned long blocksize);
 
 };
 
@@ -1,4 +1,5 @@
 #include "gurls++/icholwrapper.h"
+#include "gurls++/cholupdateutils.h"
 
 #include "gurls++/optmatrix.h"
 #include "gurls++/predkerneltraintest.h"
@@ -25,6 +26,9 @@ ICholWrapper<T>::ICholWrapper(const std::string& name):GurlsWrapper<T>(name)
 
     GurlsOptionsList *split = new GurlsOptionsList("split");
     this->opt->addOpt("split", split);
+
+    this->opt->addOpt("promotepivots", new OptNumber(0));
+    this->opt->addOpt("pivotblocksize", new OptNumber(1));
 }
 
 template <typename T>
@@ -46,47 +50,24 @@ void ICholWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     bool computePred = (opt->hasOpt("split.Xva") && opt->hasOpt("split.yva"));
 
 
-    GurlsOptionsList* tmp_optimizer = new GurlsOptionsList("optimizer");
-    OptMatrix<const gMat2D<T> > *X_opt = new OptMatrix<const gMat2D<T> >(X, false);
-    tmp_optimizer->addOpt("X", X_opt);
-
     const gMat2D<T>* Xva = NULL;
     const gMat2D<T>* yva = NULL;
-    gMat2D<T>* predKernel_K = NULL;
+    unsigned long nva = 0;
+    T* Kva = NULL;  // kernel between the validation set and the pivots
     const gMat2D<T> empty;
 
     if(computePred)
     {
         Xva = &(opt->getOptValue<OptMatrix<gMat2D<T> > >("split.Xva"));
         yva = &(opt->getOptValue<OptMatrix<gMat2D<T> > >("split.yva"));
+        nva = Xva->rows();
 
+        if(Xva->cols() != d || yva->cols() != t || yva->rows() != nva)
+            throw gException(Exception_Inconsistent_Size);
 
-        GurlsOptionsList* opt_tmp = new GurlsOptionsList("tmp");
-        GurlsOptionsList* tmp_kernel = new GurlsOptionsList("kernel");
-        GurlsOptionsList* tmp_paramsel = new GurlsOptionsList("paramsel");
-
-        opt_tmp->addOpt("kernel", tmp_kernel);
-        opt_tmp->addOpt("paramsel", tmp_paramsel);
-        opt_tmp->addOpt("optimizer", tmp_optimizer);
-
-        tmp_kernel->addOpt("type", "rbf");
-        tmp_paramsel->addOpt("sigma", new OptNumber(sigma));
-
-
-        PredKernelTrainTest<T> predKernelTask;
-        GurlsOptionsList* predKernel = predKernelTask.execute(*Xva, empty, *opt_tmp);
-
-        OptMatrix<gMat2D<T> > *k_opt = predKernel->getOptAs<OptMatrix<gMat2D<T> > >("K");
-        k_opt->detachValue();
-        predKernel_K = &(k_opt->getValue());
-
-        delete predKernel;
-        opt_tmp->removeOpt("optimizer", false);
-        delete opt_tmp;
+        Kva = new T[nva*m];
     }
 
-    opt->addOpt("optimizer", tmp_optimizer);
-
 
     std::set<unsigned long> ireg;
 //    for(unsigned long i=0; i<n_rank; ++i)
@@ -98,7 +79,8 @@ void ICholWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 
 
     GurlsOptionsList* perf_opt = new GurlsOptionsList("perf_opt");
-    gMat2D<T>* alpha = new gMat2D<T>();
+    gMat2D<T>* Xp = new gMat2D<T>();
+    gMat2D<T>* C = new gMat2D<T>();
     T maxPerf = -std::numeric_limits<T>::max();
     unsigned long maxRank = 0;
     gMat2D<T> *perfs_mat = new gMat2D<T>(1, ireg.size());
@@ -134,274 +116,352 @@ void ICholWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     T prevPerf = 0;
 
     // ---- Cholesky decomposition ----
-    T* diagG;
-    T* newKcol;
-    unsigned long* pVec;
+    // Pivots are selected kb at a time as the largest residual diagonals. The kernel
+    // columns of a block and their correction for the previous pivots are computed
+    // with two gemm, the columns of the block are then completed one at a time.
+    // With kb == 1 this is the standard greedy pivoting.
+
+    const unsigned long kb = std::max(1ul, std::min(m,
+                        static_cast<unsigned long>(opt->getOptAsNumber("pivotblocksize"))));
+
+    T* diagG = new T[n];  // residual diagonal
+    set(diagG, (T)1.0, n);
+
+    unsigned long* pVec = new unsigned long[n];
+    for(unsigned long *it = pVec, *const end = pVec+n, i=0; it != end; ++it, ++i)
+        *it = i;
+
+    // rows of X in pivoting order, and their squared norms
+    T* Xperm = new T[n*d];
+    copy(Xperm, X.getData(), n*d);
+
+    T* Xnorms = new T[n];
+    sum_col_squared(Xperm, Xnorms, n, d);
+
+    T* F = new T[n*kb];     // residual kernel columns of the block candidates
+    T* Xc = new T[kb*d];    // candidate samples
+    T* Gc = new T[kb*m];    // rows of G of the candidates
+    T* Fc = new T[kb];      // squared norms of the candidate samples
+    unsigned long* cpos = new unsigned long[kb];    // current row of each candidate
+    bool* cdone = new bool[kb];
+
+    T* Rcol = new T[m];
+    T* RR_Rcol = new T[m];
     T normG;
 
+    const T gamma = (T)(-1.0/(sigma*sigma));
+    bool stop = false;
+
     begin = boost::posix_time::microsec_clock::local_time();
-    for(unsigned long i=0; i<m; ++i)
+    for(unsigned long i0=0; i0<m && !stop; )
     {
+        const unsigned long k = std::min(kb, m-i0);
+        const unsigned long rows0 = n-i0;
 
-        if(i==0)
+        // candidates: the k largest elements of diagG(i0:n), chosen ones are
+        // temporarily excluded by mapping them to negative values
+        for(unsigned long j=0; j<k; ++j)
         {
-            //First iteration
-            diagG = new T[n];
-            set(diagG, (T)1.0, n);
+            const unsigned long best = std::max_element(diagG+i0, diagG+n)-diagG;
 
-            pVec = new unsigned long[n];
-            for(unsigned long *it = pVec, *const end = pVec+n, i=0; it != end; ++it, ++i)
-                *it = i;
+            cpos[j] = best;
+            cdone[j] = false;
+            diagG[best] = -diagG[best]-1;
 
-            G[0] = 1.0;
+            copy(Xc+j, Xperm+best, d, k, n);
+            copy(Gc+j, G+best, i0, k, n);
+            Fc[j] = Xnorms[best];
+        }
+        for(unsigned long j=0; j<k; ++j)
+            diagG[cpos[j]] = -diagG[cpos[j]]-1;
 
+    //    F = exp(-1/sigma^2*square_distance(X(Pvec(i0:n),:)',Xc')) - G(i0:n,1:i0-1)*Gc';
+        T* F_i0 = F+i0;
+        gemm(CblasNoTrans, CblasTrans, rows0, k, d, (T)-2.0, Xperm+i0, n, Xc, k, (T)0.0, F_i0, n);
+        for(unsigned long j=0; j<k; ++j)
+        {
+            T* F_it = F_i0+(n*j);
+            const T* xn_it = Xnorms+i0;
+            for(unsigned long l=0; l<rows0; ++l)
+                F_it[l] = std::exp(gamma*std::max(F_it[l]+xn_it[l]+Fc[j], (T)0.0));
+        }
 
-        //     newKcol = exp(-1/sigma^2*square_distance(X(Pvec(2:n),:)',X(1,:)'));
-            newKcol = computeNewKcol(X.getData(), n, d, sigma, pVec, 1, n);
+        if(i0 > 0)
+            gemm(CblasNoTrans, CblasTrans, rows0, k, i0, (T)-1.0, G+i0, n, Gc, k, (T)1.0, F_i0, n);
 
-        //    G(2:n,1) = newKcol;
-            copy(G + 1, newKcol, n-1);
+        unsigned long j = 0;
+        for(; j<k && !stop; ++j)
+        {
+            const unsigned long i = i0+j;
+            const unsigned long cols = i;
 
-        //    diagG(2:n)=ones(n-1,1)-sum(G(2:n,1).^2,2);
-            mult(newKcol, newKcol, newKcol, n-1);
-            axpy(n-1, (T)-1.0, newKcol, 1, diagG+1, 1); // assumes diagG has been previously initialized to 1
+            // find best new element among the candidates
+            unsigned long c = k;
+            for(unsigned long l=0; l<k; ++l)
+                if(!cdone[l] && (c == k || diagG[cpos[l]] > diagG[cpos[c]]))
+                    c = l;
 
-        //    normG = norm(G(:,1));
-            normG = sqrt(sumv(newKcol, n-1) + (G[0]*G[0]));
-            delete [] newKcol;
+            const unsigned long jast = cpos[c];
 
-        //    Q(:,1) = G(:,1) / normG;
-            copy(Q, G, n);
-            scal(n, (T)1.0/normG, Q, 1);
+            // the block ends early when the candidates have been explained by the
+            // previous columns of the block much better than the best sample outside
+            if(j > 0 && diagG[jast] < 1e-2*(*std::max_element(diagG+i, diagG+n)))
+                break;
 
-        //    RR(1,1) = 1/(normG^2);
-            RR[0] = 1.0/ (normG*normG);
-        }
-        else // all other iterations
-        {
-            // find best new element
-            unsigned long jast = std::max_element(diagG+i, diagG+n)-diagG;
+            cdone[c] = true;
 
             // updates permutation
     //        Pvec( [i jast] ) = Pvec( [jast i] );
-            std::swap(*(pVec+i), *(pVec+jast));
+            std::swap(pVec[i], pVec[jast]);
+            std::swap(diagG[i], diagG[jast]);
+            std::swap(Xnorms[i], Xnorms[jast]);
+            gurls::swap(d, Xperm+i, n, Xperm+jast, n);
 
             // swap y
             gurls::swap(t, yPvec+i, n, yPvec+jast, n);
 
-            // updates all elements of G due to new permutation
+            // updates all elements of G, Q and F due to new permutation
     //        G([i jast],1:i)=G([ jast i],1:i);
-            gurls::swap(i+1, G+i, n, G+jast, n);
-
-
-            // updates all elements of Q due to new permutation
     //        Q([i jast],1:i-1) = Q([ jast i],1:i-1);
+            gurls::swap(i, G+i, n, G+jast, n);
             gurls::swap(i, Q+i, n, Q+jast, n);
+            gurls::swap(k, F+i, n, F+jast, n);
 
+            for(unsigned long l=0; l<k; ++l)
+                if(cpos[l] == i)
+                    cpos[l] = jast;
+            cpos[c] = i;
 
             // do the cholesky update
-    //        G(i,i)=diagG(jast);
-    //        G(i,i)=sqrt(G(i,i));
-            const T G_ii = sqrt(diagG[jast]);
-            G[(n*i)+i] = G_ii;
-
-
-    //        newKcol = exp(-1/sigma^2*square_distance(X(Pvec((i+1):n),:)',X(Pvec(i),:)'));
-            newKcol = computeNewKcol(X.getData(), n, d, sigma, pVec, i+1, n);
-
-    //        G((i+1):n,i)=1/G(i,i)*( newKcol - G((i+1):n,1:(i-1))*(G(i,1:(i-1)))');
-            const int rows = (n-(i+1));
-            const unsigned long cols = i;
-
-            T* G_ip1_n = new T[rows*(cols+1)]; // extracting +1 cols for future use
-
-            for(T *G_it = G+(i+1), *Gi_it = G_ip1_n, *const Gi_end = Gi_it+rows*cols; Gi_it != Gi_end; G_it+=n, Gi_it+=rows)
-                copy(Gi_it, G_it, rows);
-
-            T* G_i= new T[cols];
-            copy(G_i, G+i, cols, 1, n);
+    //        G(i,i)=sqrt(diagG(i));
+            const T G_ii = sqrt(diagG[i]);
+            T* G_i = G+(n*i);
+            G_i[i] = G_ii;
 
+    //        G((i+1):n,i)=1/G(i,i)*( F((i+1):n,c) - G((i+1):n,i0:(i-1))*(G(i,i0:(i-1)))');
+            const int rows = n-(i+1);
             const T beta = 1.0/G_ii;
 
-            gemv(CblasNoTrans, rows, cols, -beta, G_ip1_n, rows, G_i, 1, beta, newKcol, 1);
-            copy(G+(i+1)+(n*i), newKcol, rows);
-
-            delete [] G_i;
+            copy(G_i+(i+1), F+(n*c)+(i+1), rows);
+            if(j > 0)
+                gemv(CblasNoTrans, rows, j, -beta, G+(n*i0)+(i+1), n, G+(n*i0)+i, n, beta, G_i+(i+1), 1);
+            else
+                scal(rows, beta, G_i+(i+1), 1);
 
             // updates diagonal elements
-    //        diagG((i+1):n)=ones(n-i,1)-sum(G((i+1):n,1:i).^2,2  );
-            copy(G_ip1_n+(rows*cols), newKcol, rows);
-            mult(G_ip1_n, G_ip1_n, G_ip1_n, rows*(cols+1));
-
-            delete [] newKcol;
-
-            T* sums = new T[rows];
-            sum_col(G_ip1_n, sums, rows, cols+1);
-            set(diagG+(i+1), (T)1.0, rows);
-            axpy(rows, (T)-1.0, sums, 1, diagG+(i+1), 1);
-
-            delete [] sums;
-            delete [] G_ip1_n;
-
+    //        diagG((i+1):n)=diagG((i+1):n)-G((i+1):n,i).^2;
+            for(T *dg_it = diagG+(i+1), *G_it = G_i+(i+1), *const dg_end = diagG+n; dg_it != dg_end; ++dg_it, ++G_it)
+                *dg_it -= (*G_it)*(*G_it);
 
             // performs QR decomposition
-    //        Gcol = G(:,i);
-            T* Gcol = new T[n];
-            copy(Gcol, G+(n*i), n);
-
-    //        Rcol = Q(:,1:(i-1))' * Gcol;
-            T* Rcol = new T[cols];
-            T* Q_sub = new T[n*cols];
-            copy(Q_sub, Q, n*cols);
-            gemv(CblasTrans, n, cols, (T)1.0, Q_sub, n, Gcol, 1, (T)0.0, Rcol, 1);
-
-
-    //        Q(:,i) = Gcol - Q(:,1:(i-1)) * Rcol;
+    //        Rcol = Q(:,1:(i-1))' * G(:,i);
+    //        Q(:,i) = G(:,i) - Q(:,1:(i-1)) * Rcol;
             T* Q_i = Q+(n*i);
-            copy(Q_i, Gcol, n);
-            gemv(CblasNoTrans, n, cols, (T)-1.0, Q_sub, n, Rcol, 1, (T)1.0, Q_i, 1);
+            copy(Q_i, G_i, n);
 
-            delete [] Gcol;
-            delete [] Q_sub;
+            if(cols > 0)
+            {
+                gemv(CblasTrans, n, cols, (T)1.0, Q, n, G_i, 1, (T)0.0, Rcol, 1);
+                gemv(CblasNoTrans, n, cols, (T)-1.0, Q, n, Rcol, 1, (T)1.0, Q_i, 1);
+            }
 
     //        Rii = norm(Q(:,i));
     //        Q(:,i) = Q(:,i) / Rii;
             normG = nrm2(n, Q_i, 1);
             scal(n, (T)1.0/normG, Q_i, 1);
-
+            normG *= normG;
 
             // updates
+            if(cols > 0)
+            {
     //        RR(1:(i-1),i) = -(RR(1:(i-1),1:(i-1))*Rcol)./Rii;
-            T* RR_sub = new T[cols*cols];
-            for(T *R_it = RR, *Rs_it = RR_sub, *const R_end = R_it+(i*m); R_it != R_end; R_it+=m, Rs_it+=cols)
-                copy(Rs_it, R_it, cols);
-
-            T* RR_i = RR+(m*i);
-            T* RR_Rcol = new T[cols];
-
-            gemv(CblasNoTrans, cols, cols, (T)1.0, RR_sub, cols, Rcol, 1, (T)0.0, RR_Rcol, 1);
-            copy(RR_i, RR_Rcol, cols);
-            scal(cols, (T)-1.0/normG, RR_i, 1);
-
-            delete[] RR_sub;
+                T* RR_i = RR+(m*i);
+                gemv(CblasNoTrans, cols, cols, (T)1.0, RR, m, Rcol, 1, (T)0.0, RR_Rcol, 1);
+                copy(RR_i, RR_Rcol, cols);
+                scal(cols, (T)-1.0/std::sqrt(normG), RR_i, 1);
 
     //        RR(i,1:(i-1)) = RR(1:(i-1),i)';
-            copy(RR+i, RR_i, cols, m, 1);
+                copy(RR+i, RR_i, cols, m, 1);
 
     //        RR(i,i) = (Rcol'*RR(1:(i-1),1:(i-1))*Rcol + 1)./(Rii^2);
-            normG *= normG;
-            RR[i+(i*m)] = (dot(cols, Rcol, 1, RR_Rcol, 1)+1) / normG;
-
-            delete [] Rcol;
-            delete [] RR_Rcol;
-        }
-
+                RR[i+(i*m)] = (dot(cols, Rcol, 1, RR_Rcol, 1)+1) / normG;
+            }
+            else
+            {
+    //        RR(1,1) = 1/(normG^2);
+                RR[0] = 1.0/normG;
+            }
 
-        if(ireg.find(i) != ireg.end())
-        {
-            *guesses_mat_it++ = i+1;
 
-//            vout.alpha = Q(:,1:i)*RR(1:i,1:i)*(Q(:,1:i)'*y(Pvec,:));
+            if(computePred)
+            {
+                //  Kva(:,i) = exp(-1/sigma^2*square_distance(Xva',X(Pvec(i),:)'));
+                T* Kva_i = Kva+(nva*i);
+                distance_transposed_vm(Xperm+i, Xva->getData(), d, nva, Kva_i, nva, n);
+                scal(nva, (T)(-1.0/(sigma*sigma)), Kva_i, 1);
+                gurls::exp(Kva_i, nva);
+            }
 
-            const unsigned long ii = i+1;
+            if(ireg.find(i) != ireg.end())
+            {
+                *guesses_mat_it++ = i+1;
 
+    //            vout.alpha = Q(:,1:i)*RR(1:i,1:i)*(Q(:,1:i)'*y(Pvec,:));
 
-            T* QtYp = new T[ii*t];
-            dot(Q, yPvec, QtYp, n, ii, n, t, ii, t, CblasTrans, CblasNoTrans, CblasColMajor);
+                const unsigned long ii = i+1;
 
-            T* RR_sub = new T[ii*ii];
-            for(T *R_it = RR, *Rs_it = RR_sub, *const R_end = R_it+(ii*m); R_it != R_end; R_it+=m, Rs_it+=ii)
-                copy(Rs_it, R_it, ii);
 
-            T* RRQtYp = new T[ii*t];
-            dot(RR_sub, QtYp, RRQtYp, ii, ii, ii, t, ii, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
+                T* QtYp = new T[ii*t];
+                gemm(CblasTrans, CblasNoTrans, ii, t, n, (T)1.0, Q, n, yPvec, n, (T)0.0, QtYp, ii);
 
-            delete [] RR_sub;
-            delete [] QtYp;
+                T* RRQtYp = new T[ii*t];
+                gemm(CblasNoTrans, CblasNoTrans, ii, t, ii, (T)1.0, RR, m, QtYp, ii, (T)0.0, RRQtYp, ii);
 
-            T* alpha_i = new T[n*t];
-            dot(Q, RRQtYp, alpha_i, n, ii, ii, t, n, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
+                delete [] QtYp;
 
-            delete [] RRQtYp;
+                T* alpha_i = new T[n*t];
+                gemm(CblasNoTrans, CblasNoTrans, n, t, ii, (T)1.0, Q, n, RRQtYp, ii, (T)0.0, alpha_i, n);
 
+                delete [] RRQtYp;
 
+            //    The factor satisfies G = K(:,Pvec(1:i))/L', with L = G(1:i,1:i), hence
+            //    K*alpha ~ G*G'*alpha = K(:,Pvec(1:i))*Ci, and the estimator only needs the pivots
+            //    Ci = L'\(G(:,1:i)'*alpha);
+                gMat2D<T>* CMat = new gMat2D<T>(ii, t);
+                T *const CMat_it = CMat->getData();
 
-        //    permute indices of alpha
-        //    vout.alpha(Pvec, :) = vout.alpha;
-            gMat2D<T>* alphaMat = new gMat2D<T>(n,t);
+                gemm(CblasTrans, CblasNoTrans, ii, t, n, (T)1.0, G, n, alpha_i, n, (T)0.0, CMat_it, ii);
+                trsm(CblasLeft, CblasLower, CblasTrans, CblasNonUnit, ii, t, (T)1.0, G, n, CMat_it, ii);
 
-            T *const alphaMat_it = alphaMat->getData();
-            for (unsigned long j=0; j<n; ++j)
-                copy(alphaMat_it+pVec[j], alpha_i+j, t, n, n);
+                delete [] alpha_i;
 
-            delete [] alpha_i;
+                bool keep;
 
-            if(computePred)
-            {
-                // pred_primal
-                gMat2D<T> * pred = new gMat2D<T>(Xva->rows(), t);
-                dot(predKernel_K->getData(), alphaMat_it, pred->getData(), Xva->rows(), n, n, t, Xva->rows(), t, CblasNoTrans, CblasNoTrans, CblasColMajor);
+                if(computePred)
+                {
+                    // pred_primal
+                    gMat2D<T> * pred = new gMat2D<T>(nva, t);
+                    dot(Kva, CMat_it, pred->getData(), nva, ii, ii, t, nva, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
 
-                // perf_macroavg
+                    // perf_macroavg
 
-                perf_opt->addOpt("pred", new OptMatrix<gMat2D<T> >(*pred));
-                GurlsOptionsList* perf = perfTask->execute(empty, *yva, *perf_opt);
+                    perf_opt->addOpt("pred", new OptMatrix<gMat2D<T> >(*pred));
+                    GurlsOptionsList* perf = perfTask->execute(empty, *yva, *perf_opt);
 
-                gMat2D<T>& acc = perf->getOptValue<OptMatrix<gMat2D<T> > >("acc");
-                T perf_i = sumv(acc.getData(), acc.getSize())/acc.getSize();
-                *perfs = perf_i;
-//                ++perfs;
+                    gMat2D<T>& acc = perf->getOptValue<OptMatrix<gMat2D<T> > >("acc");
+                    T perf_i = sumv(acc.getData(), acc.getSize())/acc.getSize();
+                    *perfs = perf_i;
+    //                ++perfs;
 
-                perf_opt->removeOpt("pred");
-                delete perf;
+                    perf_opt->removeOpt("pred");
+                    delete perf;
 
-                if(perf_i > maxPerf)
+                    keep = (perf_i > maxPerf);
+                    if(keep)
+                    {
+                        maxPerf = perf_i;
+                        maxRank = i;
+                    }
+                }
+                else
                 {
-                    maxPerf = perf_i;
-                    maxRank = i;
+                    keep = (i == m-1);
+                    if(keep)
+                    {
+                        maxPerf = 1;
+                        maxRank = i;
+
+                        set(perfs, (T)0.0, ireg.size());
+                        set(times_mat->getData(), (T)0.0, ireg.size());
+                    }
+                }
 
-                    delete alpha;
-                    alpha = alphaMat;
+                if(keep)
+                {
+                //    Xp = X(Pvec(1:i),:);
+                    gMat2D<T>* XpMat = new gMat2D<T>(ii, d);
+                    subMatrixFromRows(X.getData(), n, d, pVec, ii, XpMat->getData());
+
+                    delete Xp;
+                    delete C;
+                    Xp = XpMat;
+                    C = CMat;
                 }
                 else
-                    delete alphaMat;
-
+                    delete CMat;
 
-                if(le(*perfs, prevPerf) && i > 10)
-                    break;
-                else
+                if(computePred)
                 {
-                    prevPerf = *perfs;
-                    ++perfs;
+                    if(le(*perfs, prevPerf) && i > 10)
+                        stop = true;
+                    else
+                    {
+                        prevPerf = *perfs;
+                        ++perfs;
+                    }
                 }
-            }
-            else
-            {
-                if(i == m-1)
-                {
-                    delete alpha;
-                    alpha = alphaMat;
-                    maxPerf = 1;
-                    maxRank = i;
 
-                    set(perfs, (T)0.0, ireg.size());
-                    set(times, (T)0.0, ireg.size());
-                }
-            }
+                if(stop)
+                    continue;
 
-            end = boost::posix_time::microsec_clock::local_time();
-            diff = end-begin;
+                end = boost::posix_time::microsec_clock::local_time();
+                diff = end-begin;
 
-            *times = diff.total_milliseconds();
-            ++times;
+                *times = diff.total_milliseconds();
+                ++times;
 
+            }
         }
 
+        i0 += j;
     }
 
+    delete [] F;
+    delete [] Xc;
+    delete [] Gc;
+    delete [] Fc;
+    delete [] cpos;
+    delete [] cdone;
+    delete [] Rcol;
+    delete [] RR_Rcol;
+    delete [] Xnorms;
+    delete [] Xperm;
+
     delete perf_opt;
     delete perfTask;
 
+    // ---- state for the online updates ----
+    // Row swaps leave G(:,1:r)'*G(:,1:r) and G(:,1:r)'*y(Pvec,:) unchanged, hence
+    // they can be computed here for the selected rank r
+
+    const unsigned long r = maxRank+1;
+
+    //  L = G(1:r,1:r);
+    gMat2D<T>* L = new gMat2D<T>(r, r);
+    T* L_it = L->getData();
+    for(unsigned long j=0; j<r; ++j)
+        copy(L_it+(r*j), G+(n*j), r);
+
+    //  R = chol(G(:,1:r)'*G(:,1:r));
+    gMat2D<T>* R = new gMat2D<T>(r, r);
+    T* GtG = new T[r*r];
+    set(GtG, (T)0.0, r*r);
+    syrk(CblasUpper, CblasTrans, r, n, (T)1.0, G, n, (T)0.0, GtG, r);
+    cholesky(GtG, r, r, R->getData());
+    delete [] GtG;
+
+    //  GtY = G(:,1:r)'*y(Pvec,:);
+    gMat2D<T>* GtY = new gMat2D<T>(r, t);
+    gemm(CblasTrans, CblasNoTrans, r, t, n, (T)1.0, G, n, yPvec, n, (T)0.0, GtY->getData(), r);
+
+    GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
+    optimizer->addOpt("L", new OptMatrix<gMat2D<T> >(*L));
+    optimizer->addOpt("R", new OptMatrix<gMat2D<T> >(*R));
+    optimizer->addOpt("GtY", new OptMatrix<gMat2D<T> >(*GtY));
+
+    opt->removeOpt("optimizer");
+    opt->addOpt("optimizer", optimizer);
+
     delete [] G;
     delete [] diagG;
 
@@ -412,17 +472,19 @@ void ICholWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 
     delete [] pVec;
 
-    delete predKernel_K;
+    delete [] Kva;
 
     GurlsOptionsList* paramsel = opt->getOptAs<GurlsOptionsList>("paramsel");
-    paramsel->removeOpt("alpha");
+    paramsel->removeOpt("X");
+    paramsel->removeOpt("C");
     paramsel->removeOpt("acc");
     paramsel->removeOpt("maxRank");
     paramsel->removeOpt("maxPerf");
     paramsel->removeOpt("times");
     paramsel->removeOpt("guesses");
 
-    paramsel->addOpt("alpha", new OptMatrix<gMat2D<T> >(*alpha));
+    paramsel->addOpt("X", new OptMatrix<gMat2D<T> >(*Xp));
+    paramsel->addOpt("C", new OptMatrix<gMat2D<T> >(*C));
     paramsel->addOpt("acc", new OptMatrix<gMat2D<T> >(*perfs_mat));
     paramsel->addOpt("maxRank", new OptNumber(maxRank));
     paramsel->addOpt("maxPerf", new OptNumber(maxPerf));
@@ -434,104 +496,195 @@ void ICholWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 template <typename T>
 void ICholWrapper<T>::update(const gVec<T> &X, const gVec<T> &y)
 {
-}
+    if(!this->trainedModel())
+        throw gException("Error, Train Model First");
 
-template <typename T>
-gMat2D<T>* ICholWrapper<T>::eval(const gMat2D<T> &X)
-{
-    GurlsOptionsList *opt = this->opt;
+    GurlsOptionsList* opt = this->opt;
+    GurlsOptionsList* paramsel = opt->getOptAs<GurlsOptionsList>("paramsel");
+    GurlsOptionsList* optimizer = opt->getOptAs<GurlsOptionsList>("optimizer");
 
-    const gMat2D<T> &alpha_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.alpha");
-    const T *const alpha = alpha_mat.getData();
+    gMat2D<T>* Xp = &(paramsel->getOptValue<OptMatrix<gMat2D<T> > >("X"));
+    gMat2D<T>* C = &(paramsel->getOptValue<OptMatrix<gMat2D<T> > >("C"));
+    gMat2D<T>* L = &(optimizer->getOptValue<OptMatrix<gMat2D<T> > >("L"));
+    gMat2D<T>* R = &(optimizer->getOptValue<OptMatrix<gMat2D<T> > >("R"));
+    gMat2D<T>* GtY = &(optimizer->getOptValue<OptMatrix<gMat2D<T> > >("GtY"));
 
-    const unsigned long n = X.rows();
-    const unsigned long nt = alpha_mat.rows();
-    const unsigned long t = alpha_mat.cols();
+    unsigned long r = Xp->rows();
+    const unsigned long d = Xp->cols();
+    const unsigned long t = GtY->cols();
+
+    if(X.getSize() != d || y.getSize() != t)
+        throw gException(Exception_Inconsistent_Size);
 
-    PredKernelTrainTest<T> predKernelTask;
+    const double sigma = paramsel->getOptAsNumber("sigma");
+    const unsigned long m = static_cast<unsigned long>(paramsel->getOptAsNumber("rank_max"));
+    const bool promote = (opt->getOptAsNumber("promotepivots") != 0) && (r < m);
 
-    gMat2D<T> empty;
+    T* g = new T[r+1];
 
+    //  g = L\exp(-1/sigma^2*square_distance(Xp',x'));
+    distance_transposed_vm(X.getData(), Xp->getData(), d, r, g, r);
+    scal(r, (T)(-1.0/(sigma*sigma)), g, 1);
+    gurls::exp(g, r);
 
-    GurlsOptionsList* opt_tmp = new GurlsOptionsList("tmp");
-    GurlsOptionsList* tmp_kernel = new GurlsOptionsList("kernel");
-    GurlsOptionsList* tmp_paramsel = new GurlsOptionsList("paramsel");
+    trsm(CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, r, 1, (T)1.0, L->getData(), r, g, r);
+
+    if(promote)
+    {
+        // residual diagonal of the new sample, compared to the smallest one
+        // among those of the current pivots when they were selected
+        const T* L_it = L->getData();
+        T minDiag = L_it[0]*L_it[0];
+        for(unsigned long i=1; i<r; ++i)
+            minDiag = std::min(minDiag, L_it[(r+1)*i]*L_it[(r+1)*i]);
 
-    opt_tmp->addOpt("kernel", tmp_kernel);
-    opt_tmp->addOpt("paramsel", tmp_paramsel);
-    opt_tmp->addOpt("optimizer", opt->getOpt("optimizer"));
+        const T res = (T)1.0 - dot(r, g, 1, g, 1);
+
+        if(res > minDiag)
+        {
+            // The new pivot adds a row to L, and a column to G that is zero on the past
+            // samples, since they are represented by their projection onto the previous pivots
+
+            const unsigned long rp1 = r+1;
+
+            //  Xp = [Xp; x];
+            gMat2D<T>* Xp_new = new gMat2D<T>(rp1, d);
+            T* Xp_it = Xp_new->getData();
+            for(unsigned long j=0; j<d; ++j)
+                copy(Xp_it+(rp1*j), Xp->getData()+(r*j), r);
+            copy(Xp_it+r, X.getData(), d, rp1, 1);
+
+            //  L = [L, zeros(r,1); g', sqrt(res)];
+            //  R = [R, zeros(r,1); zeros(1,r+1)];
+            gMat2D<T>* L_new = new gMat2D<T>(rp1, rp1);
+            gMat2D<T>* R_new = new gMat2D<T>(rp1, rp1);
+            T* Ln_it = L_new->getData();
+            T* Rn_it = R_new->getData();
+            set(Ln_it, (T)0.0, rp1*rp1);
+            set(Rn_it, (T)0.0, rp1*rp1);
+            for(unsigned long j=0; j<r; ++j)
+            {
+                copy(Ln_it+(rp1*j), L->getData()+(r*j), r);
+                copy(Rn_it+(rp1*j), R->getData()+(r*j), r);
+            }
+            copy(Ln_it+r, g, r, rp1, 1);
+            Ln_it[(rp1*r)+r] = std::sqrt(res);
 
-    tmp_kernel->addOpt("type", "rbf");
-    tmp_paramsel->addOpt("sigma", new OptNumber(opt->getOptAsNumber("paramsel.sigma")));
+            //  GtY = [GtY; zeros(1,t)];
+            gMat2D<T>* GtY_new = new gMat2D<T>(rp1, t);
+            T* GtYn_it = GtY_new->getData();
+            for(unsigned long j=0; j<t; ++j)
+            {
+                copy(GtYn_it+(rp1*j), GtY->getData()+(r*j), r);
+                GtYn_it[(rp1*j)+r] = (T)0.0;
+            }
 
+            g[r] = std::sqrt(res);
+
+            paramsel->removeOpt("X");
+            paramsel->addOpt("X", new OptMatrix<gMat2D<T> >(*Xp_new));
+            optimizer->removeOpt("L");
+            optimizer->addOpt("L", new OptMatrix<gMat2D<T> >(*L_new));
+            optimizer->removeOpt("R");
+            optimizer->addOpt("R", new OptMatrix<gMat2D<T> >(*R_new));
+            optimizer->removeOpt("GtY");
+            optimizer->addOpt("GtY", new OptMatrix<gMat2D<T> >(*GtY_new));
+
+            gMat2D<T>* C_new = new gMat2D<T>(rp1, t);
+            paramsel->removeOpt("C");
+            paramsel->addOpt("C", new OptMatrix<gMat2D<T> >(*C_new));
+
+            Xp = Xp_new;
+            L = L_new;
+            R = R_new;
+            GtY = GtY_new;
+            C = C_new;
+            r = rp1;
+        }
+    }
 
-    gMat2D<T> *y = new gMat2D<T>(n, t);
+    //  R = cholupdate(R, g);
+    T* work = new T[cholupdateWorkSize(r, 1)];
+    cholupdate(R->getData(), r, g, 1, work);
+    delete [] work;
 
-    GurlsOptionsList *predKernel = predKernelTask.execute(X, empty, *opt_tmp);
-    const gMat2D<T> &predKernel_K = predKernel->getOptValue<OptMatrix<gMat2D<T> > >("K");
+    //  GtY = GtY + g*y';
+    gemm(CblasNoTrans, CblasNoTrans, r, t, 1, (T)1.0, g, r, y.getData(), 1, (T)1.0, GtY->getData(), r);
 
-    dot(predKernel_K.getData(), alpha, y->getData(), n, nt, nt, t, n, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
+    delete [] g;
 
-    opt_tmp->removeOpt("optimizer", false);
-    delete opt_tmp;
-    delete predKernel;
+    //  C = L'\(R\(R'\GtY));
+    T* C_it = C->getData();
+    copy(C_it, GtY->getData(), r*t);
+    trsm(CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, r, t, (T)1.0, R->getData(), r, C_it, r);
+    trsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, r, t, (T)1.0, R->getData(), r, C_it, r);
+    trsm(CblasLeft, CblasLower, CblasTrans, CblasNonUnit, r, t, (T)1.0, L->getData(), r, C_it, r);
+}
 
-    return y;
+template <typename T>
+gMat2D<T>* ICholWrapper<T>::eval(const gMat2D<T> &X)
+{
+    return eval_ls(X);
 }
 
 template <typename T>
 gMat2D<T>* ICholWrapper<T>::eval_ls(const gMat2D<T> &X)
+{
+    const unsigned long m = this->opt->template getOptValue<OptMatrix<gMat2D<T> > >("paramsel.X").rows();
+
+    const unsigned long blocksize = this->opt->hasOpt("evalblocksize")?
+                static_cast<unsigned long>(this->opt->getOptAsNumber("evalblocksize")) : predict_kernel_blocksize(m);
+
+    return eval_pivots(X, blocksize);
+}
+
+template <typename T>
+gMat2D<T>* ICholWrapper<T>::eval_pivots(const gMat2D<T> &X, unsigned long blocksize)
 {
     GurlsOptionsList *opt = this->opt;
 
-    const gMat2D<T> &alpha_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.alpha");
-    const T *const alpha = alpha_mat.getData();
+    const gMat2D<T> &C_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.C");
+    const gMat2D<T> &Xp_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.X");
 
     const unsigned long n = X.rows();
     const unsigned long d = X.cols();
-    const unsigned long nt = alpha_mat.rows();
-    const unsigned long t = alpha_mat.cols();
+    const unsigned long m = C_mat.rows();
+    const unsigned long t = C_mat.cols();
 
-    gMat2D<T> Xi_mat(1, d);
-    T* yi = new T[t];
-    T* const Xi = Xi_mat.getData();
+    if(Xp_mat.cols() != d || Xp_mat.rows() != m)
+        throw gException(Exception_Inconsistent_Size);
 
     gMat2D<T> *y_mat = new gMat2D<T>(n, t);
-    T* y_it = y_mat->getData();
-
-    GurlsOptionsList* opt_tmp = new GurlsOptionsList("tmp");
-    GurlsOptionsList* tmp_kernel = new GurlsOptionsList("kernel");
-    GurlsOptionsList* tmp_paramsel = new GurlsOptionsList("paramsel");
-
-    opt_tmp->addOpt("kernel", tmp_kernel);
-    opt_tmp->addOpt("paramsel", tmp_paramsel);
-    opt_tmp->addOpt("optimizer", opt->getOpt("optimizer"));
-
-    tmp_kernel->addOpt("type", "rbf");
-    tmp_paramsel->addOpt("sigma", new OptNumber(opt->getOptAsNumber("paramsel.sigma")));
-
 
-    PredKernelTrainTest<T> predKernelTask;
-    const gMat2D<T> empty;
-
-    for(int i=0; i<n; ++i, ++y_it)
-    {
-        getRow(X.getData(), n, d, i, Xi);
+    //  y = exp(-1/sigma^2*square_distance(X',Xp'))*C;
+    predict_kernel_blocked("rbf", X.getData(), n, d, Xp_mat.getData(), m,
+                           C_mat.getData(), t, opt->getOptAsNumber("paramsel.sigma"), y_mat->getData(), blocksize);
 
-        GurlsOptionsList *predKernel = predKernelTask.execute(Xi_mat, empty, *opt_tmp);
-        const gMat2D<T> &predKernel_K = predKernel->getOptValue<OptMatrix<gMat2D<T> > >("K");
+    return y_mat;
+}
 
-        dot(predKernel_K.getData(), alpha, yi, 1, nt, nt, t, 1, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
-        copy(y_it, yi, t, n, 1);
+template <typename T>
+void ICholWrapper<T>::setEvalBlockSize(unsigned long value)
+{
+    if(this->opt->hasOpt("evalblocksize"))
+        this->opt->template getOptValue<OptNumber>("evalblocksize") = value;
+    else
+        this->opt->addOpt("evalblocksize", new OptNumber(value));
+}
 
-        delete predKernel;
-    }
+template <typename T>
+void ICholWrapper<T>::setPromotePivots(bool value)
+{
+    this->opt->template getOptValue<OptNumber>("promotepivots") = value;
+}
 
-    opt_tmp->removeOpt("optimizer", false);
-    delete opt_tmp;
-    delete [] yi;
+template <typename T>
+void ICholWrapper<T>::setPivotBlockSize(unsigned long value)
+{
+    if(value == 0)
+        throw gException(Exception_Illegal_Argument_Value);
 
-    return y_mat;
+    this->opt->template getOptValue<OptNumber>("pivotblocksize") = value;
 }
 
 template <typename T>
@@ -576,36 +729,4 @@ void ICholWrapper<T>::setyva(const gMat2D<T> &yva)
     split->addOpt("yva", new OptMatrix<gMat2D<T> >(*yva_mat));
 }
 
-template <typename T>
-T* ICholWrapper<T>::computeNewKcol(const T* Xtr, const unsigned long xr, const unsigned long xc,
-                                             const double sigma,
-                                             const unsigned long* pVec,
-                                             const unsigned long start, const unsigned long n)
-{
-    // newKcol = exp(-1/sigma^2*square_distance(Xtr(Pvec(start:n),:)',Xtr(Pvec(start-1),:)'));
-
-    const unsigned long len = n-start;
-
-    T* newKcol = new T[len];
-
-    T* XtrPvec = new T[len*xc];
-    subMatrixFromRows(Xtr, xr, xc, pVec+start, len, XtrPvec);
-
-    T* XtrPvecT = new T[xc*len];
-    transpose(XtrPvec, len, xc, XtrPvecT);
-    delete[] XtrPvec;
-
-    T* XtrRow = new T[xc];
-    getRow(Xtr, xr, xc, pVec[start-1], XtrRow);
-
-    distance(XtrPvecT, XtrRow, xc, len, 1, newKcol);
-    delete [] XtrRow;
-    delete [] XtrPvecT;
-
-    scal(len, (T)(-1.0/(sigma*sigma)), newKcol, 1);
-    gurls::exp(newKcol, len);
-
-    return newKcol;
-}
-
 }
@@ -153,9 +153,9 @@ GurlsOptionsList* ParamSelLoocvDual<T>::execute(const gMat2D<T>& X, const gMat2D
     T* ap = perf->getData();
 
     T* C_div_Z = new T[qrows];
-    T* C = new T[qrows*qcols];
+    T* C = alloc_buffer<T>(qrows*qcols);
     T* Z = new T[qrows];
-    T* work = new T[std::max((qrows+1)*l_length, (qrows*qcols)+l_length)];
+    T* work = alloc_buffer<T>(std::max((qrows+1)*l_length, (qrows*qcols)+l_length));
 
     for(int i = 0; i < tot; ++i)
     {
@@ -183,8 +183,8 @@ GurlsOptionsList* ParamSelLoocvDual<T>::execute(const gMat2D<T>& X, const gMat2D
     }
 
     delete nestedOpt;
-    delete[] work;
-    delete [] C;
+    free_buffer(work);
+    free_buffer(C);
     delete [] Z;
     delete [] C_div_Z;
     delete perfClass;
@@ -0,0 +1,147 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_MAPPEDFILE_H_
+#define _GURLS_MAPPEDFILE_H_
+
+#include <cstddef>
+#include <string>
+
+#include "gurls++/exports.h"
+
+namespace gurls {
+
+/**
+ * \ingroup Common
+ * \brief MappedFile maps a whole file in memory.
+ *
+ * The mapping is private and copy-on-write: the pages are read from the page cache,
+ * and hence shared with any other process mapping the same file, until they are
+ * modified; modifications are never written back to the file.
+ */
+class GURLS_EXPORT MappedFile
+{
+public:
+
+    /**
+     * Expected access pattern, passed to the kernel as an madvise hint
+     */
+    enum AccessHint {NORMAL, SEQUENTIAL, RANDOM, WILLNEED};
+
+    /**
+     * Maps the file fileName
+     *
+     * \param fileName path of the file
+     * \param hint expected access pattern
+     * \param populate if true the whole file is read in memory before returning (MAP_POPULATE)
+     */
+    MappedFile(const std::string& fileName, AccessHint hint = NORMAL, bool populate = false);
+
+    /**
+     * Unmaps the file
+     */
+    ~MappedFile();
+
+    /**
+     * Returns the address of the first byte of the file
+     */
+    char* getData() const {return data;}
+
+    /**
+     * Returns the size of the file in bytes
+     */
+    std::size_t getSize() const {return size;}
+
+    /**
+     * Returns the name of the mapped file
+     */
+    const std::string& getFileName() const {return fileName;}
+
+private:
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+
+    std::string fileName;
+    char* data;
+    std::size_t size;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mappingHandle;
+#endif
+};
+
+/**
+ * \ingroup Common
+ * \brief Header of the binary matrix files written by gMat2D::saveBinary.
+ *
+ * The header takes 64 bytes and is followed by the rows*cols elements of the matrix
+ * in column-major order, in the native byte order, so that the data of a mapped
+ * file are aligned to the size of any element type.
+ */
+struct GURLS_EXPORT MatrixFileHeader
+{
+    char magic[8];                  ///< "GURLSMAT"
+    unsigned int version;           ///< Format version, currently 1
+    unsigned int elementSize;       ///< sizeof of the element type
+    unsigned int integer;           ///< 1 if the elements are integers, 0 if they are floating point values
+    unsigned int reserved;
+    unsigned long long rows;        ///< Number of rows
+    unsigned long long cols;        ///< Number of columns
+    char padding[24];
+
+    static const std::size_t headerSize = 64;   ///< Offset of the elements in the file
+
+    /**
+     * Builds the header of a rows x cols matrix
+     */
+    MatrixFileHeader(unsigned long long rows, unsigned long long cols, unsigned int elementSize, bool integer);
+
+    /**
+     * Reads and validates the header at the beginning of a buffer of fileSize bytes.
+     * An exception is thrown if the header is not valid, if its element type differs
+     * from (elementSize, integer), or if the buffer is too small for the matrix.
+     */
+    static MatrixFileHeader read(const char* buffer, std::size_t fileSize, unsigned int elementSize, bool integer, const std::string& fileName);
+};
+
+}
+
+#endif // _GURLS_MAPPEDFILE_H_
@@ -0,0 +1,260 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_MATRIXVIEW_H_
+#define _GURLS_MATRIXVIEW_H_
+
+#include <algorithm>
+
+#include "gurls++/gmath.h"
+#include "gurls++/gmat2d.h"
+#include "gurls++/allocator.h"
+
+namespace gurls {
+
+/**
+ * \ingroup LinearAlgebra
+ * \brief MatrixView is a non-owning view of a submatrix of a column-major matrix.
+ *
+ * The rows (and the columns) of the view are either a contiguous range of the
+ * underlying matrix, addressed through its leading dimension, or an arbitrary set
+ * of indices. A view without index maps is strided and is passed to BLAS as it is;
+ * an indexed view is gathered with \ref gather_submatrix only where BLAS needs a
+ * contiguous operand, one bounded panel at a time.
+ * The underlying buffer and the index maps must outlive the view.
+ */
+template<typename T>
+class MatrixView
+{
+public:
+
+    /**
+     * Constructor building a view of a whole matrix
+     */
+    MatrixView(const gMat2D<T>& M)
+        : data(M.getData()), r(M.rows()), c(M.cols()), ldim(M.rows()), rowIdx(NULL), colIdx(NULL) {}
+
+    /**
+     * Constructor building a view of the rows rowIndices of a matrix
+     *
+     * \param M underlying matrix
+     * \param rowIndices indices of the rows of the view
+     * \param nRows number of rows of the view
+     */
+    MatrixView(const gMat2D<T>& M, const unsigned long* rowIndices, const unsigned long nRows)
+        : data(M.getData()), r(nRows), c(M.cols()), ldim(M.rows()), rowIdx(rowIndices), colIdx(NULL) {}
+
+    /**
+     * Constructor building a view of the submatrix M(rowIndices, colIndices)
+     *
+     * \param M underlying matrix
+     * \param rowIndices indices of the rows of the view
+     * \param nRows number of rows of the view
+     * \param colIndices indices of the columns of the view
+     * \param nCols number of columns of the view
+     */
+    MatrixView(const gMat2D<T>& M, const unsigned long* rowIndices, const unsigned long nRows,
+               const unsigned long* colIndices, const unsigned long nCols)
+        : data(M.getData()), r(nRows), c(nCols), ldim(M.rows()), rowIdx(rowIndices), colIdx(colIndices) {}
+
+    /**
+     * Constructor building a strided view: element (i,j) is data[i + j*ld]
+     */
+    MatrixView(const T* data, const unsigned long rows, const unsigned long cols, const unsigned long ld)
+        : data(data), r(rows), c(cols), ldim(ld), rowIdx(NULL), colIdx(NULL) {}
+
+    /**
+     * Generic constructor: element (i,j) is data[rowIndices[i] + colIndices[j]*ld],
+     * a NULL index map selects the first rows (columns) of the buffer.
+     */
+    MatrixView(const T* data, const unsigned long ld,
+               const unsigned long* rowIndices, const unsigned long rows,
+               const unsigned long* colIndices, const unsigned long cols)
+        : data(data), r(rows), c(cols), ldim(ld), rowIdx(rowIndices), colIdx(colIndices) {}
+
+    unsigned long rows() const {return r;}      ///< Number of rows of the view
+    unsigned long cols() const {return c;}      ///< Number of columns of the view
+    unsigned long ld() const {return ldim;}     ///< Leading dimension of the underlying buffer
+    const T* getData() const {return data;}     ///< Underlying buffer
+
+    /**
+     * Returns true if the view has no index maps and can be passed to BLAS directly
+     */
+    bool isStrided() const {return rowIdx == NULL && colIdx == NULL;}
+
+    /**
+     * Returns the element (i,j) of the view
+     */
+    T operator()(const unsigned long i, const unsigned long j) const
+    {
+        return data[((rowIdx != NULL)? rowIdx[i]: i) + ((colIdx != NULL)? colIdx[j]: j)*ldim];
+    }
+
+    /**
+     * Returns the view of the nRows x nCols block starting at (r0, c0)
+     */
+    MatrixView block(const unsigned long r0, const unsigned long nRows, const unsigned long c0, const unsigned long nCols) const
+    {
+        const T* d = data;
+        if(rowIdx == NULL)
+            d += r0;
+        if(colIdx == NULL)
+            d += c0*ldim;
+
+        return MatrixView(d, ldim, (rowIdx != NULL)? rowIdx+r0: NULL, nRows, (colIdx != NULL)? colIdx+c0: NULL, nCols);
+    }
+
+    /**
+     * Copies the view into the column-major buffer dst, with leading dimension ldd
+     */
+    void gather(T* dst, const unsigned long ldd) const
+    {
+        gather_submatrix(dst, ldd, data, ldim, rowIdx, r, colIdx, c);
+    }
+
+    /**
+     * Returns true if the two views address the same elements
+     */
+    bool operator==(const MatrixView& other) const
+    {
+        return data == other.data && r == other.r && c == other.c && ldim == other.ldim
+                && rowIdx == other.rowIdx && colIdx == other.colIdx;
+    }
+
+private:
+    const T* data;
+    unsigned long r;
+    unsigned long c;
+    unsigned long ldim;
+    const unsigned long* rowIdx;
+    const unsigned long* colIdx;
+};
+
+/**
+ * Computes C = alpha*op(A)*op(B) + beta*C where A and B are views.
+ *
+ * Strided operands are passed to BLAS directly. When an operand is indexed, the
+ * product is accumulated over panels of the inner dimension and only the current
+ * panel of the indexed operands is gathered, so that the extra memory is bounded
+ * by the panel size rather than by the size of the submatrix.
+ * When op(B) is the transpose of op(A) on the same view the panel is gathered once.
+ *
+ * \param TransA whether op(A) is A or A'
+ * \param TransB whether op(B) is B or B'
+ * \param alpha scalar factor of the product
+ * \param A left operand
+ * \param B right operand
+ * \param beta scalar factor of C
+ * \param C output matrix, with leading dimension ldc
+ * \param ldc leading dimension of C
+ */
+template<typename T>
+void gemm(const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE TransB, const T alpha,
+          const MatrixView<T>& A, const MatrixView<T>& B, const T beta, T* C, const int ldc)
+{
+    const bool transA = (TransA != CblasNoTrans);
+    const bool transB = (TransB != CblasNoTrans);
+
+    const unsigned long M = transA? A.cols(): A.rows();
+    const unsigned long K = transA? A.rows(): A.cols();
+    const unsigned long N = transB? B.rows(): B.cols();
+
+    if((transB? B.cols(): B.rows()) != K)
+        throw gException(Exception_Inconsistent_Size);
+
+    if(M == 0 || N == 0)
+        return;
+
+    if(K == 0 || (A.isStrided() && B.isStrided()))
+    {
+        gemm(TransA, TransB, (int)M, (int)N, (int)K, alpha, A.getData(), std::max(1, (int)A.ld()),
+             B.getData(), std::max(1, (int)B.ld()), beta, C, ldc);
+        return;
+    }
+
+    // panels of at least 64 columns, of at most about 2^20 elements otherwise
+    const unsigned long panel = std::min(K, std::max(64ul, (1ul << 20)/std::max(M, N)));
+    const bool shared = (A == B) && (transA != transB);
+
+    T* bufA = A.isStrided()? NULL: alloc_buffer<T>(M*panel);
+    T* bufB = (B.isStrided() || shared)? NULL: alloc_buffer<T>(N*panel);
+
+    for(unsigned long k0 = 0; k0 < K; k0 += panel)
+    {
+        const unsigned long kb = std::min(panel, K-k0);
+
+        const MatrixView<T> pA = transA? A.block(k0, kb, 0, M): A.block(0, M, k0, kb);
+        const MatrixView<T> pB = transB? B.block(0, N, k0, kb): B.block(k0, kb, 0, N);
+
+        const T* a = pA.getData();
+        int lda = (int)pA.ld();
+        if(bufA != NULL)
+        {
+            lda = (int)pA.rows();
+            pA.gather(bufA, lda);
+            a = bufA;
+        }
+
+        const T* b = pB.getData();
+        int ldb = (int)pB.ld();
+        if(shared)
+        {
+            b = a;
+            ldb = lda;
+        }
+        else if(bufB != NULL)
+        {
+            ldb = (int)pB.rows();
+            pB.gather(bufB, ldb);
+            b = bufB;
+        }
+
+        gemm(TransA, TransB, (int)M, (int)N, (int)kb, alpha, a, std::max(1, lda), b, std::max(1, ldb),
+             (k0 == 0)? beta: (T)1.0, C, ldc);
+    }
+
+    free_buffer(bufA);
+    free_buffer(bufB);
+}
+
+}
+
+#endif // _GURLS_MATRIXVIEW_H_
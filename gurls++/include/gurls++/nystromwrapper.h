@@ -44,6 +44,8 @@
 
 #include "gurls++/wrapper.h"
 
+#include <vector>
+
 namespace gurls
 {
 
@@ -61,6 +63,8 @@ template<typename T>
 class NystromWrapper: public KernelWrapper<T>
 {
 public:
+    enum LandmarkSelection{UNIFORM, LEVERAGE, KMEANSPP};  ///< Strategies for the selection of the landmarks
+
     /**
       * Constructor
       *
@@ -93,7 +97,10 @@ public:
     gMat2D<T>* eval(const gMat2D<T> &X);
 
     /**
-      * Estimates label for an input matrix, optimized for large_scale data
+      * Estimates label for an input matrix, optimized for large_scale data:
+      * X is processed in blocks of rows, so that the whole test kernel matrix is never stored.
+      * The rbf and linear kernels are computed with one GEMM per block; the blocks of the
+      * other kernels are evaluated as in eval()
       *
       * \param[in] X Input matrix
       * \returns Matrix of predicted labels
@@ -106,10 +113,86 @@ public:
       */
     void setParam(double value);
 
+    /**
+      * Sets the number of rows of X processed at a time by eval_largescale()
+      */
+    void setEvalBlockSize(unsigned long value);
+
+    /**
+      * Sets the strategy used to select the landmarks:
+      * - UNIFORM: uniform sampling (default)
+      * - LEVERAGE: sampling with probabilities proportional to approximate ridge leverage scores,
+      *   computed by recursive uniform subsampling
+      * - KMEANSPP: k-means++ seeding in the feature space of the kernel
+      *
+      * LEVERAGE and KMEANSPP support only the rbf and linear kernels: training with another
+      * kernel throws gException.
+      */
+    void setLandmarkSelection(LandmarkSelection value);
+
+    /**
+      * Sets the seed of the random generator used by the LEVERAGE and KMEANSPP landmark selections
+      */
+    void setLandmarkSeed(unsigned long value);
+
 //    void rescale(gMat2D<T> &y);
 
 protected:
-    unsigned long *getIndices(const gMat2D<T>&y, const unsigned long n, const unsigned long t, const unsigned long n_nystrom, unsigned long &length);
+    /**
+      * Extends the upper Cholesky factor R of K(:,1:i0)'*K(:,1:i0) to K(:,1:i0+nb)'*K(:,1:i0+nb),
+      * and the solution z of R'*z = K(:,1:i0)'*y accordingly.
+      * Numerically dependent landmarks are dropped from the factorization.
+      *
+      * \param R factor with leading dimension ldr. On entry R(1:i0,i0+1:i0+nb) contains K(:,1:i0)'*Kb
+      * and the upper triangle of R(i0+1:i0+nb,i0+1:i0+nb) contains Kb'*Kb, Kb being the new kernel columns
+      * \param ldr leading dimension of R and z
+      * \param i0 number of landmarks already in the factor
+      * \param nb number of new landmarks
+      * \param z on entry z(i0+1:i0+nb,:) contains Kb'*y
+      * \param t number of columns of z
+      * \param dropped flags of the dropped landmarks, updated for the new ones
+      */
+    void extendFactor(T* R, const unsigned long ldr, const unsigned long i0, const unsigned long nb,
+                      T* z, const unsigned long t, std::vector<bool> &dropped);
+
+    /**
+      * Throws gException if the landmark selection strategy does not support the kernel type
+      */
+    void checkLandmarkSelection() const;
+
+    /**
+      * Returns a permutation of the n training samples, whose first n_nystrom elements are the landmarks
+      */
+    unsigned long *getIndices(const gMat2D<T>&X, const gMat2D<T>&y, const unsigned long n, const unsigned long t, const unsigned long n_nystrom, unsigned long &length);
+
+    /**
+      * Computes the kernel matrix K (na-by-nb) between the rows of XA and XB, given their squared norms nA and nB
+      */
+    void landmarkKernel(const T* XA, const unsigned long na, const T* nA,
+                        const T* XB, const unsigned long nb, const T* nB,
+                        const unsigned long d, T* K);
+
+    /**
+      * Approximates the lambda-ridge leverage scores tau of the samples idx, using the Nystrom
+      * approximation given by the samples S, drawn with probabilities p
+      */
+    void ridgeLeverage(const T* X, const unsigned long n, const unsigned long d, const T* xn,
+                       const unsigned long* S, const T* p, const unsigned long ns,
+                       const unsigned long* idx, const unsigned long nl, const T lambda, T* tau);
+
+    /**
+      * Computes approximate ridge leverage scores of all the rows of X by recursive sampling
+      * (Musco and Musco, 2017), with about s samples at each level
+      */
+    void leverageScores(const gMat2D<T> &X, const unsigned long s, T* scores);
+
+    /**
+      * Selects k rows of X by k-means++ seeding in the feature space of the kernel
+      */
+    void kmeansppSeeds(const gMat2D<T> &X, const unsigned long k, unsigned long* seeds);
+
+    LandmarkSelection lSelection;   ///< Landmark selection strategy
+    unsigned long lSeed;            ///< Seed of the landmark selection
 
 };
 
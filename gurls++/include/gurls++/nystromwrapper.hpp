@@ -14,16 +14,20 @@
 #include <boost/date_time/posix_time/posix_time_types.hpp>
 
 #include <vector>
+#include <functional>
+#include <algorithm>
 
 namespace gurls
 {
 
 template <typename T>
-NystromWrapper<T>::NystromWrapper(const std::string& name):KernelWrapper<T>(name) {}
+NystromWrapper<T>::NystromWrapper(const std::string& name):KernelWrapper<T>(name), lSelection(UNIFORM), lSeed(0) {}
 
 template <typename T>
 void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 {
+    checkLandmarkSelection();
+
     GurlsOptionsList *opt = this->opt;
     const bool regression = (this->probType == GurlsWrapper<T>::REGRESSION);
 
@@ -110,10 +114,13 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     for(unsigned long i = guesses_end-1, count = 0; count < nparams; i-=step, ++count)
         guesses.push_back(i);
 
+    // the factor is extended block by block, hence the ranks are visited in increasing order
+    std::reverse(guesses.begin(), guesses.end());
+
 
 //    indices = randperm(ntr);
     unsigned long indices_length = 0;
-    unsigned long *indices = getIndices(y, ntr, t, guesses_end, indices_length);
+    unsigned long *indices = getIndices(*Xtr, *ytr, ntr, t, guesses_end, indices_length);
 
 
 
@@ -141,10 +148,12 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     set(Xsub, (T)0.0, guesses_end*d);
 
 //    K = zeros(ntr,guesses(end));
-//    Ktrva = zeros(nva,guesses(end));
+//    W = zeros(nva,guesses(end));
+//    predva = zeros(nva,T);
     gMat2D<T>* K_mat = NULL;
     T *K = NULL;
-    T* Ktrva = NULL;
+    T* W = NULL;
+    T* predva = NULL;
 
     if(split)
     {
@@ -152,13 +161,22 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
         K = K_mat->getData();
         set(K, (T)0.0, ntr*guesses_end);
 
-        Ktrva = new T[nva*guesses_end];
-        set(Ktrva, (T)0.0, nva*guesses_end);
+        W = new T[nva*guesses_end];
+        set(W, (T)0.0, nva*guesses_end);
+
+        predva = new T[nva*t];
+        set(predva, (T)0.0, nva*t);
     }
 
-//    KtK = zeros(guesses(end),guesses(end));
-    T* KtK = new T[guesses_end*guesses_end];
-    set(KtK, (T)0.0, guesses_end*guesses_end);
+//    R = zeros(guesses(end),guesses(end));
+//    z = zeros(guesses(end),T);
+    T* R = new T[guesses_end*guesses_end];
+    set(R, (T)0.0, guesses_end*guesses_end);
+
+    T* z = new T[guesses_end*t];
+    set(z, (T)0.0, guesses_end*t);
+
+    std::vector<bool> dropped(guesses_end, false);
 
 //    i_init = 1;
     unsigned long i_init = 0;
@@ -180,9 +198,6 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 
     PredKernelTrainTest<T> predKernelTask;
 
-    gMat2D<T> *alpha_mat = new gMat2D<T>(guesses_end, t);
-    T *const alpha = alpha_mat->getData();
-
     gMat2D<unsigned long> *guesses_mat = new gMat2D<unsigned long>(guesses.size(), 1);
     unsigned long *guesses_mat_it = guesses_mat->getData();
     set(guesses_mat_it, 0ul, guesses.size());
@@ -190,6 +205,7 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     boost::posix_time::ptime begin, end;
     boost::posix_time::time_duration diff;
 
+    unsigned long nsub = 0;
     T prevPerf = (regression)? -std::numeric_limits<T>::max(): 0;
 
     begin = boost::posix_time::microsec_clock::local_time();
@@ -230,74 +246,47 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
         }
 
 
-//        KtK(i_init:i_end,i_init:i_end) = kernel.K'*kernel.K;
-        T* KtK_sub = new T[nindices*nindices];
-
-        dot(predkernel_K.getData(), predkernel_K.getData(), KtK_sub, ntr, nindices, ntr, nindices, nindices, nindices, CblasTrans, CblasNoTrans, CblasColMajor);
-        for(unsigned long i=0; i< nindices; ++i)
-            copy(KtK+i_init+((i_init+i)*guesses_end), KtK_sub+(i*nindices), nindices);
-
-        delete[] KtK_sub;
-
-
-//        if guesses_c>1
-        if(it != guesses.begin())
-        {
-//            KtKcol = K(:,1:(i_init-1))'*kernel.K;
-            T *KtKcol = new T[i_init*nindices];
-            dot(K, predkernel_K.getData(), KtKcol, ntr, i_init, ntr, nindices, i_init, nindices, CblasTrans, CblasNoTrans, CblasColMajor);
-
-//            KtK(1:(i_init-1),i_init:i_end) = KtKcol;
-//            KtK(i_init:i_end,1:(i_init-1)) = KtKcol';
-            for(unsigned long j=0; j<nindices; ++j)
-            {
-                copy(KtK+(guesses_end*(i_init+j)), KtKcol+(i_init*j), i_init);
-                copy(KtK+i_init+j, KtKcol+(i_init*j), i_init, guesses_end, 1);
-            }
-
-            delete [] KtKcol;
-        }
-
         delete kernel;
 
-//        alpha = pinv(KtK(1:i_end,1:i_end))*(K(:,1:i_end)'*ytr);
-
-        const unsigned long ii = i+1;
-
-
-        KtK_sub = new T[ ii*ii];
-        for(T *K_it = KtK, *Ks_it = KtK_sub, *const K_end = K_it+(guesses_end*ii); K_it != K_end; K_it+=guesses_end, Ks_it+=ii)
-            copy(Ks_it, K_it, ii);
-
-        int r, c;
-        T *pinv_K = pinv(KtK_sub, ii, ii, r, c);
-        delete [] KtK_sub;
+        const T* Kb = K+(ntr*i_init);
+        T* R12 = R+(guesses_end*i_init);
+        T* zb = z+i_init;
 
-        T *Kty = new T[ii*t];
-        dot(K, ytr->getData(), Kty, ntr, ii, ntr, t, ii, t, CblasTrans, CblasNoTrans, CblasColMajor);
+//        R(i_init:i_end,i_init:i_end) = Kb'*Kb;
+//        R(1:(i_init-1),i_init:i_end) = K(:,1:(i_init-1))'*Kb;
+//        z(i_init:i_end,:) = Kb'*ytr;
+        syrk(CblasUpper, CblasTrans, nindices, ntr, (T)1.0, Kb, ntr, (T)0.0, R12+i_init, guesses_end);
+        if(i_init > 0)
+            gemm(CblasTrans, CblasNoTrans, i_init, nindices, ntr, (T)1.0, K, ntr, Kb, ntr, (T)0.0, R12, guesses_end);
+        gemm(CblasTrans, CblasNoTrans, nindices, t, ntr, (T)1.0, Kb, ntr, ytr->getData(), ntr, (T)0.0, zb, guesses_end);
 
+        extendFactor(R, guesses_end, i_init, nindices, z, t, dropped);
 
-        dot(pinv_K, Kty, alpha, ii, ii, ii, t, ii, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
-
-        delete [] Kty;
-        delete [] pinv_K;
-
+        nsub = i+1;
 
         if(split)
         {
     //        validation error
     //        kernel = predkernel_traintest(Xva,[],opt_tmp);
             kernel = predKernelTask.execute(*Xva, empty, *opt_tmp);
-
-    //        Ktrva(:,i_init:i_end) = kernel.K;
             const gMat2D<T> &predkernel_Kva = kernel->getOptValue<OptMatrix<gMat2D<T> > >("K");
-            copy(Ktrva+(nva*i_init), predkernel_Kva.getData(), predkernel_Kva.getSize());
+
+    //        Kva*alpha = Kva/R*z, and the leading columns of W = Kva/R do not change when R grows
+    //        W(:,i_init:i_end) = (kernel.K - W(:,1:(i_init-1))*R12)/R22;
+            T* Wb = W+(nva*i_init);
+            copy(Wb, predkernel_Kva.getData(), nva*nindices);
             delete kernel;
 
+            if(i_init > 0)
+                gemm(CblasNoTrans, CblasNoTrans, nva, nindices, i_init, (T)-1.0, W, nva, R12, guesses_end, (T)1.0, Wb, nva);
+            trsm(CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, nva, nindices, (T)1.0, R12+i_init, guesses_end, Wb, nva);
 
-    //        opt.pred = Ktrva(:,1:i_end)*alpha;
+    //        predva = predva + W(:,i_init:i_end)*z(i_init:i_end,:);
+            gemm(CblasNoTrans, CblasNoTrans, nva, t, nindices, (T)1.0, Wb, nva, zb, guesses_end, (T)1.0, predva, nva);
+
+    //        opt.pred = predva;
             gMat2D<T>* pred = new gMat2D<T>(nva ,t);
-            dot(Ktrva, alpha, pred->getData(), nva, ii, ii, t, nva, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
+            copy(pred->getData(), predva, nva*t);
             opt->addOpt("pred", new OptMatrix<gMat2D<T> >(*pred));
 
     //        perf = opt.hoperf([],yva,opt);
@@ -347,23 +336,29 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
         delete Xva;
         delete yva;
 
-        delete [] Ktrva;
+        delete [] W;
+        delete [] predva;
     }
 
     delete K_mat;
 
     delete [] indices;
-    delete [] KtK;
 
     delete perfTask;
     delete opt_tmp;
 
+//    alpha = R(1:i_end,1:i_end)\z(1:i_end,:);
+    gMat2D<T> *alpha_mat = new gMat2D<T>(nsub, t);
+    T *const alpha = alpha_mat->getData();
+    for(unsigned long j=0; j<t; ++j)
+        copy(alpha+(nsub*j), z+(guesses_end*j), nsub);
+    trsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, nsub, t, (T)1.0, R, guesses_end, alpha, nsub);
 
-    unsigned long nsub;
+    delete [] R;
+    delete [] z;
 
-    if(guesses_mat_it - guesses_mat->getData() < guesses_mat->getSize()-1)
+    if(nsub < guesses_end)
     {
-        nsub = *guesses_mat_it;
         gMat2D<T> *Xsub_mat_sub = new gMat2D<T>(nsub, d);
 
         const unsigned long size = nsub*d;
@@ -374,8 +369,6 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
         delete Xsub_mat;
         Xsub_mat = Xsub_mat_sub;
     }
-    else
-        nsub = guesses_end;
 
 
 //    vout.X = Xsub(1:i_end,:);
@@ -395,6 +388,8 @@ void NystromWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 template <typename T>
 void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
 {
+    checkLandmarkSelection();
+
     GurlsOptionsList *opt = this->opt;
 
     GurlsOptionsList* paramsel = opt->getOptAs<GurlsOptionsList>("paramsel");
@@ -436,7 +431,7 @@ void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
 
 //    indices = randperm(ntr);
     unsigned long indices_length = 0;
-    unsigned long *indices = getIndices(y, ntr, t, guesses_end, indices_length);
+    unsigned long *indices = getIndices(*Xtr, *ytr, ntr, t, guesses_end, indices_length);
 
 
 
@@ -457,13 +452,15 @@ void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
     T *Xsub = Xsub_mat->getData();
     set(Xsub, (T)0.0, guesses_end*d);
 
-//    KtK = zeros(guesses(end),guesses(end));
-    T *KtK = new T[guesses_end*guesses_end];
-    set(KtK, (T)0.0, guesses_end*guesses_end);
+//    R = zeros(guesses(end),guesses(end));
+    T *R = new T[guesses_end*guesses_end];
+    set(R, (T)0.0, guesses_end*guesses_end);
+
+//    z = zeros(guesses(end),T);
+    T *z = new T[guesses_end*t];
+    set(z, (T)0.0, guesses_end*t);
 
-    //    Kty = zeros(guesses(end),T);
-    T *Kty = new T[guesses_end*t];
-    set(Kty, (T)0.0, guesses_end*t);
+    std::vector<bool> dropped(guesses_end, false);
 
 //    i_init = 1;
     unsigned long i_init = 0;
@@ -487,9 +484,6 @@ void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
 
     PredKernelTrainTest<T> predKernelTask;
 
-    gMat2D<T> *alpha_mat = new gMat2D<T>(guesses_end, t);
-    T *const alpha = alpha_mat->getData();
-
     gMat2D<unsigned long> *guesses_mat = new gMat2D<unsigned long>(guesses.size(), 1);
     unsigned long *guesses_mat_it = guesses_mat->getData();
     set(guesses_mat_it, 0ul, guesses.size());
@@ -516,30 +510,21 @@ void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
 
         gMat2D<T> &predkernel_K = kernel->getOptValue<OptMatrix<gMat2D<T> > >("K");
 
-//        Kty(i_init:i_end,:) = kernel_col.K'*y;
-        T* Kty_sub = new T[nindices*t];
-        dot(predkernel_K.getData(), ytr->getData(), Kty_sub, ntr, nindices, ntr, t, nindices, t, CblasTrans, CblasNoTrans, CblasColMajor);
-        for(unsigned long i=0; i< t; ++i)
-            copy(Kty+i_init+(i*guesses_end), Kty_sub+(i*nindices), nindices);
-
-        delete [] Kty_sub;
+        T* R12 = R+(guesses_end*i_init);
 
-//        KtK(i_init:i_end,i_init:i_end) = kernel_col.K'*kernel_col.K;
-        T* KtK_sub = new T[nindices*nindices];
-
-        dot(predkernel_K.getData(), predkernel_K.getData(), KtK_sub, ntr, nindices, ntr, nindices, nindices, nindices, CblasTrans, CblasNoTrans, CblasColMajor);
-        for(unsigned long i=0; i< nindices; ++i)
-            copy(KtK+i_init+((i_init+i)*guesses_end), KtK_sub+(i*nindices), nindices);
-
-        delete[] KtK_sub;
+//        z(i_init:i_end,:) = kernel_col.K'*y;
+        gemm(CblasTrans, CblasNoTrans, nindices, t, ntr, (T)1.0, predkernel_K.getData(), ntr, ytr->getData(), ntr, (T)0.0, z+i_init, guesses_end);
 
+//        R(i_init:i_end,i_init:i_end) = kernel_col.K'*kernel_col.K;
+        syrk(CblasUpper, CblasTrans, nindices, ntr, (T)1.0, predkernel_K.getData(), ntr, (T)0.0, R12+i_init, guesses_end);
 
 //        if guesses_c>1
         if(it != guesses.begin())
         {
 //            KtKcol = zeros((i_init-1),i_end-i_init+1);
-            T *KtKcol = new T[i_init*nindices];
-            set(KtKcol, (T)0.0, i_init*nindices);
+            T *KtKcol = R12;
+            for(unsigned long j=0; j<nindices; ++j)
+                set(KtKcol+(guesses_end*j), (T)0.0, i_init);
 
 
             const T salpha = (T)(-1.0/pow(sigma, 2));
@@ -560,47 +545,16 @@ void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
                 exp(kernel_old, i_init);
 
 //                KtKcol = KtKcol + kernel_old.K'*kernel_col.K(l,:);
-                gemv(CblasNoTrans, i_init, 1, one, kernel_old, i_init, K_it, ntr, one, KtKcol, 1); // 1 i_init   1 nindices  i_init nindices
+                gemm(CblasNoTrans, CblasNoTrans, i_init, nindices, 1, one, kernel_old, i_init, K_it, ntr, one, KtKcol, guesses_end);
             }
 
             delete [] kernel_old;
-
-
-//            KtK(1:(i_init-1),i_init:i_end) = KtKcol;
-//            KtK(i_init:i_end,1:(i_init-1)) = KtKcol';
-            for(unsigned long j=0; j<nindices; ++j)
-            {
-                copy(KtK+(guesses_end*(i_init+j)), KtKcol+(i_init*j), i_init);
-                copy(KtK+i_init+j, KtKcol+(i_init*j), i_init, guesses_end, 1);
-            }
-
-            delete [] KtKcol;
         }
 
         delete kernel;
 
-
-//        alpha = pinv(KtK(1:i_end,1:i_end))*(Kty(1:i_end,:));
-
-        const unsigned long ii = i+1;
-
-        KtK_sub = new T[ ii*ii];
-        for(T *K_it = KtK, *Ks_it = KtK_sub, *const K_end = K_it+(guesses_end*ii); K_it != K_end; K_it+=guesses_end, Ks_it+=ii)
-            copy(Ks_it, K_it, ii);
-
-        int r, c;
-        T *pinv_K = pinv(KtK_sub, ii, ii, r, c);
-        delete [] KtK_sub;
-
-        Kty_sub = new T[ii*t];
-        for(T *K_it = Kty, *Ks_it = Kty_sub, *const K_end = K_it+(guesses_end*t); K_it != K_end; K_it+=guesses_end, Ks_it+=ii)
-            copy(Ks_it, K_it, ii);
-
-
-        dot(pinv_K, Kty_sub, alpha, ii, ii, ii, t, ii, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
-
-        delete [] Kty_sub;
-        delete [] pinv_K;
+//        R = chol(KtK(1:i_end,1:i_end)), extended with the new block of landmarks
+        extendFactor(R, guesses_end, i_init, nindices, z, t, dropped);
 
 
         tmp_optimizer->removeOpt("X");
@@ -625,11 +579,19 @@ void NystromWrapper<T>::train_largescale(const gMat2D<T> &X, const gMat2D<T> &y)
 
 
     delete [] indices;
-    delete [] KtK;
-    delete [] Kty;
 
     delete opt_tmp;
 
+//    alpha = R\z;
+    gMat2D<T> *alpha_mat = new gMat2D<T>(guesses_end, t);
+    T *const alpha = alpha_mat->getData();
+    for(unsigned long j=0; j<t; ++j)
+        copy(alpha+(guesses_end*j), z+(guesses_end*j), guesses_end);
+    trsm(CblasLeft, CblasUpper, CblasNoTrans, CblasNonUnit, guesses_end, t, (T)1.0, R, guesses_end, alpha, guesses_end);
+
+    delete [] R;
+    delete [] z;
+
 
 //    vout.X = Xsub(1:i_end,:);
     paramsel->addOpt("X", new OptMatrix<gMat2D<T> >(*Xsub_mat));
@@ -694,59 +656,68 @@ template <typename T>
 gMat2D<T>* NystromWrapper<T>::eval_largescale(const gMat2D<T> &X)
 {
     GurlsOptionsList *opt = this->opt;
-    const gMat2D<T> &alpha_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.alpha");
+    const gMat2D<T> &alpha_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.C");
     const gMat2D<T> &X_mat = opt->getOptValue<OptMatrix<gMat2D<T> > >("paramsel.X");
-    const T *const alpha = alpha_mat.getData();
 
     const unsigned long n = X.rows();
     const unsigned long d = X.cols();
     const unsigned long t = alpha_mat.cols();
     const unsigned long n_nystrom = X_mat.rows();
 
-    gMat2D<T> Xi_mat(1, d);
-    T* yi = new T[t];
-    T* const Xi = Xi_mat.getData();
+    if(X_mat.cols() != d)
+        throw gException(Exception_Inconsistent_Size);
 
-    gMat2D<T> *y_mat = new gMat2D<T>(n, t);
-    T* y_it = y_mat->getData();
+    const unsigned long blocksize = opt->hasOpt("evalblocksize")?
+                static_cast<unsigned long>(opt->getOptAsNumber("evalblocksize")) : predict_kernel_blocksize(n_nystrom);
 
-    GurlsOptionsList* opt_tmp = new GurlsOptionsList("tmp");
-    GurlsOptionsList* tmp_kernel = new GurlsOptionsList("kernel");
-    GurlsOptionsList* tmp_paramsel = new GurlsOptionsList("paramsel");
-    GurlsOptionsList* tmp_optimizer = new GurlsOptionsList("optimizer");
+    const std::string kernelType = opt->getOptAsString("kernel.type");
 
-    opt_tmp->addOpt("kernel", tmp_kernel);
-    opt_tmp->addOpt("paramsel", tmp_paramsel);
-    opt_tmp->addOpt("optimizer", tmp_optimizer);
+    if(kernelType == "rbf" || kernelType == "linear")
+    {
+        gMat2D<T> *y_mat = new gMat2D<T>(n, t);
 
-    tmp_kernel->addOpt("type", opt->getOptAsString("kernel.type"));
-    tmp_paramsel->addOpt("sigma", new OptNumber(opt->getOptAsNumber("sigma")));
-    tmp_optimizer->addOpt("X", opt->getOpt("paramsel.X"));
+        predict_kernel_blocked(kernelType, X.getData(), n, d, X_mat.getData(), n_nystrom,
+                               alpha_mat.getData(), t, opt->getOptAsNumber("paramsel.sigma"), y_mat->getData(), blocksize);
 
+        return y_mat;
+    }
 
-    PredKernelTrainTest<T> predKernelTask;
-    const gMat2D<T> empty;
+    // other kernels: the predictions of each block of rows are computed by eval()
+    gMat2D<T> *y_mat = new gMat2D<T>(n, t);
+    const unsigned long nb_max = std::max(1ul, std::min(blocksize, n));
+    gMat2D<T> Xb(nb_max, d);
 
-    for(int i=0; i<n; ++i, ++y_it)
+    for(unsigned long i0=0; i0<n; i0+=nb_max)
     {
-        getRow(X.getData(), n, d, i, Xi);
+        const unsigned long nb = std::min(nb_max, n-i0);
+        if(nb != Xb.rows())
+            Xb.resize(nb, d);
 
-        GurlsOptionsList *predKernel = predKernelTask.execute(Xi_mat, empty, *opt_tmp);
-        const gMat2D<T> &predKernel_K = predKernel->getOptValue<OptMatrix<gMat2D<T> > >("K");
+        //  Xb = X(i0:i0+nb-1,:);
+        for(unsigned long j=0; j<d; ++j)
+            copy(Xb.getData()+j*nb, X.getData()+i0+j*n, nb);
 
-        dot(predKernel_K.getData(), alpha, yi, 1, n_nystrom, n_nystrom, t, 1, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
-        copy(y_it, yi, t, n, 1);
+        gMat2D<T> *yb = eval(Xb);
 
-        delete predKernel;
-    }
+        //  y(i0:i0+nb-1,:) = yb;
+        for(unsigned long j=0; j<t; ++j)
+            copy(y_mat->getData()+i0+j*n, yb->getData()+j*nb, nb);
 
-    tmp_optimizer->removeOpt("X", false);
-    delete opt_tmp;
-    delete [] yi;
+        delete yb;
+    }
 
     return y_mat;
 }
 
+template <typename T>
+void NystromWrapper<T>::setEvalBlockSize(unsigned long value)
+{
+    if(this->opt->hasOpt("evalblocksize"))
+        this->opt->template getOptValue<OptNumber>("evalblocksize") = value;
+    else
+        this->opt->addOpt("evalblocksize", new OptNumber(value));
+}
+
 template <typename T>
 void NystromWrapper<T>::setParam(double value)
 {
@@ -814,13 +785,330 @@ void NystromWrapper<T>::setParam(double value)
 //}
 
 template <typename T>
-unsigned long* NystromWrapper<T>::getIndices(const gMat2D<T>&y, const unsigned long n, const unsigned long t, const unsigned long n_nystrom, unsigned long &length)
+void NystromWrapper<T>::extendFactor(T* R, const unsigned long ldr, const unsigned long i0, const unsigned long nb,
+                                     T* z, const unsigned long t, std::vector<bool> &dropped)
 {
-    unsigned long *indices = new unsigned long[n];
-    randperm(n, indices, true, 0);
+    T* R12 = R+(ldr*i0);
+    T* R22 = R12+i0;
+    T* zb = z+i0;
+
+    // a landmark is dropped when the part of its kernel column that is not explained
+    // by the previous landmarks is negligible: its row and column of R are set to the
+    // identity and its coefficient to zero, which is the basic least squares solution
+    const T tol = static_cast<T>(ldr)*std::numeric_limits<T>::epsilon();
+
+    T* colnorms = new T[nb];
+    copy(colnorms, R22, nb, 1, ldr+1);
 
+    if(i0 > 0)
+    {
+//        R12 = R11'\R12;
+        trsm(CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, i0, nb, (T)1.0, R, ldr, R12, ldr);
+        for(unsigned long l=0; l<i0; ++l)
+            if(dropped[l])
+                set(R12+l, (T)0.0, nb, ldr);
+
+//        R22 = R22 - R12'*R12;
+        syrk(CblasUpper, CblasTrans, nb, i0, (T)-1.0, R12, ldr, (T)1.0, R22, ldr);
+
+//        zb = zb - R12'*z(1:i0-1,:);
+        gemm(CblasTrans, CblasNoTrans, nb, t, i0, (T)-1.0, R12, ldr, z, ldr, (T)1.0, zb, ldr);
+    }
+
+//    R22 = chol(R22);
+    for(unsigned long j=0; j<nb; ++j)
+    {
+        T* Rj = R22+(ldr*j);
+        const T djj = Rj[j];
+
+        if(!(djj > tol*colnorms[j]))
+        {
+            dropped[i0+j] = true;
+            set(R12+(ldr*j), (T)0.0, i0+j);
+            set(R22+j, (T)0.0, nb-j, ldr);
+            Rj[j] = (T)1.0;
+            continue;
+        }
+
+        const T rjj = std::sqrt(djj);
+        Rj[j] = rjj;
+        scal(nb-j-1, (T)1.0/rjj, Rj+ldr+j, ldr);
+
+        for(unsigned long k=j+1; k<nb; ++k)
+        {
+            const T rjk = R22[j+(ldr*k)];
+            axpy(k-j, -rjk, R22+j+(ldr*(j+1)), ldr, R22+(j+1)+(ldr*k), 1);
+        }
+    }
+
+    delete [] colnorms;
+
+//    zb = R22'\zb;
+    trsm(CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, nb, t, (T)1.0, R22, ldr, zb, ldr);
+    for(unsigned long j=0; j<nb; ++j)
+        if(dropped[i0+j])
+            set(zb+j, (T)0.0, t, ldr);
+}
+
+template <typename T>
+void NystromWrapper<T>::setLandmarkSelection(LandmarkSelection value)
+{
+    lSelection = value;
+}
+
+template <typename T>
+void NystromWrapper<T>::setLandmarkSeed(unsigned long value)
+{
+    lSeed = value;
+}
+
+template <typename T>
+void NystromWrapper<T>::checkLandmarkSelection() const
+{
+    if(lSelection == UNIFORM)
+        return;
+
+    const std::string kernelType = this->opt->getOptAsString("kernel.type");
+    if(kernelType != "rbf" && kernelType != "linear")
+        throw gException("The LEVERAGE and KMEANSPP landmark selections support only the rbf and linear kernels, not " + kernelType);
+}
+
+template <typename T>
+unsigned long* NystromWrapper<T>::getIndices(const gMat2D<T>&X, const gMat2D<T>&y, const unsigned long n, const unsigned long t, const unsigned long n_nystrom, unsigned long &length)
+{
+    unsigned long *indices = new unsigned long[n];
     length = n;
+
+    const unsigned long k = std::min(n_nystrom, n);
+
+    switch(lSelection)
+    {
+    case UNIFORM:
+        randperm(n, indices, true, 0);
+        return indices;
+
+    case LEVERAGE:
+    {
+        // weighted sampling without replacement: the k largest keys log(u)/score
+        T* scores = new T[n];
+        leverageScores(X, k, scores);
+
+#if   BOOST_VERSION < 104700
+        boost::mt19937 gen(static_cast<boost::uint32_t>(lSeed+1));
+#else
+        boost::random::mt19937 gen(static_cast<boost::uint32_t>(lSeed+1));
+#endif
+        std::vector<std::pair<T, unsigned long> > keys(n);
+        for(unsigned long i=0; i<n; ++i)
+        {
+            const T u = (static_cast<T>(gen())+(T)0.5)/(T)4294967296.0;
+            keys[i] = std::make_pair(std::log(u)/std::max(scores[i], std::numeric_limits<T>::min()), i);
+        }
+        delete [] scores;
+
+        std::partial_sort(keys.begin(), keys.begin()+k, keys.end(), std::greater<std::pair<T, unsigned long> >());
+        for(unsigned long i=0; i<k; ++i)
+            indices[i] = keys[i].second;
+        break;
+    }
+
+    case KMEANSPP:
+        kmeansppSeeds(X, k, indices);
+        break;
+    }
+
+    // the samples that are not landmarks follow in their original order
+    std::vector<bool> chosen(n, false);
+    for(unsigned long i=0; i<k; ++i)
+        chosen[indices[i]] = true;
+
+    for(unsigned long i=0, j=k; i<n; ++i)
+        if(!chosen[i])
+            indices[j++] = i;
+
     return indices;
 }
 
+template <typename T>
+void NystromWrapper<T>::landmarkKernel(const T* XA, const unsigned long na, const T* nA,
+                                       const T* XB, const unsigned long nb, const T* nB,
+                                       const unsigned long d, T* K)
+{
+    const std::string kernelType = this->opt->getOptAsString("kernel.type");
+    const double sigma = (kernelType == "rbf")? this->opt->getOptAsNumber("paramsel.sigma"): 1.0;
+
+    kernel_block(kernelType, sigma, XA, na, na, nA, XB, nb, nb, nB, d, K, na);
+}
+
+template <typename T>
+void NystromWrapper<T>::ridgeLeverage(const T* X, const unsigned long n, const unsigned long d, const T* xn,
+                                      const unsigned long* S, const T* p, const unsigned long ns,
+                                      const unsigned long* idx, const unsigned long nl, const T lambda, T* tau)
+{
+    const bool linear = (this->opt->getOptAsString("kernel.type") == "linear");
+
+    //  XS = X(S,:);
+    T* XS = new T[ns*d];
+    T* nS = new T[ns];
+    subMatrixFromRows(X, n, d, S, ns, XS);
+    for(unsigned long j=0; j<ns; ++j)
+        nS[j] = xn[S[j]];
+
+    //  R = chol(K(S,S) + lambda*diag(p));
+    T* KSS = new T[ns*ns];
+    landmarkKernel(XS, ns, nS, XS, ns, nS, d, KSS);
+    for(unsigned long j=0; j<ns; ++j)
+        KSS[j*(ns+1)] += lambda*p[j];
+
+    T* R = new T[ns*ns];
+    cholesky(KSS, ns, ns, R);
+    delete [] KSS;
+
+    //  tau = (diag(K(idx,idx)) - sum((R'\K(S,idx)).^2, 1)')/lambda;
+    const unsigned long blocksize = std::min(nl, predict_kernel_blocksize(ns));
+    const long nblocks = static_cast<long>((nl+blocksize-1)/blocksize);
+
+#pragma omp parallel
+    {
+        // allocated on the first block of the thread
+        T* Xb = NULL;
+        T* nb_ = NULL;
+        T* K = NULL;
+
+#pragma omp for schedule(dynamic)
+        for(long b=0; b<nblocks; ++b)
+        {
+            const unsigned long i0 = b*blocksize;
+            const unsigned long nb = std::min(blocksize, nl-i0);
+
+            if(K == NULL)
+            {
+                Xb = new T[blocksize*d];
+                nb_ = new T[blocksize];
+                K = new T[ns*blocksize];
+            }
+
+            subMatrixFromRows(X, n, d, idx+i0, nb, Xb);
+            for(unsigned long i=0; i<nb; ++i)
+                nb_[i] = xn[idx[i0+i]];
+
+            landmarkKernel(XS, ns, nS, Xb, nb, nb_, d, K);
+            trsm(CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, ns, nb, (T)1.0, R, ns, K, ns);
+
+            for(unsigned long i=0; i<nb; ++i)
+            {
+                const T kii = linear? nb_[i]: (T)1.0;
+                const T res = kii - dot(ns, K+(ns*i), 1, K+(ns*i), 1);
+                tau[i0+i] = std::min((T)1.0, std::max(res/lambda, (T)0.0));
+            }
+        }
+
+        delete [] Xb;
+        delete [] nb_;
+        delete [] K;
+    }
+
+    delete [] R;
+    delete [] XS;
+    delete [] nS;
+}
+
+template <typename T>
+void NystromWrapper<T>::leverageScores(const gMat2D<T> &X, const unsigned long s, T* scores)
+{
+    const unsigned long n = X.rows();
+    const unsigned long d = X.cols();
+    const T* X_it = X.getData();
+
+    if(n <= s)
+    {
+        set(scores, (T)1.0, n);
+        return;
+    }
+
+    const bool linear = (this->opt->getOptAsString("kernel.type") == "linear");
+
+#if   BOOST_VERSION < 104700
+    boost::mt19937 gen(static_cast<boost::uint32_t>(lSeed));
+#else
+    boost::random::mt19937 gen(static_cast<boost::uint32_t>(lSeed));
+#endif
+
+    T* xn = new T[n];
+    sum_col_squared(X_it, xn, n, d);
+
+    // nested uniform subsets: level l contains the first sizes[l] elements of perm
+    std::vector<unsigned long> perm(n);
+    for(unsigned long i=0; i<n; ++i)
+        perm[i] = i;
+    for(unsigned long i=n-1; i>0; --i)
+        std::swap(perm[i], perm[gen()%(i+1)]);
+
+    std::vector<unsigned long> sizes;
+    for(unsigned long size = n; size > s; size /= 2)
+        sizes.push_back(size);
+
+    // the smallest subset is used as it is
+    std::vector<unsigned long> S(perm.begin(), perm.begin()+sizes.back()/2);
+    std::vector<T> p(S.size(), (T)1.0);
+
+    std::vector<T> tau(n);
+
+    for(long l = static_cast<long>(sizes.size())-1; l >= 0; --l)
+    {
+        const unsigned long nl = sizes[l];
+
+        // lambda is chosen so that about s samples have a large ridge leverage score
+        T trace = 0;
+        for(unsigned long i=0; i<nl; ++i)
+            trace += linear? xn[perm[i]]: (T)1.0;
+        const T lambda = std::max(trace/s, std::numeric_limits<T>::min());
+
+        ridgeLeverage(X_it, n, d, xn, &S[0], &p[0], S.size(), &perm[0], nl, lambda, &tau[0]);
+
+        if(l == 0)
+            break;
+
+        // sample the landmarks used at the next level, with probabilities proportional to tau
+        T sum = 0;
+        for(unsigned long i=0; i<nl; ++i)
+            sum += tau[i];
+
+        const T scale = (sum > 0)? s/sum: (T)0.0;
+
+        S.clear();
+        p.clear();
+        for(unsigned long i=0; i<nl; ++i)
+        {
+            const T pi = std::min((T)1.0, tau[i]*scale);
+            const T u = (static_cast<T>(gen())+(T)0.5)/(T)4294967296.0;
+            if(u < pi)
+            {
+                S.push_back(perm[i]);
+                p.push_back(pi);
+            }
+        }
+
+        if(S.empty())
+        {
+            S.assign(perm.begin(), perm.begin()+std::min(s, nl));
+            p.assign(S.size(), (T)1.0);
+        }
+    }
+
+    for(unsigned long i=0; i<n; ++i)
+        scores[perm[i]] = tau[i];
+
+    delete [] xn;
+}
+
+template <typename T>
+void NystromWrapper<T>::kmeansppSeeds(const gMat2D<T> &X, const unsigned long k, unsigned long* seeds)
+{
+    const std::string kernelType = this->opt->getOptAsString("kernel.type");
+    const double sigma = (kernelType == "rbf")? this->opt->getOptAsNumber("paramsel.sigma"): 1.0;
+
+    kmeanspp_seeds(kernelType, sigma, X.getData(), X.rows(), X.cols(), k, lSeed, seeds);
+}
+
 }
@@ -80,6 +80,9 @@ class RLSPegasos;
 template <typename T>
 class RLSGPRegr;
 
+template <typename T>
+class RLSSparseGPRegr;
+
 template <typename T>
 class RLSPrimalRecInit;
 
@@ -149,6 +152,8 @@ public:
         return new RLSPegasos<T>;
       if(id == "rlsgpregr")
         return new RLSGPRegr<T>;
+      if(id == "rlssparsegpregr")
+        return new RLSSparseGPRegr<T>;
       if(id == "rlsprimalrecinit")
         return new RLSPrimalRecInit<T>;
       if(id == "rlsprimalrecupdate")
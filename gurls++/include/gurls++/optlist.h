@@ -43,6 +43,7 @@
 #define _GURLS_OPTLIST_H_
 
 #include <iostream>
+#include <cstring>
 #include <string>
 #include <map>
 #include <vector>
@@ -65,10 +66,55 @@ namespace gurls {
 #pragma warning(disable : 4251)
 #endif
 
+/**
+  * \ingroup Settings
+  * \brief OptKey refers to the key of an option, possibly a path of nested keys
+  * separated by dots such as "optimizer.W".
+  *
+  * The key is not copied: an OptKey is built at no cost from a string literal or
+  * from a std::string, and must not outlive the referred characters.
+  */
+class OptKey
+{
+public:
+    /**
+      * Refers to a null-terminated key
+      */
+    OptKey(const char* key): data(key), length(std::strlen(key)) {}
+
+    /**
+      * Refers to the characters of a string
+      */
+    OptKey(const std::string& key): data(key.data()), length(key.size()) {}
+
+    /**
+      * Returns the first character of the key
+      */
+    const char* begin() const {return data;}
+
+    /**
+      * Returns the end of the key
+      */
+    const char* end() const {return data + length;}
+
+    /**
+      * Returns a copy of the key
+      */
+    std::string str() const {return std::string(data, length);}
+
+private:
+    const char* data;
+    std::size_t length;
+};
+
 /**
   * \ingroup Settings
   * \brief GurlsOptionsList is an option containing a list of options
   * mapped by name.
+  *
+  * Options are looked up through a hash index on the names of each list, so that
+  * resolving a path such as "paramsel.lambdas" costs one hash probe per level
+  * and allocates no memory.
   */
 class GURLS_EXPORT GurlsOptionsList: public GurlsOption
 {
@@ -111,18 +157,32 @@ public:
     /**
       * Returns a pointer to a generic option mapped with a key
       */
-    GurlsOption* getOpt(std::string key);
+    GurlsOption* getOpt(const OptKey& key);
 
     /**
       * Returns a pointer to a generic option mapped with a key
       */
-    const GurlsOption* getOpt(std::string key) const;
+    const GurlsOption* getOpt(const OptKey& key) const;
+
+    /**
+      * Returns a pointer to the option mapped with a key, or NULL if there is no such option.
+      * Unlike getOpt() no exception is thrown, hence findOpt() is the cheap way to test optional keys.
+      *
+      * The returned pointer stays valid until the option, or one of the lists containing it,
+      * is removed or deleted: callers looking up the same option many times may keep it.
+      */
+    GurlsOption* findOpt(const OptKey& key);
+
+    /**
+      * Returns a pointer to the option mapped with a key, or NULL if there is no such option
+      */
+    const GurlsOption* findOpt(const OptKey& key) const;
 
     /**
       * Returns a pointer to a T option mapped with a key
       */
     template<class T>
-    T* getOptAs(std::string key)
+    T* getOptAs(const OptKey& key)
     {
         return T::dynacast(this->getOpt(key));
     }
@@ -131,7 +191,7 @@ public:
       * Returns a pointer to a T option mapped with a key
       */
     template<class T>
-    const T* getOptAs(std::string key) const
+    const T* getOptAs(const OptKey& key) const
     {
         return T::dynacast(this->getOpt(key));
     }
@@ -140,7 +200,7 @@ public:
       * Returns a reference to the value contained into an option mapped with a key
       */
     template<class T>
-    typename T::ValueType& getOptValue(std::string key)
+    typename T::ValueType& getOptValue(const OptKey& key)
     {
         return this->getOptAs<T>(key)->getValue();
     }
@@ -149,7 +209,7 @@ public:
       * Returns a reference to the value contained into an option mapped with a key
       */
     template<class T>
-    const typename T::ValueType& getOptValue(std::string key) const
+    const typename T::ValueType& getOptValue(const OptKey& key) const
     {
         return this->getOptAs<T>(key)->getValue();
     }
@@ -157,7 +217,7 @@ public:
     /**
       * Returns a string option mapped with a key
       */
-    std::string getOptAsString(std::string key) const;
+    std::string getOptAsString(const OptKey& key) const;
 
     /**
       * Returns the list name
@@ -177,7 +237,7 @@ public:
     /**
       * Returns a numeric option mapped with a key
       */
-    double getOptAsNumber(std::string key) const;
+    double getOptAsNumber(const OptKey& key) const;
 
     /**
       * Prints the options list
@@ -187,7 +247,7 @@ public:
     /**
       * Checks if the list has an option mapped with a specified key
       */
-    bool hasOpt(std::string key) const;
+    bool hasOpt(const OptKey& key) const;
 
     /**
       * Removes the option mapped with a specified key
@@ -238,7 +298,8 @@ public:
     std::string toString();
 
     /**
-      *
+      * Adds to the list a copy of the option mapped with a key in the list \c from.
+      * Matrices are not duplicated but shared with \c from until one of the two copies is modified (see \ref OptMatrix).
       */
     void copyOpt(std::string key, const GurlsOptionsList &from);
 
@@ -254,7 +315,31 @@ public:
 
 protected:
     std::string name;   ///< Option name
-    ValueType* table;   ///< Options list, indexed by name
+
+private:
+    /**
+      * Resolves a path of keys, returning NULL or throwing an exception if an option is missing
+      */
+    GurlsOption* lookup(const OptKey& key, bool throwIfMissing) const;
+
+    /**
+      * Returns the option of this list mapped with the key [begin, end), or NULL
+      */
+    GurlsOption* findLocal(const char* begin, const char* end, std::size_t hash) const;
+
+    /**
+      * Adds the element it of table to the index
+      */
+    void indexInsert(ValueType::iterator it);
+
+    /**
+      * Rebuilds the index of table
+      */
+    void reindex();
+
+    ValueType* table;   ///< Options list, indexed by name, only modified through addOpt() and removeOpt() to keep the index valid
+    std::vector<std::size_t> hashes;            ///< Hash of the key in each slot of the index, 0 for an empty slot
+    std::vector<ValueType::iterator> slots;     ///< Open addressing hash index of table, with linear probing
 
 };
 
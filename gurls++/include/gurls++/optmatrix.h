@@ -43,6 +43,10 @@
 #ifndef _GURLS_OPTMATRIX_H_
 #define _GURLS_OPTMATRIX_H_
 
+#include <utility>
+
+#include <boost/smart_ptr/detail/atomic_count.hpp>
+
 #include <gurls++/options.h>
 
 #ifdef _BGURLS
@@ -142,14 +146,62 @@ GURLS_EXPORT bool containsBigArray<BigArray<unsigned long> >();
 /**
   * \ingroup Settings
   * \brief OptMatrix is an option containing a matrix.
+  *
+  * Copies of an option owning its matrix, such as those made by GurlsOptionsList::copyOpt(),
+  * share the matrix instead of duplicating it: the matrix is copied only when one of the
+  * sharing options is accessed through the non-const getValue(), and is deleted with the last
+  * of them. References obtained from the non-const getValue() must therefore not be used to
+  * modify the matrix once the option has been copied; code caching the address of the matrix
+  * must check isShared() and fetch it again from getValue() before writing to it.
+  * Options not owning their matrix are always copied deeply.
   * \tparam MatrixType Type of the matrix contained into the option
   */
 template <typename Matrix>
 class OptMatrix: public OptMatrixBase
 {
 private:
-    Matrix* value;  ///< Option value
-    bool isOwner;   ///< Flag indicating if the option is owner of the matrix pointer
+    /**
+      * Matrix shared by the copies of an option
+      */
+    struct Payload
+    {
+        Payload(Matrix* m, bool owner): value(m), isOwner(owner), refs(1) {}
+
+        Matrix* value;      ///< Option value
+        bool isOwner;       ///< Flag indicating if the matrix is deleted with the last option sharing it
+        boost::detail::atomic_count refs;   ///< Number of options sharing the payload, updated atomically since copies may live in different threads
+    };
+
+    Payload* payload;   ///< Option value, possibly shared with other options
+
+    /**
+      * Leaves the payload, deleting it if this option is the last one sharing it
+      */
+    void release()
+    {
+        if(--payload->refs == 0)
+        {
+            if(payload->isOwner)
+                delete payload->value;
+
+            delete payload;
+        }
+
+        payload = NULL;
+    }
+
+    /**
+      * Makes a private copy of the matrix if it is shared with other options
+      */
+    void unshare()
+    {
+        if(payload->refs > 1)
+        {
+            Payload* copy = new Payload(new Matrix(*(payload->value)), true);
+            release();
+            payload = copy;
+        }
+    }
 
 public:
     typedef Matrix ValueType;
@@ -157,7 +209,7 @@ public:
     /**
       * Empty constructor
       */
-    OptMatrix(): OptMatrixBase () , value (new Matrix()), isOwner(true)
+    OptMatrix(): OptMatrixBase (), payload(new Payload(new Matrix(), true))
     {
         this->matType = getMatrixCellType<Matrix>();
     }
@@ -165,23 +217,57 @@ public:
     /**
       * Constructor from an existing matrix
       */
-    OptMatrix(Matrix& m, bool owner = true): OptMatrixBase(), value(&m), isOwner(owner)
+    OptMatrix(Matrix& m, bool owner = true): OptMatrixBase(), payload(new Payload(&m, owner))
     {
         this->matType = getMatrixCellType<Matrix>();
     }
 
+#ifdef GURLS_RVALUE_REFS
     /**
-      * Copies the option values from an existing \ref OptMatrix
+      * Constructor from a temporary matrix, whose buffer is moved into a new matrix owned by the option
       */
-    OptMatrix<Matrix>& operator=(const OptMatrix<Matrix>& other);
+    OptMatrix(Matrix&& m): OptMatrixBase(), payload(new Payload(new Matrix(std::move(m)), true))
+    {
+        this->matType = getMatrixCellType<Matrix>();
+    }
+#endif
+
+    /**
+      * Copy constructor, sharing the matrix of \c other if it is owned by \c other
+      */
+    OptMatrix(const OptMatrix<Matrix>& other): OptMatrixBase(), payload(NULL)
+    {
+        this->matType = other.matType;
+
+        if(other.payload->isOwner)
+        {
+            payload = other.payload;
+            ++payload->refs;
+        }
+        else
+            payload = new Payload(new Matrix(*(other.payload->value)), true);
+    }
+
+    /**
+      * Copies the option values from an existing \ref OptMatrix, sharing its matrix if it is owned by \c other
+      */
+    OptMatrix<Matrix>& operator=(const OptMatrix<Matrix>& other)
+    {
+        if(payload != other.payload)
+        {
+            OptMatrix<Matrix> tmp(other);
+            std::swap(payload, tmp.payload);
+        }
+
+        return *this;
+    }
 
     /**
       * Destructor
       */
     ~OptMatrix()
     {
-        if(isOwner)
-            delete value;
+        release();
     }
 
     /**
@@ -189,7 +275,16 @@ public:
       */
     void detachValue()
     {
-        isOwner = false;
+        unshare();
+        payload->isOwner = false;
+    }
+
+    /**
+      * Returns true if the matrix is shared with other options
+      */
+    bool isShared() const
+    {
+        return payload->refs > 1;
     }
 
     /**
@@ -209,18 +304,30 @@ public:
       */
     void setValue(const Matrix& newvalue)
     {
-        ~OptMatrix();
+        Payload* newPayload = new Payload(new Matrix(newvalue), true);
+        release();
+        payload = newPayload;
+    }
 
-        value = new Matrix(newvalue);
-        this->isOwner = true;
+#ifdef GURLS_RVALUE_REFS
+    /**
+      * Moves the buffer of a temporary matrix into the option
+      */
+    void setValue(Matrix&& newvalue)
+    {
+        Payload* newPayload = new Payload(new Matrix(std::move(newvalue)), true);
+        release();
+        payload = newPayload;
     }
+#endif
 
     /**
       * Returns the matrix
       */
     Matrix& getValue()
     {
-        return *value;
+        unshare();
+        return *(payload->value);
     }
 
     /**
@@ -228,7 +335,7 @@ public:
       */
     const Matrix& getValue() const
     {
-        return *value;
+        return *(payload->value);
     }
 
     /**
@@ -105,6 +105,9 @@ class ParamSelSiglamLooGPRegr;
 template <typename T>
 class ParamSelSiglamHoGPRegr;
 
+template <typename T>
+class ParamSelHoSparseGPRegr;
+
 /**
  * \ingroup Exceptions
  *
@@ -175,6 +178,8 @@ public:
             return new ParamSelSiglamLooGPRegr<T>;
         if(id == "siglamhogpregr")
             return new ParamSelSiglamHoGPRegr<T>;
+        if(id == "hosparsegpregr")
+            return new ParamSelHoSparseGPRegr<T>;
 
         throw BadParamSelectionCreation(id);
     }
@@ -49,6 +49,7 @@
 #include "gurls++/gmat2d.h"
 #include "gurls++/options.h"
 #include "gurls++/optlist.h"
+#include "gurls++/utils.h"
 
 
 namespace gurls {
@@ -68,12 +69,14 @@ public:
      * \param Y labels matrix
      * \param opt options with the following:
      *  - Kernel (default)
-     *  - L, alpha (settable with the class Optimizers and its subclasses RLSGP)
+     *  - L, alpha (settable with the class Optimizers and its subclasses RLSGP and RLSSparseGP)
+     *  - LA (only for sparse GPs, settable with the class RLSSparseGP)
      *  - predkernel (settable with the class PredKernel and its subclasses PredKernelTrainTest, must contain the fields K and Ktest)
+     *  - predvars (optional, default 1): if 0 the variances are not computed
      *
      * \return pred GurlsOptionList with the following fields:
      *  - means = matrix of output means
-     *  - covs = matrix of output covariances
+     *  - vars = vector of output variances, unless opt.predvars is 0
      */
     GurlsOptionsList *execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList& opt);
 };
@@ -101,41 +104,108 @@ GurlsOptionsList *PredGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& /*
     const gMat2D<T> &alpha = rls->getOptValue<OptMatrix<gMat2D<T> > >("alpha");
 
 
-    gMat2D<T>* means_mat = new gMat2D<T>(kr, alpha.cols());
-    dot(K.getData(), alpha.getData(), means_mat->getData(), kr, kc, alpha.rows(), alpha.cols(), kr, alpha.cols(), CblasNoTrans, CblasNoTrans, CblasColMajor);
-
+    const bool predvars = !(opt.hasOpt("predvars") && opt.getOptAsNumber("predvars") == 0);
 
     const unsigned long n = X.rows();
+    const T* Ktest = NULL;
+    const T* LA = NULL;
 
-//    pred.vars = zeros(n,1);
-    gMat2D<T> *vars_mat = new gMat2D<T>(n, 1);
-    T* vars = vars_mat->getData();
-
-    T* v = new T[std::max(kc, n)];
+    // all the sizes are checked before allocating the results, which would leak on a throw
+    if(alpha.rows() != kc)
+        throw gException(Exception_Inconsistent_Size);
 
-    for(unsigned long i = 0; i<n; ++i)
+    if(predvars)
     {
-        getRow(K.getData(), kr, kc, i, v);
+        if(lr != lc || lr != kc || kr != n)
+            throw gException(Exception_Inconsistent_Size);
 
-////        v = opt.rls.L'\opt.predkernel.K(i,:)';
-        mldivide_squared(L.getData(), v, lr, lc, kc, 1, CblasTrans);
+        const gMat2D<T> &Ktest_mat = predkernel->getOptValue<OptMatrix<gMat2D<T> > >("Ktest");
+        if(Ktest_mat.getSize() != n)
+            throw gException(Exception_Inconsistent_Size);
 
-////        pred.vars(i) = v'*v;
-        vars[i] =  dot(kc, v, 1, v, 1);
-    }
+        Ktest = Ktest_mat.getData();
 
+        if(rls->hasOpt("LA"))
+        {
+            const gMat2D<T> &LA_mat = rls->getOptValue<OptMatrix<gMat2D<T> > >("LA");
+            if(LA_mat.rows() != lr || LA_mat.cols() != lc)
+                throw gException(Exception_Inconsistent_Size);
 
-//    pred.vars = opt.predkernel.Ktest - pred.vars;
-    const gMat2D<T> &Ktest = predkernel->getOptValue<OptMatrix<gMat2D<T> > >("Ktest");
-    copy(v, Ktest.getData(), n);
-    axpy(n, (T)-1.0, vars, 1, v, 1);
-    copy(vars, v, n);
+            LA = LA_mat.getData();
+        }
+    }
 
-    delete[] v;
+    gMat2D<T>* means_mat = new gMat2D<T>(kr, alpha.cols());
+    dot(K.getData(), alpha.getData(), means_mat->getData(), kr, kc, alpha.rows(), alpha.cols(), kr, alpha.cols(), CblasNoTrans, CblasNoTrans, CblasColMajor);
 
-    GurlsOptionsList* pred = new GurlsOptionsList("pred");
 
+    GurlsOptionsList* pred = new GurlsOptionsList("pred");
     pred->addOpt("means", new OptMatrix<gMat2D<T> >(*means_mat));
+
+    if(!predvars)
+        return pred;
+
+    gMat2D<T> *vars_mat = new gMat2D<T>(n, 1);
+    T* vars = vars_mat->getData();
+
+    // the rows of K are processed in blocks, each solved with one trsm
+    const unsigned long blocksize = std::min(std::max(n, 1ul), predict_kernel_blocksize(kc));
+    const long nblocks = static_cast<long>((n+blocksize-1)/blocksize);
+
+#pragma omp parallel
+    {
+        // allocated on the first block of the thread
+        T* V = NULL;
+        T* VA = NULL;
+
+#pragma omp for schedule(dynamic)
+        for(long b=0; b<nblocks; ++b)
+        {
+            const unsigned long i0 = b*blocksize;
+            const unsigned long nb = std::min(blocksize, n-i0);
+
+            if(V == NULL)
+            {
+                V = new T[blocksize*kc];
+                VA = (LA != NULL)? new T[blocksize*kc]: NULL;
+            }
+
+//            V = opt.predkernel.K(i0:i0+nb-1,:)/opt.rls.L;
+            for(unsigned long j=0; j<kc; ++j)
+                copy(V + j*nb, K.getData() + i0 + j*kr, nb);
+
+            trsm(CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, nb, kc, (T)1.0, L.getData(), lr, V, nb);
+
+//            pred.vars(i0:i0+nb-1) = opt.predkernel.Ktest(i0:i0+nb-1) - sum(V.^2, 2);
+            T* vars_b = vars + i0;
+            copy(vars_b, Ktest + i0, nb);
+            for(unsigned long j=0; j<kc; ++j)
+            {
+                const T* Vj = V + j*nb;
+                for(unsigned long i=0; i<nb; ++i)
+                    vars_b[i] -= Vj[i]*Vj[i];
+            }
+
+            if(LA == NULL)
+                continue;
+
+//            VA = V/opt.rls.LA;
+//            pred.vars(i0:i0+nb-1) = pred.vars(i0:i0+nb-1) + sum(VA.^2, 2);
+            copy(VA, V, nb*kc);
+            trsm(CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, nb, kc, (T)1.0, LA, lr, VA, nb);
+
+            for(unsigned long j=0; j<kc; ++j)
+            {
+                const T* VAj = VA + j*nb;
+                for(unsigned long i=0; i<nb; ++i)
+                    vars_b[i] += VAj[i]*VAj[i];
+            }
+        }
+
+        delete[] V;
+        delete[] VA;
+    }
+
     pred->addOpt("vars", new OptMatrix<gMat2D<T> >(*vars_mat));
 
     return pred;
@@ -117,11 +117,16 @@ GurlsOptionsList *PredKernelTrainTest<T>::execute(const gMat2D<T>& X, const gMat
 
 
         K = new gMat2D<T>(xr, rls_xr);
-        copy(K->getData(), dist->getData(), dist->getSize());
 
 //            fk.K = exp(-(opt.predkernel.distance)/(opt.paramsel.sigma^2));
-        scal(K->getSize(), (T)(-1.0/pow(sigma, 2)), K->getData(), 1);
-        exp(K->getData(), K->getSize());
+        const T gamma = (T)(-1.0/pow(sigma, 2));
+        const T* D = dist->getData();
+        T* K_it = K->getData();
+        const long len = static_cast<long>(K->getSize());
+
+#pragma omp parallel for
+        for(long i=0; i<len; ++i)
+            K_it[i] = std::exp(gamma*D[i]);
 
         if(optimizer->hasOpt("L"))
         {
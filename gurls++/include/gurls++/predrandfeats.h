@@ -74,6 +74,7 @@ public:
      * \param opt structure of options with the following fields (and subfields):
      *  - optimizer.W (set by the optimizer tasks)
      *  - optimizer.proj (set by the optimizer tasks)
+     *  - optimizer.projtype (optional, set by the optimizer tasks)
      *
      * \return matrix of predicted labels
      */
@@ -85,15 +86,18 @@ GurlsOptionsList *PredRandFeats<T>::execute(const gMat2D<T>& X, const gMat2D<T>&
 {
 
 //    G = rp_apply_real(X, opt.rls.proj);
-    const gMat2D<T>& proj = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.proj");
-    gMat2D<T> *G = rp_apply_real(X, proj);
-
 //    scores = G*opt.rls.W;
+    const gMat2D<T>& proj = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.proj");
     const gMat2D<T>& W = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+    const std::string projType = opt.hasOpt("optimizer.projtype")? opt.getOptAsString("optimizer.projtype") : "gaussian";
+    const unsigned long D = W.rows()/2;
 
-    gMat2D<T> *scores_mat = new gMat2D<T>(G->rows(), W.cols());
-    dot(G->getData(), W.getData(), scores_mat->getData(), G->rows(), G->cols(), W.rows(), W.cols(), G->rows(), W.cols(), CblasNoTrans, CblasNoTrans, CblasColMajor);
+    if(proj.rows() != ((projType == "gaussian")? X.cols() : rp_structured_blocksize(X.cols())))
+        throw gException(Exception_Inconsistent_Size);
 
+    gMat2D<T> *scores_mat = new gMat2D<T>(X.rows(), W.cols());
+    rp_predict_real(X.getData(), X.rows(), X.cols(), proj.getData(), D, projType,
+                    W.getData(), W.cols(), scores_mat->getData());
 
     GurlsOptionsList* pred = new GurlsOptionsList("pred");
     pred->addOpt("scores", new OptMatrix<gMat2D<T> >(*scores_mat));
@@ -43,6 +43,7 @@
 #define GURLS_RANDFEATSWRAPPER_H
 
 #include "gurls++/rlswrapper.h"
+#include "gurls++/chunkreader.h"
 
 namespace gurls
 {
@@ -58,6 +59,8 @@ template<typename T>
 class RandomFeaturesWrapper: public RLSWrapper<T>
 {
 public:
+    enum ProjectionType{GAUSSIAN, FASTFOOD, ORTHOGONAL};  ///< Available random projections
+
     /**
       * Constructor
       *
@@ -78,6 +81,15 @@ public:
       */
     void train(const gMat2D<T> &X, const gMat2D<T> &y);
 
+    /**
+      * Training on a dataset read in chunks, which never needs to be held in memory.
+      * The regularization parameter must be given with setParam().
+      *
+      * \param[in] reader Reader of the training set, read from its current position to the end
+      * \param[in] chunksize Number of samples read at a time
+      */
+    void train(ChunkReader<T> &reader, unsigned long chunksize = 65536);
+
 
     /**
       * Estimates label for an input matrix
@@ -93,8 +105,30 @@ public:
       */
     void setNRandFeats(unsigned long value);
 
+    /**
+      * Sets the type of the random projections:
+      * - GAUSSIAN: dense gaussian matrix (default), O(d*D) parameters and operations per sample
+      * - FASTFOOD: Hadamard-diagonal-permutation blocks, O(D) parameters and O(D*log(d)) operations per sample
+      * - ORTHOGONAL: structured orthogonal blocks, O(D) parameters and O(D*log(d)) operations per sample
+      */
+    void setProjectionType(ProjectionType value);
+
+    /**
+      * Sets the seed of the random generator used to draw the projections
+      */
+    void setProjectionSeed(unsigned long value);
+
 protected:
+    /**
+      * Returns the name of the projection type used by \ref rp_projections
+      */
+    std::string projectionName() const;
+
     gMat2D<T> *W;
+    unsigned long nFeats;       ///< Number of random projections of the trained model
+    std::string modelType;      ///< Projection type of the trained model
+    ProjectionType projType;    ///< Type of the random projections
+    unsigned long projSeed;     ///< Seed of the random projections
 };
 
 }
@@ -12,7 +12,8 @@ namespace gurls
 {
 
 template <typename T>
-RandomFeaturesWrapper<T>::RandomFeaturesWrapper(const std::string &name): RLSWrapper<T>(name), W(NULL) { }
+RandomFeaturesWrapper<T>::RandomFeaturesWrapper(const std::string &name): RLSWrapper<T>(name), W(NULL), nFeats(0),
+    projType(GAUSSIAN), projSeed(5489u) { }
 
 template <typename T>
 RandomFeaturesWrapper<T>::~RandomFeaturesWrapper()
@@ -36,18 +37,65 @@ void RandomFeaturesWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     if(W != NULL)
         delete W;
 
-    W = rp_projections<T>(d, D);
+    modelType = projectionName();
+    nFeats = D;
+    W = rp_projections<T>(d, D, modelType, projSeed);
 
 
 //    V = X*W;
 //    Xtr = [cos(V) sin(V)];
-    gMat2D<T> *Xtr = rp_apply_real(X, *W);
+    gMat2D<T> *Xtr = rp_apply_real(X, *W, modelType, D);
 
     RLSWrapper<T>::train(*Xtr, y);
 
     delete Xtr;
 }
 
+template <typename T>
+void RandomFeaturesWrapper<T>::train(ChunkReader<T> &reader, unsigned long chunksize)
+{
+    if(!this->opt->hasOpt("paramsel.lambdas"))
+        throw gException("Please set a valid value for the regularization parameter, calling setParam(value)");
+
+    const unsigned long D = static_cast<unsigned long>(this->opt->getOptAsNumber("randfeats.D"));
+    const unsigned long psize = static_cast<unsigned long>(this->opt->getOptAsNumber("randfeats.samplesize"));
+    const unsigned long D2 = 2*D;
+    const unsigned long t = reader.outputs();
+
+    this->opt->removeOpt("split");
+    this->opt->removeOpt("optimizer");
+
+    if(W != NULL)
+        delete W;
+    W = NULL;
+
+    modelType = projectionName();
+    nFeats = D;
+
+    //    lambda = opt.singlelambda(opt.paramsel.lambdas);
+    const gMat2D<T> &ll = this->opt->template getOptValue<OptMatrix<gMat2D<T> > >("paramsel.lambdas");
+    const T lambda = this->opt->template getOptAs<OptFunction>("singlelambda")->getValue(ll.getData(), ll.getSize());
+
+    T *XtX = new T[D2*D2];
+    T *Xty = new T[D2*t];
+
+    unsigned long n;
+    W = rp_factorize_stream_real(reader, D, psize, XtX, Xty, modelType, projSeed, chunksize, n);
+
+    //    rls.W = rls_primal_driver( XtX, Xty, n, lambda );
+    gMat2D<T> *Wrls = rls_primal_driver(XtX, Xty, n, D2, t, lambda);
+
+    delete [] XtX;
+    delete [] Xty;
+
+    GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
+    optimizer->addOpt("W", new OptMatrix<gMat2D<T> >(*Wrls));
+    optimizer->addOpt("C", new OptMatrix<gMat2D<T> >(*(new gMat2D<T>())));
+    optimizer->addOpt("X", new OptMatrix<gMat2D<T> >(*(new gMat2D<T>())));
+
+    this->opt->addOpt("optimizer", optimizer);
+}
+
 template<typename T>
 gMat2D<T>* RandomFeaturesWrapper<T>::eval(const gMat2D<T> &X)
 {
@@ -57,11 +105,12 @@ gMat2D<T>* RandomFeaturesWrapper<T>::eval(const gMat2D<T> &X)
 
 //    V = X*W;
 //    Xte = [cos(V) sin(V)];
-    gMat2D<T> *Xte = rp_apply_real(X, *W);
+//    pred = Xte*rls.W;
+    const gMat2D<T>& Wrls = this->opt->template getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
 
-    gMat2D<T>* pred = RLSWrapper<T>::eval(*Xte);
-
-    delete Xte;
+    gMat2D<T>* pred = new gMat2D<T>(X.rows(), Wrls.cols());
+    rp_predict_real(X.getData(), X.rows(), X.cols(), W->getData(), nFeats, modelType,
+                    Wrls.getData(), Wrls.cols(), pred->getData());
 
     return pred;
 }
@@ -72,4 +121,30 @@ void RandomFeaturesWrapper<T>::setNRandFeats(unsigned long value)
     this->opt->template getOptValue<OptNumber>("randfeats.D") = value;
 }
 
+template<typename T>
+void RandomFeaturesWrapper<T>::setProjectionType(ProjectionType value)
+{
+    projType = value;
+}
+
+template<typename T>
+void RandomFeaturesWrapper<T>::setProjectionSeed(unsigned long value)
+{
+    projSeed = value;
+}
+
+template<typename T>
+std::string RandomFeaturesWrapper<T>::projectionName() const
+{
+    switch(projType)
+    {
+    case FASTFOOD:
+        return "fastfood";
+    case ORTHOGONAL:
+        return "orthogonal";
+    default:
+        return "gaussian";
+    }
+}
+
 }
@@ -87,43 +87,50 @@ GurlsOptionsList *KernelRBF<T>::execute(const gMat2D<T>& X, const gMat2D<T>& /*Y
 //    end
 
     GurlsOptionsList* kernel = new GurlsOptionsList("kernel");
-    gMat2D<T> *dist;
+    const gMat2D<T> *dist;
 
-    bool oldDistance = false;
+    const GurlsOptionsList* opt_kernel = NULL;
 
     if(opt.hasOpt("kernel"))
     {
-        const GurlsOptionsList* opt_kernel = opt.getOptAs<GurlsOptionsList>("kernel");
+        opt_kernel = opt.getOptAs<GurlsOptionsList>("kernel");
 
-        if(opt_kernel->hasOpt("distance"))
-            oldDistance = true;
+        if(!opt_kernel->hasOpt("distance"))
+            opt_kernel = NULL;
     }
 
-    if(oldDistance)
+    if(opt_kernel != NULL)
     {
-        const gMat2D<T> &opt_dist = opt.getOptValue<OptMatrix<gMat2D<T> > >("kernel.distance");
+        // the distance matrix is shared with opt.kernel, not copied
+        kernel->copyOpt("distance", *opt_kernel);
 
-        dist = new gMat2D<T>(opt_dist);
+        dist = &(static_cast<const GurlsOptionsList*>(kernel)->getOptValue<OptMatrix<gMat2D<T> > >("distance"));
     }
     else
     {
-        dist = new gMat2D<T>(xr, xr);
-
-        distance_transposed(X.getData(), X.getData(), xc, xr, xr, dist->getData());
-    }
+        gMat2D<T>* newDist = new gMat2D<T>(xr, xr);
 
+        distance_transposed(X.getData(), X.getData(), xc, xr, xr, newDist->getData());
 
-    kernel->addOpt("distance", new OptMatrix<gMat2D<T> >(*dist));
+        kernel->addOpt("distance", new OptMatrix<gMat2D<T> >(*newDist));
+        dist = newDist;
+    }
 
     double sigma = opt.getOptValue<OptNumber>("paramsel.sigma");
 
-    const int len = xr*xr;
-    gMat2D<T> *K = new gMat2D<T>(dist->getData(), xr, xr, true);
+    const long len = static_cast<long>(xr)*xr;
+    gMat2D<T> *K = new gMat2D<T>(xr, xr);
 
 //    D = -(opt.kernel.distance);
 //    K = exp(D/(opt.paramsel.sigma^2));
-    scal(len, (T)(-1.0/pow(sigma, 2)),  K->getData(), 1);
-    exp(K->getData(), len);
+    // computed in a single pass over the distances, without copying them first
+    const T gamma = (T)(-1.0/pow(sigma, 2));
+    const T* D = dist->getData();
+    T* K_it = K->getData();
+
+#pragma omp parallel for
+    for(long i=0; i<len; ++i)
+        K_it[i] = std::exp(gamma*D[i]);
 
 //    kernel.type = 'rbf';
     kernel->addOpt("type", "rbf");
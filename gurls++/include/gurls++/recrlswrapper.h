@@ -43,6 +43,8 @@
 #define GURLS_RECRLSWRAPPER_H
 
 #include "gurls++/wrapper.h"
+#include "gurls++/rowbuffer.h"
+#include "gurls++/chunkreader.h"
 
 namespace gurls
 {
@@ -70,6 +72,11 @@ public:
       */
     RecursiveRLSWrapper(const std::string& name);
 
+    /**
+      * Destructor
+      */
+    ~RecursiveRLSWrapper();
+
     /**
       * Initial parameter selection and training
       *
@@ -86,6 +93,23 @@ public:
       */
     void update(const gVec<T> &X, const gVec<T> &y);
 
+    /**
+      * Estimator update with a block of samples
+      *
+      * \param[in] X Input data matrix, one sample per row
+      * \param[in] Y Labels matrix, one sample per row
+      */
+    void update(const gMat2D<T> &X, const gMat2D<T> &y);
+
+    /**
+      * Estimator update with all the samples delivered by a reader, which are
+      * never held in memory all at once
+      *
+      * \param[in] reader Reader of the new samples, read from its current position to the end
+      * \param[in] chunksize Number of samples read and used for each block update
+      */
+    void update(ChunkReader<T> &reader, unsigned long chunksize = 65536);
+
     /**
       * Estimates label for an input matrix
       *
@@ -101,8 +125,97 @@ public:
       */
     void retrain();
 
+    /**
+      * Sets the forgetting factor beta in (0,1] used by update().
+      * With beta < 1 the contribution of each sample is scaled by beta at every
+      * following update, so that the estimator can track non-stationary data.
+      * The validation samples age with the same factor, so that retrain() removes them
+      * from the decayed X'*X and X'*y consistently and weights their hold-out error alike.
+      * The default value 1 keeps all samples with the same weight.
+      */
+    void setForgettingFactor(double value);
+
+    /**
+      * Sets the maximum number of samples of the validation set used by retrain().
+      * Once the cap is reached every new validation sample replaces the oldest one.
+      * The default value 0 keeps all the validation samples. Takes effect at the next call to train().
+      */
+    void setValidationCap(unsigned long value);
+
+    /**
+      * Returns the inputs of the validation set used by retrain(), valid until the next update.
+      * With a forgetting factor beta < 1 every row is scaled by the square root of its weight.
+      */
+    const gMat2D<T>& getValidationInputs();
+
+    /**
+      * Returns the labels of the validation set used by retrain(), valid until the next update.
+      * With a forgetting factor beta < 1 every row is scaled by the square root of its weight.
+      */
+    const gMat2D<T>& getValidationLabels();
+
+    /**
+      * Prepares the allocation-free update path used by realTimeUpdate().
+      * The addresses of the estimator state are cached and all the scratch memory
+      * is preallocated, including room for vaCapacity more validation samples.
+      * Must be called after train(); the cached state is then kept valid by train(),
+      * update() and retrain(), and is unshared from any copy of the options before it is modified.
+      *
+      * \param[in] vaCapacity Number of validation samples that can be added by realTimeUpdate() between two calls to update() or retrain()
+      */
+    void prepareRealTimeUpdate(unsigned long vaCapacity = 1024);
+
+    /**
+      * Estimator update with a single sample, performed in place with level 2 BLAS
+      * calls only, with no memory allocation and no options lookup.
+      * Its cost is O(d^2) and does not depend on the number of samples seen so far, except
+      * for the rescaling of the validation set every few thousand samples when beta < 1.
+      * Validation samples exceeding the capacity given to prepareRealTimeUpdate() are discarded,
+      * unless the validation set is capped by setValidationCap().
+      *
+      * \param[in] x Input sample, d elements
+      * \param[in] y Labels of the sample, t elements
+      */
+    void realTimeUpdate(const T* x, const T* y);
+
 protected:
+    /**
+      * Caches the addresses of the estimator state and reallocates the scratch memory used by realTimeUpdate()
+      */
+    void bindRealTimeState();
+
+    /**
+      * Caches the addresses of the matrices of the estimator state, making them private to this
+      * wrapper if they are shared with copies of the options (see \ref OptMatrix)
+      */
+    void bindRealTimeData();
+
+    /**
+      * Applies the pending scale vaScale to the rows of the validation set
+      */
+    void applyValidationScale();
+
     unsigned long nTot; ///< Total number of samples used for training
+
+    RowBuffer<T> Xva;           ///< Validation inputs
+    RowBuffer<T> yva;           ///< Validation labels
+    T vaScale;                  ///< Scale not yet applied to the validation rows, decayed by sqrt(beta) at every sample
+
+    OptMatrix<gMat2D<T> >* rtWOpt;      ///< Option holding W
+    OptMatrix<gMat2D<T> >* rtCinvOpt;   ///< Option holding Cinv
+    OptMatrix<gMat2D<T> >* rtXtXOpt;    ///< Option holding XtX
+    OptMatrix<gMat2D<T> >* rtXtyOpt;    ///< Option holding Xty
+    T* rtW;                     ///< Coefficients of the estimator, d-by-t
+    T* rtCinv;                  ///< Inverse of the regularized covariance matrix, d-by-d
+    T* rtXtX;                   ///< Accumulated X'*X, d-by-d
+    T* rtXty;                   ///< Accumulated X'*y, d-by-t
+    T* rtWork;                  ///< Scratch memory, d+t elements
+    unsigned long rtD;          ///< Number of input variables
+    unsigned long rtT;          ///< Number of outputs
+    unsigned long rtVaCapacity; ///< Number of validation samples that can be added by realTimeUpdate(), 0 if it is not enabled
+    unsigned long rtProportion; ///< One sample every rtProportion is added to the validation set
+    T rtBeta;                   ///< Forgetting factor
+    T rtSqrtBeta;               ///< Square root of the forgetting factor
 };
 
 }
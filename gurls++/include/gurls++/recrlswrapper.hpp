@@ -6,14 +6,26 @@
 namespace gurls
 {
 template <typename T>
-RecursiveRLSWrapper<T>::RecursiveRLSWrapper(const std::string &name): GurlsWrapper<T>(name)
+RecursiveRLSWrapper<T>::RecursiveRLSWrapper(const std::string &name): GurlsWrapper<T>(name),
+    vaScale(1.0), rtWOpt(NULL), rtCinvOpt(NULL), rtXtXOpt(NULL), rtXtyOpt(NULL), rtW(NULL), rtCinv(NULL), rtXtX(NULL), rtXty(NULL), rtWork(NULL),
+    rtD(0), rtT(0), rtVaCapacity(0), rtProportion(1), rtBeta(1.0), rtSqrtBeta(1.0)
 {
     this->opt->template getOptValue<OptNumber>("nholdouts") = 1.0;
+    this->opt->addOpt("forgettingfactor", new OptNumber(1.0));
+    this->opt->addOpt("validationcap", new OptNumber(0));
+}
+
+template <typename T>
+RecursiveRLSWrapper<T>::~RecursiveRLSWrapper()
+{
+    delete[] rtWork;
 }
 
 template <typename T>
 void RecursiveRLSWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 {
+    rtW = NULL;
+
     this->opt->removeOpt("split");
     this->opt->removeOpt("paramsel");
     this->opt->removeOpt("optimizer");
@@ -35,14 +47,20 @@ void RecursiveRLSWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     const unsigned long last = split_lasts.getData()[0];
     const unsigned long nva = n-last;
 
-    unsigned long* va = new unsigned long[nva];
-    copy(va, split_indices.getData()+last, nva);
+    const unsigned long* va = split_indices.getData()+last;
 
-    gMat2D<T>* Xva = new gMat2D<T>(nva, d);
-    gMat2D<T>* yva = new gMat2D<T>(nva, t);
+    const unsigned long vacap = static_cast<unsigned long>(this->opt->getOptAsNumber("validationcap"));
+    Xva.reset(d, vacap);
+    yva.reset(t, vacap);
+    Xva.reserve(nva);
+    yva.reserve(nva);
+    vaScale = (T)1.0;
 
-    subMatrixFromRows(X.getData(), n, d, va, nva, Xva->getData());
-    subMatrixFromRows(y.getData(), n, t, va, nva, yva->getData());
+    for(unsigned long i=0; i<nva; ++i)
+    {
+        Xva.append(X.getData()+va[i], n);
+        yva.append(y.getData()+va[i], n);
+    }
 
     gMat2D<T>* XtX = new gMat2D<T>(d, d);
     gMat2D<T>* Xty = new gMat2D<T>(d, t);
@@ -56,9 +74,6 @@ void RecursiveRLSWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
     kernel->addOpt("XtX", new OptMatrix<gMat2D<T> >(*XtX));
     kernel->addOpt("Xty", new OptMatrix<gMat2D<T> >(*Xty));
 
-    kernel->addOpt("Xva", new OptMatrix<gMat2D<T> >(*Xva));
-    kernel->addOpt("yva", new OptMatrix<gMat2D<T> >(*yva));
-
     nTot = n;
     this->opt->addOpt("kernel", kernel);
 
@@ -68,16 +83,14 @@ void RecursiveRLSWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T> &y)
 
     RLSPrimalRecInit<T> optimizerTask;
     this->opt->addOpt("optimizer", optimizerTask.execute(X, y, *(this->opt)));
+
+    if(rtVaCapacity > 0)
+        bindRealTimeState();
 }
 
 template <typename T>
 void RecursiveRLSWrapper<T>::update(const gVec<T> &X, const gVec<T> &y)
 {
-    if(!this->trainedModel())
-        throw gException("Error, Train Model First");
-
-    RLSPrimalRecUpdate<T> optimizer;
-
     const unsigned long d = X.getSize();
     const unsigned long t = y.getSize();
 
@@ -86,69 +99,119 @@ void RecursiveRLSWrapper<T>::update(const gVec<T> &X, const gVec<T> &y)
     gMat2D<T>y_mat(1, t);
     copy(y_mat.getData(), y.getData(), t);
 
-    GurlsOptionsList* ret = optimizer.execute(X_mat, y_mat, *(this->opt));
-    this->opt->removeOpt("optimizer");
-    this->opt->addOpt("optimizer", ret);
+    update(X_mat, y_mat);
+}
 
-    ++nTot;
+template <typename T>
+void RecursiveRLSWrapper<T>::update(const gMat2D<T> &X, const gMat2D<T> &y)
+{
+    if(!this->trainedModel())
+        throw gException("Error, Train Model First");
+
+    const unsigned long n = X.rows();
+    const unsigned long d = X.cols();
+    const unsigned long t = y.cols();
+
+    if(y.rows() != n)
+        throw gException(Exception_Inconsistent_Size);
+
+    if(n == 0)
+        return;
+
+    rtW = NULL;
 
-    gMat2D<T>* xtx = new gMat2D<T>(d,d);
-    gMat2D<T>* xty = new gMat2D<T>(d,t);
+    // the estimator in opt.optimizer is updated in place, without copying W and Cinv
+    GurlsOptionsList* optimizer = this->opt->template getOptAs<GurlsOptionsList>("optimizer");
 
-    dot(X.getData(), X.getData(), xtx->getData(), 1, d, 1, d, d, d, CblasTrans, CblasNoTrans, CblasColMajor);
-    dot(X.getData(), y.getData(), xty->getData(), 1, d, 1, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
+    RLSPrimalRecUpdate<T>::update(X, y, *(this->opt),
+                                  optimizer->getOptValue<OptMatrix<gMat2D<T> > >("W"),
+                                  optimizer->getOptValue<OptMatrix<gMat2D<T> > >("Cinv"));
 
     GurlsOptionsList* kernel = this->opt->template getOptAs<GurlsOptionsList>("kernel");
 
-    const gMat2D<T>& XtX = kernel->getOptValue<OptMatrix<gMat2D<T> > >("XtX");
-    const gMat2D<T>& Xty = kernel->getOptValue<OptMatrix<gMat2D<T> > >("Xty");
+    gMat2D<T>& XtX = kernel->getOptValue<OptMatrix<gMat2D<T> > >("XtX");
+    gMat2D<T>& Xty = kernel->getOptValue<OptMatrix<gMat2D<T> > >("Xty");
 
-    axpy(d*d, (T)1.0, XtX.getData(), 1, xtx->getData(), 1);
-    axpy(d*t, (T)1.0, Xty.getData(), 1, xty->getData(), 1);
+    const T beta = static_cast<T>(this->opt->getOptAsNumber("forgettingfactor"));
 
-    kernel->removeOpt("XtX");
-    kernel->addOpt("XtX", new OptMatrix<gMat2D<T> >(*xtx));
+    if(beta == (T)1.0)
+    {
+        //  XtX = XtX + X'*X;   Xty = Xty + X'*y;
+        gemm(CblasTrans, CblasNoTrans, d, d, n, (T)1.0, X.getData(), n, X.getData(), n, (T)1.0, XtX.getData(), d);
+        gemm(CblasTrans, CblasNoTrans, d, t, n, (T)1.0, X.getData(), n, y.getData(), n, (T)1.0, Xty.getData(), d);
+    }
+    else
+    {
+        //  D = diag(beta.^(n-1:-1:0));   Xd = D*X;
+        T* Xd = new T[n*d];
+        copy(Xd, X.getData(), n*d);
+
+        T weight = (T)1.0;
+        for(long i=n-1; i>=0; --i, weight*=beta)
+            scal(d, weight, Xd+i, n);
 
-    kernel->removeOpt("Xty");
-    kernel->addOpt("Xty", new OptMatrix<gMat2D<T> >(*xty));
+        //  XtX = beta^n*XtX + Xd'*X;   Xty = beta^n*Xty + Xd'*y;
+        const T decay = std::pow(beta, static_cast<int>(n));
+        gemm(CblasTrans, CblasNoTrans, d, d, n, (T)1.0, Xd, n, X.getData(), n, decay, XtX.getData(), d);
+        gemm(CblasTrans, CblasNoTrans, d, t, n, (T)1.0, Xd, n, y.getData(), n, decay, Xty.getData(), d);
+
+        delete[] Xd;
+
+        // the validation rows already stored age by beta^n as well
+        vaScale *= std::sqrt(decay);
+    }
 
 
+    // Every 1/hoproportion samples one is appended to the validation set,
+    // scaled by the square root of its weight beta^(n-1-i)
     unsigned long proportion = static_cast<unsigned long>(gurls::round(1.0/this->opt->getOptAsNumber("hoproportion")));
 
-    if(nTot % proportion == 0)
+    for(unsigned long i=0; i<n; ++i)
     {
-        const gMat2D<T>& Xva = kernel->getOptValue<OptMatrix<gMat2D<T> > >("Xva");
-        const gMat2D<T>& yva = kernel->getOptValue<OptMatrix<gMat2D<T> > >("yva");
-
-        const unsigned long nva = Xva.rows();
-        const unsigned long nva_new = nva+1;
+        if((nTot+i+1) % proportion == 0)
+        {
+            const T weight = (beta == (T)1.0)? (T)1.0: std::pow(beta, static_cast<T>(n-1-i)/2);
 
+            Xva.appendScaled(X.getData()+i, n, weight/vaScale);
+            yva.appendScaled(y.getData()+i, n, weight/vaScale);
+        }
+    }
 
-        gMat2D<T>* Xva_new = new gMat2D<T>(nva_new, d);
+    nTot += n;
 
-        const T* old_it = Xva.getData();
-        T* new_it = Xva_new->getData();
-        for(const T* end = new_it+(nva_new*d); new_it< end; old_it+=nva, new_it +=nva_new)
-            copy(new_it, old_it, nva);
+    if(vaScale < (T)1e-3)
+        applyValidationScale();
 
-        copy(Xva_new->getData()+nva, X.getData(), d, nva_new, 1);
+    if(rtVaCapacity > 0)
+        bindRealTimeState();
+}
 
-        kernel->removeOpt("Xva");
-        kernel->addOpt("Xva", new OptMatrix<gMat2D<T> >(*Xva_new));
+template <typename T>
+void RecursiveRLSWrapper<T>::update(ChunkReader<T> &reader, unsigned long chunksize)
+{
+    if(chunksize == 0)
+        throw gException(Exception_Illegal_Argument_Value);
 
+    const unsigned long d = reader.cols();
+    const unsigned long t = reader.outputs();
 
-        gMat2D<T>* yva_new = new gMat2D<T>(nva_new, t);
+    gMat2D<T> X(chunksize, d);
+    gMat2D<T> y(chunksize, t);
 
-        old_it = yva.getData();
-        new_it = yva_new->getData();
-        for(const T* end = new_it+(nva_new*t); new_it< end; old_it+=nva, new_it +=nva_new)
-            copy(new_it, old_it, nva);
+    unsigned long rows;
+    while((rows = reader.read(X.getData(), chunksize, y.getData(), chunksize, chunksize)) == chunksize)
+        update(X, y);
 
-        copy(yva_new->getData()+nva, y.getData(), t, nva_new, 1);
+    if(rows > 0)
+    {
+        // last partial chunk
+        gMat2D<T> Xr(rows, d);
+        gMat2D<T> yr(rows, t);
 
-        kernel->removeOpt("yva");
-        kernel->addOpt("yva", new OptMatrix<gMat2D<T> >(*yva_new));
+        gather_submatrix(Xr.getData(), rows, X.getData(), chunksize, (const unsigned long*)NULL, rows, (const unsigned long*)NULL, d);
+        gather_submatrix(yr.getData(), rows, y.getData(), chunksize, (const unsigned long*)NULL, rows, (const unsigned long*)NULL, t);
 
+        update(Xr, yr);
     }
 }
 
@@ -173,11 +236,14 @@ gMat2D<T>* RecursiveRLSWrapper<T>::eval(const gMat2D<T> &X)
 template <typename T>
 void RecursiveRLSWrapper<T>::retrain()
 {
-    GurlsOptionsList* kernel = this->opt->template getOptAs<GurlsOptionsList>("kernel");
-    const gMat2D<T> &Xva = kernel->getOptValue<OptMatrix<gMat2D<T> > >("Xva");
-    const gMat2D<T> &yva = kernel->getOptValue<OptMatrix<gMat2D<T> > >("yva");
+    rtW = NULL;
+
+    applyValidationScale();
 
-    const unsigned long nva = Xva.rows();
+    const gMat2D<T> &Xva_view = Xva.view();
+    const gMat2D<T> &yva_view = yva.view();
+
+    const unsigned long nva = Xva_view.rows();
 
     this->opt->removeOpt("paramsel");
     this->opt->removeOpt("optimizer");
@@ -202,7 +268,7 @@ void RecursiveRLSWrapper<T>::retrain()
 
 
     ParamSelHoPrimal<T> paramselTask;
-    this->opt->addOpt("paramsel", paramselTask.execute(Xva, yva, *(this->opt)));
+    this->opt->addOpt("paramsel", paramselTask.execute(Xva_view, yva_view, *(this->opt)));
 
 
     RLSPrimalRecInit<T> optimizerTask;
@@ -211,6 +277,148 @@ void RecursiveRLSWrapper<T>::retrain()
     this->opt->addOpt("optimizer", optimizerTask.execute(emptyMat, emptyMat, *(this->opt)));
     this->opt->removeOpt("nTot");
 
+    if(rtVaCapacity > 0)
+        bindRealTimeState();
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::setForgettingFactor(double value)
+{
+    if(!(value > 0.0 && value <= 1.0))
+        throw gException(Exception_Illegal_Argument_Value);
+
+    this->opt->template getOptValue<OptNumber>("forgettingfactor") = value;
+    rtBeta = static_cast<T>(value);
+    rtSqrtBeta = std::sqrt(rtBeta);
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::setValidationCap(unsigned long value)
+{
+    this->opt->template getOptValue<OptNumber>("validationcap") = value;
+}
+
+template <typename T>
+const gMat2D<T>& RecursiveRLSWrapper<T>::getValidationInputs()
+{
+    applyValidationScale();
+    return Xva.view();
+}
+
+template <typename T>
+const gMat2D<T>& RecursiveRLSWrapper<T>::getValidationLabels()
+{
+    applyValidationScale();
+    return yva.view();
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::prepareRealTimeUpdate(unsigned long vaCapacity)
+{
+    if(!this->trainedModel())
+        throw gException("Error, Train Model First");
+
+    rtVaCapacity = std::max(vaCapacity, 1ul);
+    bindRealTimeState();
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::realTimeUpdate(const T* x, const T* y)
+{
+    if(rtW == NULL)
+        throw gException("Error, call prepareRealTimeUpdate() first");
+
+    // a copy of the options made after prepareRealTimeUpdate() shares the state: keep it unchanged
+    if(rtWOpt->isShared() || rtCinvOpt->isShared() || rtXtXOpt->isShared() || rtXtyOpt->isShared())
+        bindRealTimeData();
+
+    const int d = static_cast<int>(rtD);
+    const int t = static_cast<int>(rtT);
+
+    T* Cx = rtWork;
+    T* e = rtWork+d;
+
+    //  Cx = Cinv*x;
+    gemv(CblasNoTrans, d, d, (T)1.0, rtCinv, d, x, 1, (T)0.0, Cx, 1);
+
+    //  s = beta + x'*Cx;
+    const T s = rtBeta + dot(d, x, 1, Cx, 1);
+
+    //  e = y - W'*x;
+    copy(e, y, t);
+    gemv(CblasTrans, d, t, (T)-1.0, rtW, d, x, 1, (T)1.0, e, 1);
+
+    //  W = W + Cx*e'/s;
+    gemm(CblasNoTrans, CblasTrans, d, t, 1, (T)1.0/s, Cx, d, e, t, (T)1.0, rtW, d);
+
+    //  Cinv = (Cinv - Cx*Cx'/s)/beta;
+    gemm(CblasNoTrans, CblasTrans, d, d, 1, (T)-1.0/(s*rtBeta), Cx, d, Cx, d, (T)1.0/rtBeta, rtCinv, d);
+
+    //  XtX = beta*XtX + x*x';   Xty = beta*Xty + x*y';
+    gemm(CblasNoTrans, CblasTrans, d, d, 1, (T)1.0, x, d, x, d, rtBeta, rtXtX, d);
+    gemm(CblasNoTrans, CblasTrans, d, t, 1, (T)1.0, x, d, y, t, rtBeta, rtXty, d);
+
+    ++nTot;
+
+    // the stored validation rows age by beta; every 1/hoproportion samples one is appended with weight 1
+    if(rtBeta != (T)1.0)
+        vaScale *= rtSqrtBeta;
+
+    if(nTot % rtProportion == 0 && Xva.hasRoom() && yva.hasRoom())
+    {
+        Xva.appendScaled(x, 1, (T)1.0/vaScale);
+        yva.appendScaled(y, 1, (T)1.0/vaScale);
+    }
+
+    if(vaScale < (T)1e-3)
+        applyValidationScale();
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::bindRealTimeState()
+{
+    GurlsOptionsList* optimizer = this->opt->template getOptAs<GurlsOptionsList>("optimizer");
+    GurlsOptionsList* kernel = this->opt->template getOptAs<GurlsOptionsList>("kernel");
+
+    rtWOpt = optimizer->getOptAs<OptMatrix<gMat2D<T> > >("W");
+    rtCinvOpt = optimizer->getOptAs<OptMatrix<gMat2D<T> > >("Cinv");
+    rtXtXOpt = kernel->getOptAs<OptMatrix<gMat2D<T> > >("XtX");
+    rtXtyOpt = kernel->getOptAs<OptMatrix<gMat2D<T> > >("Xty");
+
+    bindRealTimeData();
+
+    rtD = rtWOpt->getValue().rows();
+    rtT = rtWOpt->getValue().cols();
+    rtBeta = static_cast<T>(this->opt->getOptAsNumber("forgettingfactor"));
+    rtSqrtBeta = std::sqrt(rtBeta);
+    rtProportion = static_cast<unsigned long>(gurls::round(1.0/this->opt->getOptAsNumber("hoproportion")));
+
+    delete[] rtWork;
+    rtWork = new T[rtD+rtT];
+
+    Xva.reserve(Xva.rows()+rtVaCapacity);
+    yva.reserve(yva.rows()+rtVaCapacity);
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::bindRealTimeData()
+{
+    // the non-const getValue() unshares the matrices
+    rtW = rtWOpt->getValue().getData();
+    rtCinv = rtCinvOpt->getValue().getData();
+    rtXtX = rtXtXOpt->getValue().getData();
+    rtXty = rtXtyOpt->getValue().getData();
+}
+
+template <typename T>
+void RecursiveRLSWrapper<T>::applyValidationScale()
+{
+    if(vaScale == (T)1.0)
+        return;
+
+    Xva.scale(vaScale);
+    yva.scale(vaScale);
+    vaScale = (T)1.0;
 }
 
 }
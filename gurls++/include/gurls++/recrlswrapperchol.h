@@ -81,8 +81,8 @@ public:
     /**
       * Estimator update
       *
-      * \param[in] X Input data vector
-      * \param[in] Y Labels vector
+      * \param[in] X Input data matrix, one sample per row
+      * \param[in] Y Labels matrix, one sample per row
       */
     void update(const gMat2D<T> &X, const gMat2D<T> &y);
 
@@ -102,6 +102,18 @@ public:
       */
     void retrain();
 
+    /**
+      * Sets the size of the sliding window used by update().
+      * With a window of w samples the estimator is fit on the last w samples only:
+      * train() keeps the last w training samples and every sample added by update()
+      * replaces the oldest one, with O(d^2) cost and constant memory.
+      * The regularization parameter lambda is selected by train() on all the training samples,
+      * and the estimator on the window is regularized with min(n,w)*lambda, as a batch fit on
+      * the samples of the window would be.
+      * The default value 0 keeps all the samples. Takes effect at the next call to train().
+      */
+    void setWindowSize(unsigned long value);
+
 protected:
     unsigned long nTot; ///< Total number of samples used for training
 };
@@ -9,6 +9,7 @@ template <typename T>
 RecursiveRLSCholUpdateWrapper<T>::RecursiveRLSCholUpdateWrapper(const std::string &name): GurlsWrapper<T>(name)
 {
     this->opt->template getOptValue<OptNumber>("nholdouts") = 1.0;
+    this->opt->addOpt("windowsize", new OptNumber(0));
 }
 
 template <typename T>
@@ -43,6 +44,7 @@ void RecursiveRLSCholUpdateWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T>
 
     subMatrixFromRows(X.getData(), n, d, va, nva, Xva->getData());
     subMatrixFromRows(y.getData(), n, t, va, nva, yva->getData());
+    delete[] va;
 
     gMat2D<T>* XtX = new gMat2D<T>(d, d);
     gMat2D<T>* Xty = new gMat2D<T>(d, t);
@@ -66,8 +68,40 @@ void RecursiveRLSCholUpdateWrapper<T>::train(const gMat2D<T> &X, const gMat2D<T>
     this->opt->addOpt("paramsel", paramselTask.execute(X, y, *(this->opt)));
 
 
+    const unsigned long wsize = static_cast<unsigned long>(this->opt->getOptAsNumber("windowsize"));
+    if(wsize > 0)
+    {
+        // The initial estimator is computed on the last nw training samples, which fill the window
+        const unsigned long nw = std::min(n, wsize);
+        const unsigned long first = n-nw;
+
+        if(first > 0)
+        {
+            //  XtX = X(first:end,:)'*X(first:end,:);   Xty = X(first:end,:)'*y(first:end,:);
+            gemm(CblasTrans, CblasNoTrans, d, d, nw, (T)1.0, X.getData()+first, n, X.getData()+first, n, (T)0.0, XtX->getData(), d);
+            gemm(CblasTrans, CblasNoTrans, d, t, nw, (T)1.0, X.getData()+first, n, y.getData()+first, n, (T)0.0, Xty->getData(), d);
+        }
+
+        gMat2D<T>* Xwin = new gMat2D<T>(wsize, d);
+        gMat2D<T>* ywin = new gMat2D<T>(wsize, t);
+
+        for(unsigned long j=0; j<d; ++j)
+            copy(Xwin->getData()+j*wsize, X.getData()+first+j*n, nw);
+        for(unsigned long j=0; j<t; ++j)
+            copy(ywin->getData()+j*wsize, y.getData()+first+j*n, nw);
+
+        kernel->addOpt("Xwin", new OptMatrix<gMat2D<T> >(*Xwin));
+        kernel->addOpt("ywin", new OptMatrix<gMat2D<T> >(*ywin));
+        kernel->addOpt("winpos", new OptNumber(nw % wsize));
+        kernel->addOpt("wincount", new OptNumber(nw));
+
+        // the estimator is regularized as a fit on the nw samples of the window: R = chol(XtX + nw*lambda*eye(d))
+        this->opt->addOpt("nTot", new OptNumber(nw));
+    }
+
     RLSPrimalRecInitCholesky<T> optimizerTask;
     this->opt->addOpt("optimizer", optimizerTask.execute(X, y, *(this->opt)));
+    this->opt->removeOpt("nTot");
 }
 
 template <typename T>
@@ -78,19 +112,36 @@ void RecursiveRLSCholUpdateWrapper<T>::update(const gMat2D<T> &X, const gMat2D<T
 
     RLSPrimalRecUpdateCholesky<T> optimizer;
 
-    const unsigned long d = X.getSize();
-    const unsigned long t = y.getSize();
-
-    gMat2D<T>X_mat(1, d);
-    copy(X_mat.getData(), X.getData(), d);
-        
-    gMat2D<T>y_mat(1, t);
-    copy(y_mat.getData(), y.getData(), t);
-    
-    GurlsOptionsList* ret = optimizer.execute(X_mat, y_mat, *(this->opt));
+    GurlsOptionsList* ret = optimizer.execute(X, y, *(this->opt));
     this->opt->removeOpt("optimizer");
     this->opt->addOpt("optimizer", ret);
 
+    const unsigned long n = X.rows();
+    nTot += n;
+
+    GurlsOptionsList* kernel = this->opt->template getOptAs<GurlsOptionsList>("kernel");
+    if(kernel->hasOpt("Xwin"))
+    {
+        // Write the samples that entered the window over the oldest ones
+        gMat2D<T>& Xwin = kernel->getOptValue<OptMatrix<gMat2D<T> > >("Xwin");
+        gMat2D<T>& ywin = kernel->getOptValue<OptMatrix<gMat2D<T> > >("ywin");
+        double& winpos = kernel->getOptValue<OptNumber>("winpos");
+        double& wincount = kernel->getOptValue<OptNumber>("wincount");
+
+        const unsigned long wsize = Xwin.rows();
+        const unsigned long d = Xwin.cols();
+        const unsigned long t = ywin.cols();
+
+        unsigned long pos = static_cast<unsigned long>(winpos);
+        for(unsigned long i=(n > wsize)? n-wsize : 0; i<n; ++i, pos=(pos+1)%wsize)
+        {
+            copy(Xwin.getData()+pos, X.getData()+i, d, wsize, n);
+            copy(ywin.getData()+pos, y.getData()+i, t, wsize, n);
+        }
+
+        winpos = pos;
+        wincount = std::min(wsize, static_cast<unsigned long>(wincount)+n);
+    }
 }
 
 template <typename T>
@@ -115,4 +166,10 @@ template <typename T>
 void RecursiveRLSCholUpdateWrapper<T>::retrain()
 {}
 
+template <typename T>
+void RecursiveRLSCholUpdateWrapper<T>::setWindowSize(unsigned long value)
+{
+    this->opt->template getOptValue<OptNumber>("windowsize") = value;
+}
+
 }
@@ -44,6 +44,7 @@
 #define _GURLS_RLSGP_H_
 
 #include <cmath>
+#include <sstream>
 
 #include "gurls++/optimization.h"
 
@@ -95,9 +96,6 @@ GurlsOptionsList* RLSGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y,
 
     const gMat2D<T> &K_mat = opt.getOptValue<OptMatrix<gMat2D<T> > >("kernel.K");
 
-    T* K = new T[K_mat.getSize()];
-    copy(K, K_mat.getData(), K_mat.getSize());
-
     //n = size(opt.kernel.K,1);
     const unsigned long n = K_mat.rows();
 
@@ -106,13 +104,29 @@ GurlsOptionsList* RLSGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y,
 
 
     //    cfr.L = chol(opt.kernel.K + noise^2*eye(n));
+    // the factor is computed in place in the matrix stored in the optimizer
+    gMat2D<T>* L = new gMat2D<T>(K_mat);
+    T* retL = L->getData();
+
     const T coeff = std::pow(noiselevel, 2);
     unsigned long i=0;
-    for(T* it = K; i<n; ++i, it += n+1)
+    for(T* it = retL; i<n; ++i, it += n+1)
         *it += coeff;
 
-    T* retL = new T[n*n];
-    cholesky(K, n, n, retL);
+    char uplo = 'U';
+    int nn = static_cast<int>(n);
+    int info;
+    potrf_(&uplo, &nn, retL, &nn, &info);
+    if(info != 0)
+    {
+        delete L;
+
+        std::stringstream str;
+        str << "Cholesky factorization failed, error code " << info << ";" << std::endl;
+        throw gException(str.str());
+    }
+
+    clearLowerTriangular(retL, n, n);
 
     //    cfr.alpha = cfr.L\(cfr.L'\y);
     gMat2D<T>* alpha = new gMat2D<T>(n, t);
@@ -125,12 +139,8 @@ GurlsOptionsList* RLSGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y,
     GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
 
 //           optimizer.L = L;
-    gMat2D<T>* L = new gMat2D<T>(n, n);
-    copy(L->getData(), retL, L->getSize());
     optimizer->addOpt("L", new OptMatrix<gMat2D<T> >(*L));
 
-    delete[] retL;
-
 //           optimizer.alpha = alpha;
     optimizer->addOpt("alpha", new OptMatrix<gMat2D<T> >(*alpha));
 
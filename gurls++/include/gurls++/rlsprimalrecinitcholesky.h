@@ -161,32 +161,12 @@ GurlsOptionsList* RLSPrimalRecInitCholesky<T>::execute(const gMat2D<T>& X, const
     gMat2D<T> *b = new gMat2D<T>(Xty, d, t, 1);
     
     delete[] XtX;
+    delete[] Xty;
+    delete[] R;
     
     //Save results in OPT
     GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
-    
 
-    std::cout << "W:" << std::endl;
-    std::cout << *W << std::endl;
-    std::cout << "b:" << std::endl;
-    std::cout << *b << std::endl;
-    std::cout << "R:" << std::endl;
-    std::cout << *R_mat << std::endl;
-    // DEBUG ///////////////////
-//     std::cout << "-----------------------------------------------" << std::endl;
-//     std::cout << "----- Initial R (10x10 submatrix) -----" << std::endl;
-//     std::cout.precision(3);
-//     std::cout.width(5);
-//     for (int foo = 0; foo < 8 ; foo++){
-//         for (int bar = 0; bar < 8; bar++){
-//      
-//             std::cout<< (*R_mat)(foo , bar) << "\t";
-//         }
-//         std::cout << std::endl;
-//     }
-//     std::cout << "-----------------------------------------------" << std::endl;
-    ////////////////////////////
-    
     //  cfr.W = W;
     optimizer->addOpt("W", new OptMatrix<gMat2D<T> >(*W));
 
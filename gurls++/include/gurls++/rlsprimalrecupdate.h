@@ -64,12 +64,20 @@ public:
     /**
      * Computes a classifier for the primal formulation of RLS, using a
      * recursive update, starting from an initial estimator found in opt.optimizer.
+     * Rows of X are absorbed in blocks of k samples at a time through the
+     * Woodbury identity, so that each block costs a k-by-k Cholesky solve
+     * and a few level 3 BLAS calls instead of k rank-1 updates.
+     * With a forgetting factor beta < 1 the estimator minimizes the exponentially
+     * weighted loss, i.e. before each sample is absorbed C = X'*X + n*lambda*I is
+     * scaled by beta (Cinv by 1/beta), so that old samples fade out at O(d^2) cost per sample.
      *
      * \param X input data matrix
      * \param Y labels matrix
      * \param opt options with the following fields that need to be set through previous gurls++ tasks:
      *  - optimizer.W (settable with the class RLSPrimalRecInit)
      *  - optimizer.Cinv (settable with the class RLSPrimalRecInit)
+     *  - recblocksize (default 64), maximum number of samples k per Woodbury update
+     *  - forgettingfactor (default 1), forgetting factor beta in (0,1]
      *
      * \return adds to opt the field optimizer which is a list containing the following fields:
      *  - W = matrix of coefficient vectors of rls estimator for each class
@@ -78,19 +86,26 @@ public:
      *  - Cinv = inverse of the regularized kernel matrix in the primal space
      */
     GurlsOptionsList* execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList& opt);
+
+    /**
+     * Performs the same recursive update as execute(), but in place on the estimator W and
+     * on the inverse Cinv, without copying them
+     *
+     * \param X input data matrix
+     * \param Y labels matrix
+     * \param opt options with the fields recblocksize and forgettingfactor, as in execute()
+     * \param W d-by-t matrix of coefficient vectors, updated in place
+     * \param Cinv d-by-d inverse of the regularized kernel matrix in the primal space, updated in place
+     *
+     * If the update fails, W and Cinv may be left partially updated.
+     */
+    static void update(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList& opt, gMat2D<T>& W, gMat2D<T>& Cinv);
 };
 
 
 template <typename T>
 GurlsOptionsList* RLSPrimalRecUpdate<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList &opt)
 {
-    //	[n,d] = size(X);
-
-    const unsigned long n = X.rows();
-    const unsigned long d = X.cols();
-
-    const unsigned long t = Y.cols();
-
     //  W = opt.rls.W;
     const gMat2D<T>& prev_W = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
     gMat2D<T>* W = new gMat2D<T>(prev_W);
@@ -99,52 +114,16 @@ GurlsOptionsList* RLSPrimalRecUpdate<T>::execute(const gMat2D<T>& X, const gMat2
     const gMat2D<T>& prev_Cinv = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.Cinv");
     gMat2D<T>* Cinv = new gMat2D<T>(prev_Cinv);
 
-    T* WData = W->getData();
-    const unsigned long wn = W->rows();
-    const unsigned long wd = W->cols();
-
-
-    T* CinvData = Cinv->getData();
-    const unsigned long cn = Cinv->rows();
-    const unsigned long cd = Cinv->cols();
-
-    T* Cx = new T[cn];
-    T* x = new T[d];
-    T* y = new T[t];
-    T xCx;
-    T* CxCxt = new T[cn*cn];
-    T* xW = new T[wd];
-    T* Cxy = new T[cn*t];
-
-    for(unsigned long i=0; i<n; ++i)
+    try
     {
-        getRow(X.getData(), n, d, i, x);
-        getRow(Y.getData(), n, t, i, y);
-
-        //  Cx = Cinv*X(i,:)';
-        gemv(CblasNoTrans, cn, cd, (T)1.0, CinvData, cn, x, 1, (T)0.0, Cx, 1);
-
-        //  xCx = X(i,:)*Cx;
-        gemv(CblasNoTrans, 1, d, (T)1.0, x, 1, Cx, 1, (T)0.0, &xCx, 1);
-
-        //  Cinv = Cinv - Cx*Cx'./(1+xCx);
-        dot(Cx, Cx, CxCxt, cn, 1, cn, 1, cn, cn, CblasNoTrans, CblasTrans, CblasColMajor);
-        axpy(cn*cn, (T)(-1.0/(xCx+1)), CxCxt, 1, CinvData, 1);
-
-
-        //  W = W +(Cx*(y(i,:)-X(i,:)*W))./(1+xCx);
-        dot(x, WData, xW, 1, d, wn, wd, 1, wd, CblasNoTrans, CblasNoTrans, CblasColMajor);
-        axpy(t, (T)-1.0, xW, 1, y, 1);
-        dot(Cx, y, Cxy, cn, 1, 1, t, cn, t, CblasNoTrans, CblasNoTrans, CblasColMajor);
-        axpy(cn*t, (T)(1.0/(xCx+1)), Cxy, 1, WData, 1);
+        update(X, Y, opt, *W, *Cinv);
+    }
+    catch(gException&)
+    {
+        delete W;
+        delete Cinv;
+        throw;
     }
-
-    delete[] Cx;
-    delete[] x;
-    delete[] y;
-    delete[] CxCxt;
-    delete[] xW;
-    delete[] Cxy;
 
 
     GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
@@ -166,6 +145,104 @@ GurlsOptionsList* RLSPrimalRecUpdate<T>::execute(const gMat2D<T>& X, const gMat2
     return optimizer;
 }
 
+template <typename T>
+void RLSPrimalRecUpdate<T>::update(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList& opt, gMat2D<T>& W, gMat2D<T>& Cinv)
+{
+    //	[n,d] = size(X);
+
+    const unsigned long n = X.rows();
+    const unsigned long d = X.cols();
+
+    const unsigned long t = Y.cols();
+
+    if(Cinv.rows() != d || Cinv.cols() != d || W.rows() != d || W.cols() != t)
+        throw gException(Exception_Inconsistent_Size);
+
+    unsigned long blocksize = opt.hasOpt("recblocksize")? static_cast<unsigned long>(opt.getOptAsNumber("recblocksize")) : 64ul;
+    blocksize = std::max(1ul, std::min(blocksize, n));
+
+    const T beta = opt.hasOpt("forgettingfactor")? static_cast<T>(opt.getOptAsNumber("forgettingfactor")) : (T)1.0;
+    if(!(beta > (T)0.0 && beta <= (T)1.0))
+        throw gException(Exception_Illegal_Argument_Value);
+
+    T* WData = W.getData();
+    T* CinvData = Cinv.getData();
+    const T* XData = X.getData();
+    const T* YData = Y.getData();
+
+    T* Xbt = new T[d*blocksize];
+    T* P = new T[d*blocksize];
+    T* S = new T[blocksize*blocksize];
+    T* R = new T[blocksize*t];
+
+    char uplo = 'L';
+
+    for(unsigned long i=0; i<n; i+=blocksize)
+    {
+        // Xb = X(i:i+k-1,:), accessed in place with leading dimension n
+        const int k = static_cast<int>(std::min(blocksize, n-i));
+        const T* Xb = XData + i;
+
+        //  Xbt = Xb';
+        for(int j=0; j<k; ++j)
+            copy(Xbt + j*d, Xb + j, d, 1, n);
+
+        //  P = Cinv*Xbt;   (only the lower triangle of Cinv is kept up to date)
+        symm(CblasLeft, CblasLower, d, k, (T)1.0, CinvData, d, Xbt, d, (T)0.0, P, d);
+
+        //  S = diag(beta.^(1:k)) + Xb*P;
+        //  (sample j of the block is weighted beta^(k-1-j) relative to the new C = beta^k*C + ...)
+        set(S, (T)0.0, k*k);
+        T weight = beta;
+        for(int j=0; j<k; ++j, weight*=beta)
+            S[j*(k+1)] = weight;
+        gemm(CblasTrans, CblasNoTrans, k, k, d, (T)1.0, Xbt, d, P, d, (T)1.0, S, k);
+
+        //  R = y(i:i+k-1,:) - Xb*W;
+        for(unsigned long j=0; j<t; ++j)
+            copy(R + j*k, YData + i + j*n, k);
+        gemm(CblasTrans, CblasNoTrans, k, t, d, (T)-1.0, Xbt, d, WData, d, (T)1.0, R, k);
+
+        //  L = chol(S, 'lower');
+        int info;
+        int kk = k;
+        potrf_(&uplo, &kk, S, &kk, &info);
+        if(info != 0)
+        {
+            delete[] Xbt;
+            delete[] P;
+            delete[] S;
+            delete[] R;
+
+            std::stringstream str;
+            str << "Cholesky factorization failed, error code " << info << ";" << std::endl;
+            throw gException(str.str());
+        }
+
+        //  R = S\R;
+        trsm(CblasLeft, CblasLower, CblasNoTrans, CblasNonUnit, k, t, (T)1.0, S, k, R, k);
+        trsm(CblasLeft, CblasLower, CblasTrans, CblasNonUnit, k, t, (T)1.0, S, k, R, k);
+
+        //  W = W + P*R;
+        gemm(CblasNoTrans, CblasNoTrans, d, t, k, (T)1.0, P, d, R, k, (T)1.0, WData, d);
+
+        //  P = P/L';   Cinv = Cinv - P*P';
+        trsm(CblasRight, CblasLower, CblasTrans, CblasNonUnit, d, k, (T)1.0, S, k, P, d);
+        syrk(CblasLower, CblasNoTrans, d, k, (T)-1.0, P, d, (T)1.0, CinvData, d);
+
+        //  Cinv = Cinv/beta^k;
+        if(beta != (T)1.0)
+            scal(d*d, (T)1.0/std::pow(beta, static_cast<T>(k)), CinvData, 1);
+    }
+
+    copyLowerToUpper(CinvData, d);
+
+    delete[] Xbt;
+    delete[] P;
+    delete[] S;
+    delete[] R;
+}
+
 
 }
 #endif // _GURLS_RLSPRIMALRECUPDATE_H_
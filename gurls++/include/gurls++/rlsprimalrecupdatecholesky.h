@@ -67,6 +67,16 @@ public:
     /**
      * Computes a classifier for the primal formulation of RLS, using a
      * recursive Cholesky update, starting from an initial estimator found in opt.optimizer.
+     * The rows of X are folded into R with blocked rank-k Givens updates, so each
+     * sample costs O(d^2) operations and no memory is allocated inside the update loop.
+     *
+     * If a window of past samples is found in opt.kernel, the estimator is fit on a
+     * sliding window: the oldest samples of the window are removed from R and b with
+     * rank-1 downdates as the new ones come in, again at O(d^2) cost per sample.
+     * The window is a ring buffer of windowsize rows, holding wincount samples the
+     * oldest of which is at row mod(winpos-wincount, windowsize). The window itself is
+     * not modified: the caller is expected to write the last min(n, windowsize) rows
+     * of X and Y into it (see RecursiveRLSCholUpdateWrapper).
      *
      * \param X input data matrix
      * \param Y labels matrix
@@ -74,6 +84,9 @@ public:
      *  - optimizer.W (settable with the class RLSPrimalRecInitCholesky)
      *  - optimizer.R (settable with the class RLSPrimalRecInitCholesky)
      *  - optimizer.b (settable with the class RLSPrimalRecInitCholesky)
+     *  - recblocksize (default 64), maximum number of samples per rank-k update
+     *  - kernel.Xwin, kernel.ywin (optional) windowsize-by-d and windowsize-by-t ring buffers of the samples in the window
+     *  - kernel.winpos, kernel.wincount (needed with kernel.Xwin) next row to be written in the ring buffers and number of samples they hold
      *
      * \return adds to opt the field optimizer which is a list containing the following fields:
      *  - W = updated matrix of coefficient vectors of rls estimator for each class
@@ -86,7 +99,7 @@ public:
 
 template <typename T>
 GurlsOptionsList* RLSPrimalRecUpdateCholesky<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList &opt)
-{   
+{
     // Get significant sizes
     //	[n,d] = size(X);
 
@@ -94,72 +107,124 @@ GurlsOptionsList* RLSPrimalRecUpdateCholesky<T>::execute(const gMat2D<T>& X, con
     const unsigned long d = X.cols();
     const unsigned long t = Y.cols();
 
-    // Xty = X'*y;
-    T* Xty;
-    Xty = new T[d*t];
-    dot(X.getData(), Y.getData(), Xty, n, d, n, t, d, t, CblasTrans, CblasNoTrans, CblasColMajor);
-    
     // Retrieve previous W, R, b
-    
+
     //  W = opt.rls.W;
     const gMat2D<T>& prev_W = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
     gMat2D<T>* W = new gMat2D<T>(prev_W);
-    
+
     //  R = opt.rls.R;
     const gMat2D<T>& prev_R = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.R");
     gMat2D<T>* R = new gMat2D<T>(prev_R);
-    
+
     //  b = opt.rls.b;
     const gMat2D<T>& prev_b = opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.b");
     gMat2D<T>* b = new gMat2D<T>(prev_b);
-    
+
+    if(R->rows() != d || R->cols() != d || b->rows() != d || b->cols() != t || Y.rows() != n)
+    {
+        delete W;
+        delete R;
+        delete b;
+        throw gException(Exception_Inconsistent_Size);
+    }
+
+    const gMat2D<T>* Xwin = NULL;
+    const gMat2D<T>* ywin = NULL;
+    unsigned long wsize = 0;
+    unsigned long first = 0;    // rows of X before first would leave the window before the end of the update
+    unsigned long nleave = 0;   // number of samples removed from the window
+    unsigned long oldest = 0;   // ring buffer row of the oldest sample in the window
+
+    if(opt.hasOpt("kernel.Xwin"))
+    {
+        Xwin = &(opt.getOptValue<OptMatrix<gMat2D<T> > >("kernel.Xwin"));
+        ywin = &(opt.getOptValue<OptMatrix<gMat2D<T> > >("kernel.ywin"));
+        wsize = Xwin->rows();
+
+        const unsigned long winpos = static_cast<unsigned long>(opt.getOptAsNumber("kernel.winpos"));
+        const unsigned long wincount = static_cast<unsigned long>(opt.getOptAsNumber("kernel.wincount"));
+
+        if(wsize == 0 || Xwin->cols() != d || ywin->rows() != wsize || ywin->cols() != t || wincount > wsize)
+        {
+            delete W;
+            delete R;
+            delete b;
+            throw gException(Exception_Inconsistent_Size);
+        }
+
+        first = (n > wsize)? n-wsize : 0;
+        nleave = std::min(wincount, std::max(wincount+(n-first), wsize) - wsize);
+        oldest = (winpos+wsize-wincount) % wsize;
+    }
+
+    const unsigned long nadd = n-first;
+    const T* Xadd = X.getData()+first;
+
+    // Update b
+    // b = b + X(first:end,:)'*y(first:end,:);
+    gemm(CblasTrans, CblasNoTrans, d, t, nadd, (T)1.0, Xadd, n, Y.getData()+first, n, (T)1.0, b->getData(), d);
+
     // Update R
-    for(unsigned long i=0; i<n; i++)
+    // R = cholupdate(R, X(i:i+k-1,:))
+    unsigned long blocksize = opt.hasOpt("recblocksize")? static_cast<unsigned long>(opt.getOptAsNumber("recblocksize")) : 64ul;
+    blocksize = std::max(1ul, std::min(blocksize, nadd));
+
+    T* work = new T[std::max(cholupdateWorkSize(d, blocksize), choldowndateWorkSize(d))];
+
+    for(unsigned long i=0; i<nadd; i+=blocksize)
+        cholupdate(R->getData(), d, Xadd+i, n, std::min(blocksize, nadd-i), work);
+
+    // Downdate R and b with the samples leaving the window
+    // R = choldowndate(R, Xwin(j,:));   b = b - Xwin(j,:)'*ywin(j,:);
+    for(unsigned long i=0; i<nleave; ++i)
     {
-        // Get pointer to the i-th input
-//         gVec<T> v( X[i] );
-//         double* input =  v.getData();
-        double* input = (double*) X.getData() + i;
-        
-        // Rank-1 Cholesky update of R
-        cholupdate(*R, *input, 1);
-
-        // Update b = b + X[i]ty
-        // TODO: Maybe the update of b can be done in 1-shot outside the for loop.
-        gMat2D<T> transposedinput(d, 1);
-        X.transpose(transposedinput);
-        gMat2D<T> res( d , t );          // Temporary variable for result storage
-        
-        dot( transposedinput , Y , res );
-        *b = (*b) + res;
+        const unsigned long j = (oldest+i) % wsize;
+        const T* xj = Xwin->getData()+j;
+
+        try
+        {
+            choldowndate(R->getData(), d, xj, wsize, work);
+        }
+        catch(gException&)
+        {
+            delete[] work;
+            delete W;
+            delete R;
+            delete b;
+            throw;
+        }
+
+        for(unsigned long k=0; k<t; ++k)
+            axpy(d, -ywin->getData()[j+k*wsize], xj, wsize, b->getData()+k*d, 1);
     }
 
+    delete[] work;
+
     // Update W
-    
+
     copy(W->getData(), b->getData(), W->getSize());
-    
+
     // Forward substitution
-    mldivide_squared(R->getData(), W->getData(), d, d, W->rows(), W->cols(), CblasTrans);    //(R'\Xty) 
-    
+    mldivide_squared(R->getData(), W->getData(), d, d, W->rows(), W->cols(), CblasTrans);    //(R'\Xty)
+
     // Backward substitution
-    mldivide_squared(R->getData(), W->getData(), d, d, W->rows(), W->cols(), CblasNoTrans);  //R\(R'\Xty)     
+    mldivide_squared(R->getData(), W->getData(), d, d, W->rows(), W->cols(), CblasNoTrans);  //R\(R'\Xty)
 
     GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
 
     // cfr.R = R;
     optimizer->addOpt("R", new OptMatrix<gMat2D<T> >(*R));
-    
+
     //  cfr.W = W;
     optimizer->addOpt("W", new OptMatrix<gMat2D<T> >(*W));
 
     //  cfr.b = b;
     optimizer->addOpt("b", new OptMatrix<gMat2D<T> >(*b));
-    
-    delete[] Xty;
-    
+
     return optimizer;
 }
 
 
 }
-#endif // _GURLS_RLSPRIMALRECUPDATE_H_
+#endif // _GURLS_RLSPRIMALRECUPDATECHOLESKY_H_
@@ -80,8 +80,12 @@ public:
      *  - singlelambda
      *  - randfeats.D
      *  - randfeats.samplesize
+     *  - randfeats.type (optional, "gaussian" by default; see \ref rp_projections)
+     *  - randfeats.seed (optional, seed of the random projections)
      *
      * \return adds to opt the field optimizer, which is a list containing the following fields:
+     *  - proj: parameters of the random projections
+     *  - projtype: type of the random projections
      *  - W: matrix of coefficient vectors of rls estimator for each class
      *  - C: empty matrix
      *  - X: empty matrix
@@ -99,6 +103,8 @@ GurlsOptionsList* RLSRandFeats<T>::execute(const gMat2D<T>& X, const gMat2D<T>&
 
     const unsigned long sampleSize = opt.getOptAsNumber("randfeats.samplesize");
     const unsigned long D = opt.getOptAsNumber("randfeats.D");
+    const std::string projType = opt.hasOpt("randfeats.type")? opt.getOptAsString("randfeats.type") : "gaussian";
+    const unsigned long seed = opt.hasOpt("randfeats.seed")? static_cast<unsigned long>(opt.getOptAsNumber("randfeats.seed")) : 5489u;
 
 //    n = size(X,1);
     const unsigned long n = X.rows();
@@ -119,7 +125,7 @@ GurlsOptionsList* RLSRandFeats<T>::execute(const gMat2D<T>& X, const gMat2D<T>&
     T *Xty = new T[D2*t];
 
 //    [XtX,Xty,rls.proj] = rp_factorize_large_real(X,y,opt.randfeats.D,ni);
-    gMat2D<T> *rls_proj = rp_factorize_large_real(X, Y, D, ni, XtX, Xty);
+    gMat2D<T> *rls_proj = rp_factorize_large_real(X, Y, D, ni, XtX, Xty, projType, seed);
 
 //    rls.W = rls_primal_driver( XtX, Xty, n, lambda );
     gMat2D<T> *W = rls_primal_driver(XtX, Xty, D2, D2, t, lambda);
@@ -131,6 +137,7 @@ GurlsOptionsList* RLSRandFeats<T>::execute(const gMat2D<T>& X, const gMat2D<T>&
 
 
     optimizer->addOpt("proj", new OptMatrix<gMat2D<T> >(*rls_proj));
+    optimizer->addOpt("projtype", new OptString(projType));
 
 //    rls.W = rls_primal_driver( XtX, Xty, n, lambda );
     optimizer->addOpt("W", new OptMatrix<gMat2D<T> >(*W));
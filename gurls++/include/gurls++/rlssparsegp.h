@@ -0,0 +1,330 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * authors:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#ifndef _GURLS_RLSSPARSEGP_H_
+#define _GURLS_RLSSPARSEGP_H_
+
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "gurls++/optimization.h"
+
+#include "gurls++/gmath.h"
+#include "gurls++/gmat2d.h"
+#include "gurls++/options.h"
+#include "gurls++/optlist.h"
+#include "gurls++/optfunction.h"
+#include "gurls++/utils.h"
+
+namespace gurls {
+
+/**
+ * \ingroup Optimization
+ * \brief RLSSparseGPRegr is the sub-class of Optimizer that implements sparse GP inference
+ * with m inducing points, in the DTC or FITC approximation
+ */
+
+template <typename T>
+class RLSSparseGPRegr: public Optimizer<T>{
+
+public:
+    /**
+     * Performs sparse GP inference with m inducing points Z, in O(n*m^2) time and O(n*m) memory.
+     * The training kernel is approximated by Q = Knm*inv(Kmm)*Kmn, and the noise covariance is
+     * noise^2*I (DTC) or noise^2*I + diag(K-Q) (FITC).
+     * The noiselevel is set to the one found in the field paramsel of opt.
+     * In case of multiclass problems, the noiselevel needs to be combined with the function specified in the field singlelambda of opt
+     *
+     * \param X input data matrix
+     * \param Y labels matrix
+     * \param opt options with the following:
+     *  - singlelambda (default)
+     *  - paramsel (settable with the class ParamSelection and its subclasses, and containing field noiselevels, and sigma for the rbf kernel)
+     *  - kernel (list with the field type, either 'rbf' or 'linear')
+     *  - sparsegp (default, list with the fields m, approx ('fitc' or 'dtc'), selection ('uniform' or 'kmeans++') and seed)
+     *
+     * \return adds to opt the field optimizer, which is a list containing the following fields:
+     *  - X = inducing points
+     *  - L = upper Cholesky factor of Kmm
+     *  - LA = upper Cholesky factor of I + L'\Kmn*inv(Lambda)*Knm/L
+     *  - alpha
+     */
+    GurlsOptionsList *execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList &opt);
+};
+
+
+template <typename T>
+GurlsOptionsList* RLSSparseGPRegr<T>::execute(const gMat2D<T>& X, const gMat2D<T>& Y, const GurlsOptionsList& opt)
+{
+    //    noise = opt.singlelambda(opt.paramsel.lambdas);
+    const gMat2D<T> &ll = opt.getOptValue<OptMatrix<gMat2D<T> > >("paramsel.lambdas");
+    T noiselevel = opt.getOptAs<OptFunction>("singlelambda")->getValue(ll.getData(), ll.getSize());
+    const T noise2 = noiselevel*noiselevel;
+
+    const std::string kernelType = opt.getOptAsString("kernel.type");
+    const bool linear = (kernelType == "linear");
+    if(!linear && kernelType != "rbf")
+        throw gException(Exception_Required_Parameter_Missing);
+
+    const double sigma = linear? 1.0: opt.getOptAsNumber("paramsel.sigma");
+
+    const GurlsOptionsList* sparsegp = opt.getOptAs<GurlsOptionsList>("sparsegp");
+    const std::string approx = sparsegp->getOptAsString("approx");
+    const std::string selection = sparsegp->getOptAsString("selection");
+    const unsigned long seed = static_cast<unsigned long>(sparsegp->getOptAsNumber("seed"));
+
+    if(approx != "fitc" && approx != "dtc")
+        throw gException(Exception_Illegal_Argument_Value);
+
+    const bool fitc = (approx == "fitc");
+
+    //n = size(X,1);
+    const unsigned long n = X.rows();
+    const unsigned long d = X.cols();
+
+    //T = size(y,2);
+    const unsigned long t = Y.cols();
+
+    const unsigned long m = std::min(n, static_cast<unsigned long>(sparsegp->getOptAsNumber("m")));
+    if(m == 0)
+        throw gException(Exception_Illegal_Argument_Value);
+
+    //    idx = inducing point indices;
+    std::vector<unsigned long> idx(m);
+
+    if(selection == "kmeans++")
+        kmeanspp_seeds(kernelType, sigma, X.getData(), n, d, m, seed, &idx[0]);
+    else if(selection == "uniform")
+    {
+        // partial Fisher-Yates shuffle
+#if   BOOST_VERSION < 104700
+        boost::mt19937 gen(static_cast<boost::uint32_t>(seed));
+#else
+        boost::random::mt19937 gen(static_cast<boost::uint32_t>(seed));
+#endif
+        std::vector<unsigned long> perm(n);
+        for(unsigned long i=0; i<n; ++i)
+            perm[i] = i;
+
+        for(unsigned long i=0; i<m; ++i)
+        {
+            const unsigned long j = i + static_cast<unsigned long>(gen()%(n-i));
+            std::swap(perm[i], perm[j]);
+            idx[i] = perm[i];
+        }
+    }
+    else
+        throw gException(Exception_Illegal_Argument_Value);
+
+    //    Z = X(idx,:);
+    gMat2D<T>* Z = new gMat2D<T>(m, d);
+    T* Zbuf = Z->getData();
+    for(unsigned long j=0; j<d; ++j)
+        for(unsigned long i=0; i<m; ++i)
+            Zbuf[i+m*j] = X.getData()[idx[i]+n*j];
+
+    T* zn = new T[m];
+    sum_col_squared(Zbuf, zn, m, d);
+
+    //    L = chol(Kmm + jitter*eye(m));
+    T* Kmm = new T[m*m];
+    kernel_block(kernelType, sigma, Zbuf, m, m, zn, Zbuf, m, m, zn, d, Kmm, m);
+
+    T meandiag = 0;
+    for(unsigned long i=0; i<m; ++i)
+        meandiag += Kmm[i*(m+1)];
+    meandiag /= m;
+
+    const T jitter = std::sqrt(std::numeric_limits<T>::epsilon())*std::max(meandiag, (T)1.0);
+    for(unsigned long i=0; i<m; ++i)
+        Kmm[i*(m+1)] += jitter;
+
+    gMat2D<T>* L = new gMat2D<T>(m, m);
+    cholesky(Kmm, m, m, L->getData());
+    delete [] Kmm;
+
+    const T* Lbuf = L->getData();
+
+    // A = V'*inv(Lambda)*V and b = V'*inv(Lambda)*y, with V = Knm/L, accumulated on blocks of rows
+    T* xn = new T[n];
+    sum_col_squared(X.getData(), xn, n, d);
+
+    T* A = new T[m*m];
+    set(A, (T)0.0, m*m);
+
+    gMat2D<T>* alpha = new gMat2D<T>(m, t);
+    T* b = alpha->getData();
+    set(b, (T)0.0, m*t);
+
+    const unsigned long blocksize = std::min(n, predict_kernel_blocksize(m));
+    const long nblocks = static_cast<long>((n+blocksize-1)/blocksize);
+
+#ifdef _OPENMP
+    const int nthreads = static_cast<int>(std::min(static_cast<long>(omp_get_max_threads()), nblocks));
+#else
+    const int nthreads = 1;
+#endif
+
+    // partial products of the threads other than the first one, which updates A and b directly
+    const unsigned long partialSize = m*m + m*t;
+    T* partial = NULL;
+    if(nthreads > 1)
+    {
+        partial = new T[(nthreads-1)*partialSize];
+        set(partial, (T)0.0, (nthreads-1)*partialSize);
+    }
+
+#pragma omp parallel num_threads(nthreads)
+    {
+#ifdef _OPENMP
+        const int tid = omp_get_thread_num();
+#else
+        const int tid = 0;
+#endif
+        T* A_t = (tid == 0)? A : partial + (tid-1)*partialSize;
+        T* b_t = (tid == 0)? b : partial + (tid-1)*partialSize + m*m;
+
+        T* V = new T[blocksize*m];
+        T* yb = new T[blocksize*t];
+        T* w = new T[blocksize];
+
+#pragma omp for schedule(static)
+        for(long bl=0; bl<nblocks; ++bl)
+        {
+            const unsigned long i0 = bl*blocksize;
+            const unsigned long rows = std::min(blocksize, n-i0);
+
+//            V = K(X(i0:i0+rows-1,:), Z)/L;
+            kernel_block(kernelType, sigma, X.getData()+i0, n, rows, xn+i0, Zbuf, m, m, zn, d, V, rows);
+            trsm(CblasRight, CblasUpper, CblasNoTrans, CblasNonUnit, rows, m, (T)1.0, Lbuf, m, V, rows);
+
+//            w = 1./sqrt(noise^2 + diag(K - V*V'));
+            for(unsigned long i=0; i<rows; ++i)
+                w[i] = noise2;
+
+            if(fitc)
+            {
+                for(unsigned long i=0; i<rows; ++i)
+                    w[i] += linear? xn[i0+i]: (T)1.0;
+
+                for(unsigned long j=0; j<m; ++j)
+                {
+                    const T* Vj = V + j*rows;
+                    for(unsigned long i=0; i<rows; ++i)
+                        w[i] -= Vj[i]*Vj[i];
+                }
+
+                for(unsigned long i=0; i<rows; ++i)
+                    w[i] = std::max(w[i], noise2);
+            }
+
+            for(unsigned long i=0; i<rows; ++i)
+                w[i] = (T)1.0/std::sqrt(w[i]);
+
+//            V = diag(w)*V;  yb = diag(w)*y(i0:i0+rows-1,:);
+            for(unsigned long j=0; j<m; ++j)
+            {
+                T* Vj = V + j*rows;
+                for(unsigned long i=0; i<rows; ++i)
+                    Vj[i] *= w[i];
+            }
+
+            for(unsigned long j=0; j<t; ++j)
+            {
+                T* ybj = yb + j*rows;
+                const T* yj = Y.getData() + i0 + j*n;
+                for(unsigned long i=0; i<rows; ++i)
+                    ybj[i] = w[i]*yj[i];
+            }
+
+//            A = A + V'*V;
+            syrk(CblasUpper, CblasTrans, m, rows, (T)1.0, V, rows, (T)1.0, A_t, m);
+
+//            b = b + V'*yb;
+            gemm(CblasTrans, CblasNoTrans, m, t, rows, (T)1.0, V, rows, yb, rows, (T)1.0, b_t, m);
+        }
+
+        delete [] V;
+        delete [] yb;
+        delete [] w;
+    }
+
+    for(int k=1; k<nthreads; ++k)
+    {
+        const T* A_k = partial + (k-1)*partialSize;
+        for(unsigned long j=0; j<m; ++j)
+            axpy(j+1, (T)1.0, A_k + j*m, 1, A + j*m, 1);
+
+        axpy(m*t, (T)1.0, A_k + m*m, 1, b, 1);
+    }
+
+    delete [] partial;
+    delete [] xn;
+    delete [] zn;
+
+    //    LA = chol(eye(m) + A);
+    for(unsigned long i=0; i<m; ++i)
+        A[i*(m+1)] += (T)1.0;
+
+    gMat2D<T>* LA = new gMat2D<T>(m, m);
+    cholesky(A, m, m, LA->getData());
+    delete [] A;
+
+    //    alpha = L\(LA\(LA'\b));
+    mldivide_squared(LA->getData(), b, m, m, m, t, CblasTrans);
+    mldivide_squared(LA->getData(), b, m, m, m, t, CblasNoTrans);
+    mldivide_squared(L->getData(), b, m, m, m, t, CblasNoTrans);
+
+
+    GurlsOptionsList* optimizer = new GurlsOptionsList("optimizer");
+
+    optimizer->addOpt("L", new OptMatrix<gMat2D<T> >(*L));
+    optimizer->addOpt("LA", new OptMatrix<gMat2D<T> >(*LA));
+    optimizer->addOpt("alpha", new OptMatrix<gMat2D<T> >(*alpha));
+    optimizer->addOpt("X", new OptMatrix<gMat2D<T> >(*Z));
+
+    return optimizer;
+}
+
+}
+#endif // _GURLS_RLSSPARSEGP_H_
@@ -0,0 +1,162 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef _GURLS_ROWBUFFER_H_
+#define _GURLS_ROWBUFFER_H_
+
+#include "gurls++/gmat2d.h"
+#include "gurls++/gmath.h"
+
+namespace gurls {
+
+/**
+  * \brief RowBuffer is a column-major matrix with a fixed number of columns
+  * to which rows can be appended in amortized O(cols) time.
+  *
+  * Rows are stored with a leading dimension larger than the number of rows,
+  * which grows geometrically when the buffer is full. If a maximum number of
+  * rows is given, the buffer becomes a ring buffer when it reaches that size
+  * and every new row overwrites the oldest one.
+  * The content can be accessed as a gMat2D through view(), which packs the
+  * columns in place and does not copy the buffer.
+  * \tparam T Cells type.
+  */
+template <typename T>
+class RowBuffer {
+
+public:
+
+    /**
+      * Initializes an empty buffer with c columns, holding at most maxRows rows
+      * (0 for an unbounded buffer)
+      */
+    RowBuffer(unsigned long c = 0, unsigned long maxRows = 0);
+
+    /**
+      * Destructor
+      */
+    ~RowBuffer();
+
+    /**
+      * Empties the buffer and sets the number of columns to c and the maximum
+      * number of rows to maxRows (0 for an unbounded buffer)
+      */
+    void reset(unsigned long c, unsigned long maxRows = 0);
+
+    /**
+      * Allocates room for r rows, so that the following appends do not allocate
+      * memory until the buffer holds r rows
+      */
+    void reserve(unsigned long r);
+
+    /**
+      * Appends a row, whose elements are stored with stride inc
+      */
+    void append(const T* row, unsigned long inc = 1);
+
+    /**
+      * Appends the n rows of the column-major matrix X with leading dimension ldx
+      */
+    void append(const T* X, unsigned long n, unsigned long ldx);
+
+    /**
+      * Appends a row, whose elements are stored with stride inc, multiplied by alpha
+      */
+    void appendScaled(const T* row, unsigned long inc, T alpha);
+
+    /**
+      * Multiplies all the rows by alpha
+      */
+    void scale(T alpha);
+
+    /**
+      * Returns the number of rows
+      */
+    unsigned long rows() const {return numrows; }
+
+    /**
+      * Returns the number of columns
+      */
+    unsigned long cols() const {return numcols; }
+
+    /**
+      * Returns the number of rows that can be held without allocating memory
+      */
+    unsigned long capacity() const {return numcols > 0? allocated/numcols : 0; }
+
+    /**
+      * Returns true if a row can be appended without allocating memory and without moving
+      * the rows already stored, which happens after view() has packed the buffer
+      */
+    bool hasRoom() const {return numrows < ld || (maxrows > 0 && numrows == maxrows); }
+
+    /**
+      * Returns a non-owning rows()-by-cols() matrix on the buffer content.
+      * Rows are in insertion order, unless the buffer has wrapped around as a ring buffer.
+      * The view is valid until the next call to a non-const method of the buffer.
+      */
+    const gMat2D<T>& view();
+
+protected:
+
+    T* data;                    ///< Pointer to the data buffer
+    unsigned long allocated;    ///< Data buffer length
+    unsigned long numcols;      ///< Number of columns
+    unsigned long numrows;      ///< Number of rows
+    unsigned long ld;           ///< Leading dimension
+    unsigned long maxrows;      ///< Maximum number of rows, 0 if unbounded
+    unsigned long next;         ///< Next row to be overwritten when the ring buffer is full
+    gMat2D<T>* matview;         ///< Matrix returned by view()
+
+    /**
+      * Sets the leading dimension to newld, reallocating the buffer if needed
+      */
+    void relayout(unsigned long newld);
+
+private:
+
+    RowBuffer(const RowBuffer<T>&);
+    RowBuffer<T>& operator=(const RowBuffer<T>&);
+};
+
+}
+
+#include "rowbuffer.hpp"
+
+#endif // _GURLS_ROWBUFFER_H_
@@ -0,0 +1,179 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+namespace gurls {
+
+template <typename T>
+RowBuffer<T>::RowBuffer(unsigned long c, unsigned long maxRows): data(NULL), allocated(0), numcols(c),
+    numrows(0), ld(0), maxrows(maxRows), next(0), matview(NULL) {}
+
+template <typename T>
+RowBuffer<T>::~RowBuffer()
+{
+    delete matview;
+    delete[] data;
+}
+
+template <typename T>
+void RowBuffer<T>::reset(unsigned long c, unsigned long maxRows)
+{
+    delete matview;
+    matview = NULL;
+
+    if(c != numcols)
+    {
+        delete[] data;
+        data = NULL;
+        allocated = 0;
+    }
+
+    numcols = c;
+    numrows = 0;
+    ld = 0;
+    maxrows = maxRows;
+    next = 0;
+}
+
+template <typename T>
+void RowBuffer<T>::reserve(unsigned long r)
+{
+    if(maxrows > 0)
+        r = std::min(r, maxrows);
+
+    if(r > ld)
+        relayout(r);
+}
+
+template <typename T>
+void RowBuffer<T>::relayout(unsigned long newld)
+{
+    if(newld*numcols > allocated)
+    {
+        //  buffer = zeros(newld, c);   buffer(1:r,:) = data(1:r,:);
+        T* buffer = new T[newld*numcols];
+        for(unsigned long j=0; j<numcols; ++j)
+            std::copy(data+j*ld, data+j*ld+numrows, buffer+j*newld);
+
+        delete[] data;
+        data = buffer;
+        allocated = newld*numcols;
+    }
+    else if(newld > ld)
+    {
+        // spread the columns starting from the last one
+        for(unsigned long j=numcols; j-- > 1; )
+            std::copy_backward(data+j*ld, data+j*ld+numrows, data+j*newld+numrows);
+    }
+    else
+    {
+        // pack the columns starting from the first one
+        for(unsigned long j=1; j<numcols; ++j)
+            std::copy(data+j*ld, data+j*ld+numrows, data+j*newld);
+    }
+
+    ld = newld;
+}
+
+template <typename T>
+void RowBuffer<T>::append(const T* row, unsigned long inc)
+{
+    appendScaled(row, inc, (T)1.0);
+}
+
+template <typename T>
+void RowBuffer<T>::appendScaled(const T* row, unsigned long inc, T alpha)
+{
+    unsigned long i;
+
+    if(maxrows > 0 && numrows == maxrows)
+    {
+        i = next;
+        next = (next+1) % maxrows;
+    }
+    else
+    {
+        if(numrows == ld)
+        {
+            // use all the rows already allocated before allocating a larger buffer
+            unsigned long newld = (capacity() > ld)? capacity() : std::max(2*ld, 16ul);
+            if(maxrows > 0)
+                newld = std::min(newld, maxrows);
+
+            relayout(newld);
+        }
+
+        i = numrows++;
+    }
+
+    gurls::copy(data+i, row, numcols, ld, inc);
+
+    if(alpha != (T)1.0)
+        gurls::scal(numcols, alpha, data+i, ld);
+}
+
+template <typename T>
+void RowBuffer<T>::append(const T* X, unsigned long n, unsigned long ldx)
+{
+    for(unsigned long i=0; i<n; ++i)
+        append(X+i, ldx);
+}
+
+template <typename T>
+void RowBuffer<T>::scale(T alpha)
+{
+    for(unsigned long j=0; j<numcols; ++j)
+        gurls::scal(numrows, alpha, data+j*ld, 1);
+}
+
+template <typename T>
+const gMat2D<T>& RowBuffer<T>::view()
+{
+    if(ld != numrows)
+        relayout(numrows);
+
+    if(matview == NULL || matview->getData() != data || matview->rows() != numrows)
+    {
+        delete matview;
+        matview = new gMat2D<T>(data, numrows, numcols, false);
+    }
+
+    return *matview;
+}
+
+}
@@ -117,20 +117,21 @@ GurlsOptionsList *ParamSelSiglamLooGPRegr<T>::execute(const gMat2D<T>& X, const
     GurlsOptionsList* kernel = nestedOpt->getOptAs<GurlsOptionsList>("kernel");
 
 
-    gMat2D<T> *distance;
+    const gMat2D<T> *distance;
 
 //    if ~isfield(opt.kernel,'distance')
     if(!kernel->hasOpt("distance"))
     {
-        distance = new gMat2D<T>(n, n);
+        gMat2D<T> *newDistance = new gMat2D<T>(n, n);
 
 //        opt.kernel.distance = square_distance(X',X');
-        distance_transposed(X.getData(), X.getData(), d, n, n, distance->getData());
+        distance_transposed(X.getData(), X.getData(), d, n, n, newDistance->getData());
 
-        kernel->addOpt("distance", new OptMatrix<gMat2D<T> >(*distance));
+        kernel->addOpt("distance", new OptMatrix<gMat2D<T> >(*newDistance));
+        distance = newDistance;
     }
-    else
-        distance = &(kernel->getOptValue<OptMatrix<gMat2D<T> > >("distance"));
+    else // read-only access, the distances stay shared with opt.kernel
+        distance = &(static_cast<const GurlsOptionsList*>(kernel)->getOptValue<OptMatrix<gMat2D<T> > >("distance"));
 
 
 //    if ~isfield(opt,'sigmamin')
@@ -143,7 +144,7 @@ GurlsOptionsList *ParamSelSiglamLooGPRegr<T>::execute(const gMat2D<T>& X, const
 
         const unsigned long size = distance->cols();
         T* it = distLinearized;
-        T* d_it = distance->getData();
+        const T* d_it = distance->getData();
 
         for(unsigned long i=1; i< size; ++i)
         {
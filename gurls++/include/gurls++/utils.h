@@ -49,6 +49,7 @@
 #define _GURLS_UTILS_H_
 
 #include <map>
+#include <vector>
 #include <algorithm>
 
 #include "gurls++/gmath.h"
@@ -60,13 +61,19 @@
 
 #include "gurls++/primal.h"
 #include "gurls++/macroavg.h"
+#include "gurls++/chunkreader.h"
 
 #include <set>
 
 #include <boost/random/normal_distribution.hpp>
+#include <boost/random/gamma_distribution.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/version.hpp>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
 namespace gurls {
 
 /**
@@ -503,6 +510,257 @@ void distance_transposed_vm(const T* A, const T* B, const int cols, const int B_
 }
 
 
+/**
+ * Returns the default number of rows of the blocks used by \ref predict_kernel_blocked:
+ * 4096 rows, reduced so that a block of the kernel matrix against m training points
+ * holds at most 2^22 elements
+ */
+inline unsigned long predict_kernel_blocksize(const unsigned long m)
+{
+    return std::max(1ul, std::min(4096ul, (1ul << 22)/std::max(m, 1ul)));
+}
+
+/**
+ * Computes the predictions y = K(X,Xtr)*alpha of a kernel estimator, processing the
+ * rows of X in blocks so that at most one block of the kernel matrix is stored per thread.
+ * For the rbf kernel exp(-||x-z||^2/sigma^2) each block is computed with one GEMM
+ * ||x||^2 + ||z||^2 - 2*x*z', followed by the exponential and a GEMM against alpha.
+ * For the linear kernel the predictions are computed as X*(Xtr'*alpha).
+ * When compiled with OpenMP the blocks are processed in parallel.
+ *
+ * \param kernelType kernel type, either "rbf" or "linear"
+ * \param X n-by-d matrix of test inputs
+ * \param n number of rows of X
+ * \param d number of columns of X and Xtr
+ * \param Xtr m-by-d matrix of training inputs
+ * \param m number of rows of Xtr
+ * \param alpha m-by-t matrix of coefficients
+ * \param t number of columns of alpha
+ * \param sigma rbf kernel parameter
+ * \param y n-by-t output matrix
+ * \param blocksize number of rows of X processed at a time
+ */
+template <typename T>
+void predict_kernel_blocked(const std::string& kernelType, const T* X, const unsigned long n, const unsigned long d,
+                            const T* Xtr, const unsigned long m, const T* alpha, const unsigned long t,
+                            const double sigma, T* y, unsigned long blocksize)
+{
+    if(kernelType == "linear")
+    {
+        //  W = Xtr'*alpha;   y = X*W;
+        T* W = new T[d*t];
+        gemm(CblasTrans, CblasNoTrans, d, t, m, (T)1.0, Xtr, m, alpha, m, (T)0.0, W, d);
+        gemm(CblasNoTrans, CblasNoTrans, n, t, d, (T)1.0, X, n, W, d, (T)0.0, y, n);
+        delete[] W;
+        return;
+    }
+
+    if(kernelType != "rbf")
+        throw gException(Exception_Required_Parameter_Missing);
+
+    blocksize = std::max(1ul, std::min(blocksize, n));
+    const long nblocks = static_cast<long>((n+blocksize-1)/blocksize);
+    const T gamma = (T)(-1.0/(sigma*sigma));
+
+    //  zn = sum(Xtr.^2, 2);
+    T* zn = new T[m];
+    sum_col_squared(Xtr, zn, m, d);
+
+#pragma omp parallel
+    {
+        // allocated on the first block of the thread, so that threads left without blocks allocate nothing
+        T* K = NULL;
+        T* xn = NULL;
+
+#pragma omp for schedule(dynamic)
+        for(long b=0; b<nblocks; ++b)
+        {
+            const unsigned long i0 = b*blocksize;
+            const unsigned long nb = std::min(blocksize, n-i0);
+            const T* Xb = X+i0;
+
+            if(K == NULL)
+            {
+                K = new T[blocksize*m];
+                xn = new T[blocksize];
+            }
+
+            //  xn = sum(X(i0:i0+nb-1,:).^2, 2);
+            for(unsigned long i=0; i<nb; ++i)
+                xn[i] = dot(d, Xb+i, n, Xb+i, n);
+
+            //  K = -2*Xb*Xtr';
+            gemm(CblasNoTrans, CblasTrans, nb, m, d, (T)-2.0, Xb, n, Xtr, m, (T)0.0, K, nb);
+
+            //  K = exp(-max(K + xn + zn', 0)/sigma^2);
+            for(unsigned long j=0; j<m; ++j)
+            {
+                T* Kj = K+j*nb;
+                for(unsigned long i=0; i<nb; ++i)
+                    Kj[i] = std::exp(gamma*std::max(Kj[i]+xn[i]+zn[j], (T)0.0));
+            }
+
+            //  y(i0:i0+nb-1,:) = K*alpha;
+            gemm(CblasNoTrans, CblasNoTrans, nb, t, m, (T)1.0, K, nb, alpha, m, (T)0.0, y+i0, n);
+        }
+
+        delete[] K;
+        delete[] xn;
+    }
+
+    delete[] zn;
+}
+
+/**
+ * Computes the na-by-nb kernel matrix K between the rows of XA and the rows of XB, given their
+ * squared norms, with one GEMM followed, for the rbf kernel exp(-||x-z||^2/sigma^2), by the exponential.
+ *
+ * \param kernelType kernel type, either "rbf" or "linear"
+ * \param sigma rbf kernel parameter
+ * \param XA na-by-d matrix, with leading dimension lda
+ * \param lda leading dimension of XA
+ * \param na number of rows of XA
+ * \param nA squared norms of the rows of XA (not used by the linear kernel)
+ * \param XB nb-by-d matrix, with leading dimension ldb
+ * \param ldb leading dimension of XB
+ * \param nb number of rows of XB
+ * \param nB squared norms of the rows of XB (not used by the linear kernel)
+ * \param d number of columns of XA and XB
+ * \param K na-by-nb output matrix, with leading dimension ldk
+ * \param ldk leading dimension of K
+ */
+template <typename T>
+void kernel_block(const std::string& kernelType, const double sigma,
+                  const T* XA, const unsigned long lda, const unsigned long na, const T* nA,
+                  const T* XB, const unsigned long ldb, const unsigned long nb, const T* nB,
+                  const unsigned long d, T* K, const unsigned long ldk)
+{
+    const bool linear = (kernelType == "linear");
+    if(!linear && kernelType != "rbf")
+        throw gException(Exception_Required_Parameter_Missing);
+
+    //  K = XA*XB';
+    gemm(CblasNoTrans, CblasTrans, na, nb, d, (T)1.0, XA, lda, XB, ldb, (T)0.0, K, ldk);
+
+    if(linear)
+        return;
+
+    //  K = exp(-max(nA + nB' - 2*K, 0)/sigma^2);
+    const T gamma = (T)(-1.0/(sigma*sigma));
+
+    for(unsigned long j=0; j<nb; ++j)
+    {
+        T* Kj = K+(ldk*j);
+        for(unsigned long i=0; i<na; ++i)
+            Kj[i] = std::exp(gamma*std::max(nA[i]+nB[j]-2*Kj[i], (T)0.0));
+    }
+}
+
+/**
+ * Selects k rows of X by k-means++ seeding in the feature space of the kernel:
+ * every new seed is drawn with probability proportional to its squared feature-space
+ * distance from the closest seed already chosen.
+ *
+ * \param kernelType kernel type, either "rbf" or "linear"
+ * \param sigma rbf kernel parameter
+ * \param X n-by-d input matrix
+ * \param n number of rows of X
+ * \param d number of columns of X
+ * \param k number of seeds, at most n
+ * \param seed seed of the random number generator
+ * \param seeds output vector of the indices of the k seeds
+ */
+template <typename T>
+void kmeanspp_seeds(const std::string& kernelType, const double sigma, const T* X, const unsigned long n,
+                    const unsigned long d, const unsigned long k, const unsigned long seed, unsigned long* seeds)
+{
+    const long ln = static_cast<long>(n);
+
+    const bool linear = (kernelType == "linear");
+    if(!linear && kernelType != "rbf")
+        throw gException(Exception_Required_Parameter_Missing);
+
+    const T gamma = (T)(-1.0/(sigma*sigma));
+
+#if   BOOST_VERSION < 104700
+    boost::mt19937 gen(static_cast<boost::uint32_t>(seed));
+#else
+    boost::random::mt19937 gen(static_cast<boost::uint32_t>(seed));
+#endif
+
+    T* xn = new T[n];
+    sum_col_squared(X, xn, n, d);
+
+    T* D2 = new T[n];   // squared distance in feature space from the closest seed
+    T* kc = new T[n];
+    T* xc = new T[d];
+    std::vector<bool> chosen(n, false);
+
+    unsigned long c = gen()%n;
+
+    for(unsigned long j=0; j<k; ++j)
+    {
+        seeds[j] = c;
+        chosen[c] = true;
+
+        if(j == k-1)
+            break;
+
+        //  kc = X*X(c,:)';
+        copy(xc, X+c, d, 1, n);
+        gemv(CblasNoTrans, n, d, (T)1.0, X, n, xc, 1, (T)0.0, kc, 1);
+
+        //  D2 = min(D2, k(x,x) + k(c,c) - 2*k(x,c));
+        const T xnc = xn[c];
+
+#pragma omp parallel for
+        for(long i=0; i<ln; ++i)
+        {
+            const T dist = std::max(xn[i]+xnc-2*kc[i], (T)0.0);
+            const T Di = linear? dist: 2*(1-std::exp(gamma*dist));
+
+            if(j == 0 || Di < D2[i])
+                D2[i] = Di;
+        }
+        D2[c] = 0;
+
+        // next seed drawn with probability proportional to D2
+        T total = 0;
+        for(long i=0; i<ln; ++i)
+            total += D2[i];
+
+        const T u = (static_cast<T>(gen())+(T)0.5)/(T)4294967296.0;
+
+        if(total > 0)
+        {
+            const T target = u*total;
+            T cum = 0;
+            long i = 0;
+            for(; i<ln-1; ++i)
+            {
+                cum += D2[i];
+                if(cum >= target && D2[i] > 0)
+                    break;
+            }
+            while(chosen[i])
+                i = (i+1)%ln;
+            c = i;
+        }
+        else
+        {
+            // all the samples coincide with a seed
+            c = static_cast<unsigned long>(u*n);
+            while(chosen[c])
+                c = (c+1)%n;
+        }
+    }
+
+    delete [] xn;
+    delete [] D2;
+    delete [] kc;
+    delete [] xc;
+}
+
 /**
  * Constructs a nearly optimal rank-\a k approximation USV' to \a A, using \a its full iterations of a block Lanczos method
  * of block size \a l, started with an n x \a l random matrix, when \a A is m x n;
@@ -961,28 +1219,573 @@ gMat2D<T>* rp_apply_real(const gMat2D<T> &X, const gMat2D<T> &W)
     return rp_apply_real(X.getData(), W.getData(), n, d, D);
 }
 
+/**
+ * Returns the order of the Hadamard blocks of the structured random projections
+ * for inputs of dimension d, i.e. the smallest power of two not smaller than d
+ */
+inline unsigned long rp_structured_blocksize(const unsigned long d)
+{
+    unsigned long p = 1;
+    while(p < d)
+        p <<= 1;
+
+    return p;
+}
+
+/**
+ * Computes in place the unnormalized Walsh-Hadamard transform of each row of the
+ * nb-by-p matrix Z, with p a power of two, in O(nb*p*log(p)) operations.
+ * The butterflies combine whole columns, so that the inner loops run over contiguous memory.
+ */
 template<typename T>
-gMat2D<T>* rp_projections(const unsigned long d, const unsigned long D)
+void fwht_rows(T* Z, const unsigned long nb, const unsigned long p)
 {
-    //    W = sqrt(2)*randn(d,D);
+    for(unsigned long h=1; h<p; h<<=1)
+        for(unsigned long j=0; j<p; j+=2*h)
+            for(unsigned long k=j; k<j+h; ++k)
+            {
+                T* a = Z + k*nb;
+                T* b = Z + (k+h)*nb;
+
+                for(unsigned long i=0; i<nb; ++i)
+                {
+                    const T tmp = a[i];
+                    a[i] = tmp + b[i];
+                    b[i] = tmp - b[i];
+                }
+            }
+}
+
+/**
+ * Generates the parameters of D random projections approximating the gaussian kernel
+ * exp(-||x-z||^2) on inputs of dimension d, as used by \ref rp_apply_real.
+ *
+ * With p = rp_structured_blocksize(d) and nb = ceil(D/p), the supported types are
+ *  - "gaussian": dense d-by-D matrix W = sqrt(2)*randn(d,D)
+ *  - "fastfood": p-by-4*nb matrix; every group of four columns [B P G S] describes the
+ *    p-by-p block S*H*G*P*H*B of the projection (Le, Sarlos, Smola; Fastfood; ICML 2013), where
+ *    H is the Walsh-Hadamard matrix, B a random sign diagonal, P a random permutation (stored as
+ *    zero-based indices), G a gaussian diagonal and S the diagonal rescaling the rows to chi-distributed norms
+ *  - "orthogonal": p-by-4*nb matrix; every group of four columns [D1 D2 D3 S] describes the block
+ *    S*H*D3*H*D2*H*D1 (Yu et al.; Orthogonal Random Features; NIPS 2016), where D1, D2, D3 are random
+ *    sign diagonals and S rescales the orthogonal rows to chi-distributed norms
+ *
+ * The structured projections are applied in O(D*log(p)) operations per sample and store O(D) parameters.
+ * Inputs are zero-padded to dimension p; when D is not a multiple of p only the first D rows
+ * of the stacked blocks are used.
+ *
+ * \param d number of input variables
+ * \param D number of random projections
+ * \param type projection type
+ * \param seed seed of the random number generator; 5489 is the default seed of mt19937
+ */
+template<typename T>
+gMat2D<T>* rp_projections(const unsigned long d, const unsigned long D, const std::string& type, const unsigned long seed)
+{
+#if   BOOST_VERSION < 104700
+    boost::mt19937 gen(static_cast<boost::uint32_t>(seed));
+#else
+    boost::random::mt19937 gen(static_cast<boost::uint32_t>(seed));
+#endif
+
+    if(type == "gaussian")
+    {
+        //    W = sqrt(2)*randn(d,D);
 #if   BOOST_VERSION < 104700
-    boost::mt19937 gen;
-    boost::normal_distribution<T> g(0.0, (T)sqrt(2.0));
+        boost::normal_distribution<T> g(0.0, (T)sqrt(2.0));
 #else
-    boost::random::mt19937 gen;
-    boost::random::normal_distribution<T> g(0.0, (T)sqrt(2.0));
+        boost::random::normal_distribution<T> g(0.0, (T)sqrt(2.0));
 #endif
 
-    gMat2D<T> *W = new gMat2D<T>(d, D);
-    for(T* W_it = W->getData(), *const W_end = W_it + (d*D); W_it != W_end; ++W_it)
-        *W_it = g(gen);
+        gMat2D<T> *W = new gMat2D<T>(d, D);
+        for(T* W_it = W->getData(), *const W_end = W_it + (d*D); W_it != W_end; ++W_it)
+            *W_it = g(gen);
+
+        return W;
+    }
+
+    const unsigned long p = rp_structured_blocksize(d);
+    const unsigned long nb = (D+p-1)/p;
+
+    if(type != "fastfood" && type != "orthogonal")
+        throw gException(Exception_Illegal_Argument_Value);
+
+#if   BOOST_VERSION < 104700
+    boost::normal_distribution<T> g(0.0, 1.0);
+    boost::gamma_distribution<T> chi2((T)(0.5*d));
+#else
+    boost::random::normal_distribution<T> g(0.0, 1.0);
+    boost::random::gamma_distribution<T> chi2((T)(0.5*d));
+#endif
+
+    gMat2D<T> *W = new gMat2D<T>(p, 4*nb);
+    for(unsigned long b=0; b<nb; ++b)
+    {
+        if(type == "orthogonal")
+        {
+            T* S = W->getData() + (4*b+3)*p;
+
+            for(T* D_it = S-3*p; D_it != S; ++D_it)
+                *D_it = (gen() & 1)? (T)1.0 : (T)-1.0;
+
+            // the rows of H*D3*H*D2*H*D1 have norm p*sqrt(p), and about p*sqrt(d) on the first d coordinates
+            //  S = sqrt(2/d)/p*sqrt(chi2rnd(d,p,1));
+            const T scale = (T)(std::sqrt(2.0/d)/p);
+            for(unsigned long i=0; i<p; ++i)
+                S[i] = scale*std::sqrt((T)2.0*chi2(gen));
+
+            continue;
+        }
+
+        T* B = W->getData() + (4*b)*p;
+        T* P = B + p;
+        T* G = P + p;
+        T* S = G + p;
+
+        for(unsigned long i=0; i<p; ++i)
+            B[i] = (gen() & 1)? (T)1.0 : (T)-1.0;
+
+        // Fisher-Yates shuffle
+        for(unsigned long i=0; i<p; ++i)
+            P[i] = (T)i;
+        for(unsigned long i=p-1; i>0; --i)
+        {
+            const unsigned long j = std::min(i, static_cast<unsigned long>((gen()+0.5)/4294967296.0*(i+1)));
+            std::swap(P[i], P[j]);
+        }
+
+        for(unsigned long i=0; i<p; ++i)
+            G[i] = g(gen);
+
+        // the rows of H*G*P*H*B have norm sqrt(p)*norm(G), and about sqrt(d)*norm(G) on the first d
+        // coordinates; the rescaling gives them the norms sqrt(2)*chi(d) of the columns of the dense W
+        //  S = sqrt(2/d)*sqrt(chi2rnd(d,p,1))/norm(G);
+        const T scale = (T)std::sqrt(2.0/d)/nrm2(p, G, 1);
+        for(unsigned long i=0; i<p; ++i)
+            S[i] = scale*std::sqrt((T)2.0*chi2(gen));
+    }
 
     return W;
 }
 
+template<typename T>
+gMat2D<T>* rp_projections(const unsigned long d, const unsigned long D)
+{
+    return rp_projections<T>(d, D, "gaussian", 5489u);
+}
+
+/**
+ * Computes the random features G = [cos(V) sin(V)] of nb samples for a structured projection
+ * generated by \ref rp_projections, without forming the projection matrix V = X*W explicitly.
+ *
+ * \param X nb-by-d input matrix, with leading dimension ldx
+ * \param ldx leading dimension of X
+ * \param nb number of samples
+ * \param d number of input variables
+ * \param W projection parameters
+ * \param D number of random projections
+ * \param type projection type, either "fastfood" or "orthogonal"
+ * \param G nb-by-2D output matrix, with leading dimension ldg
+ * \param ldg leading dimension of G
+ * \param work workspace of at least 2*nb*rp_structured_blocksize(d) elements
+ */
+template<typename T>
+void rp_apply_structured_real(const T* X, const unsigned long ldx, const unsigned long nb, const unsigned long d,
+                              const T* W, const unsigned long D, const std::string& type,
+                              T* G, const unsigned long ldg, T* work)
+{
+    const unsigned long p = rp_structured_blocksize(d);
+    const unsigned long nblocks = (D+p-1)/p;
+    const bool fastfood = (type == "fastfood");
+
+    if(!fastfood && type != "orthogonal")
+        throw gException(Exception_Illegal_Argument_Value);
+
+    T* Z = work;
+    T* Zp = work + nb*p;
+
+    for(unsigned long b=0; b<nblocks; ++b)
+    {
+        const T* Wb = W + (4*b)*p;
+        const T* D1 = Wb;
+        const T* S = Wb + 3*p;
+
+        //  Z = [X zeros(nb,p-d)]*diag(D1);
+        for(unsigned long j=0; j<d; ++j)
+        {
+            const T* Xj = X + j*ldx;
+            T* Zj = Z + j*nb;
+            for(unsigned long i=0; i<nb; ++i)
+                Zj[i] = Xj[i]*D1[j];
+        }
+        set(Z + d*nb, (T)0.0, (p-d)*nb);
+
+        fwht_rows(Z, nb, p);
+
+        if(fastfood)
+        {
+            const T* P = Wb + p;
+            const T* Gb = Wb + 2*p;
+
+            //  Zp = Z(:,P)*diag(G);
+            for(unsigned long j=0; j<p; ++j)
+            {
+                const T* Zj = Z + static_cast<unsigned long>(P[j])*nb;
+                T* Zpj = Zp + j*nb;
+                for(unsigned long i=0; i<nb; ++i)
+                    Zpj[i] = Zj[i]*Gb[j];
+            }
+            std::swap(Z, Zp);
+
+            fwht_rows(Z, nb, p);
+        }
+        else
+        {
+            //  Z = Z*diag(D2)*H*diag(D3)*H;
+            for(unsigned long k=1; k<3; ++k)
+            {
+                const T* Dk = Wb + k*p;
+                for(unsigned long j=0; j<p; ++j)
+                    scal(nb, Dk[j], Z + j*nb, 1);
+
+                fwht_rows(Z, nb, p);
+            }
+        }
+
+        //  G(:,b*p+1:...) = cos(Z*diag(S));   G(:,D+b*p+1:...) = sin(Z*diag(S));
+        const unsigned long jend = std::min(p, D-b*p);
+        for(unsigned long j=0; j<jend; ++j)
+        {
+            const T s = S[j];
+            const T* Zj = Z + j*nb;
+            T* Gc = G + (b*p+j)*ldg;
+            T* Gs = G + (D+b*p+j)*ldg;
+
+            for(unsigned long i=0; i<nb; ++i)
+            {
+                const T v = Zj[i]*s;
+                Gc[i] = cos(v);
+                Gs[i] = sin(v);
+            }
+        }
+
+        // the permutation may have swapped the buffers
+        Z = work;
+        Zp = work + nb*p;
+    }
+}
+
+/**
+ * Computes the n-by-2D matrix of random features G = [cos(V) sin(V)] of the rows of X
+ * for the projection W of the given type generated by \ref rp_projections.
+ * Structured projections are applied to blocks of rows, in parallel when compiled with OpenMP.
+ *
+ * \param X input data matrix
+ * \param W projection parameters
+ * \param type projection type, "gaussian", "fastfood" or "orthogonal"
+ * \param D number of random projections
+ */
+template<typename T>
+gMat2D<T>* rp_apply_real(const gMat2D<T> &X, const gMat2D<T> &W, const std::string& type, const unsigned long D)
+{
+    if(type == "gaussian")
+        return rp_apply_real(X, W);
+
+    const unsigned long n = X.rows();
+    const unsigned long d = X.cols();
+    const unsigned long p = rp_structured_blocksize(d);
+
+    if(W.rows() != p)
+        throw gException(Exception_Inconsistent_Size);
+
+    gMat2D<T> *G = new gMat2D<T>(n, 2*D);
+    if(n == 0)
+        return G;
+
+    // blocks of at most 2^14 elements per buffer, with at least 8 rows for the butterflies to vectorize
+    const unsigned long blocksize = std::min(n, std::max(8ul, (1ul << 14)/p));
+    const long nblocks = static_cast<long>((n+blocksize-1)/blocksize);
+
+#pragma omp parallel
+    {
+        // allocated on the first block of the thread
+        T* work = NULL;
+
+#pragma omp for schedule(dynamic)
+        for(long b=0; b<nblocks; ++b)
+        {
+            const unsigned long i0 = b*blocksize;
+            const unsigned long nb = std::min(blocksize, n-i0);
+
+            if(work == NULL)
+                work = new T[2*blocksize*p];
+
+            rp_apply_structured_real(X.getData()+i0, n, nb, d, W.getData(), D, type, G->getData()+i0, n, work);
+        }
+
+        delete[] work;
+    }
+
+    return G;
+}
+
+/**
+ * Returns the number of elements of the workspace needed by \ref rp_features for blocks of nb samples
+ */
+inline unsigned long rp_features_worksize(const unsigned long nb, const unsigned long d, const std::string& type)
+{
+    return (type == "gaussian")? 0 : 2*nb*rp_structured_blocksize(d);
+}
+
+/**
+ * Computes the random features G = [cos(V) sin(V)] of nb samples, for a projection
+ * of any type generated by \ref rp_projections, into a preallocated matrix.
+ *
+ * \param X nb-by-d input matrix, with leading dimension ldx
+ * \param ldx leading dimension of X
+ * \param nb number of samples
+ * \param d number of input variables
+ * \param W projection parameters
+ * \param D number of random projections
+ * \param type projection type
+ * \param G nb-by-2D output matrix, with leading dimension ldg
+ * \param ldg leading dimension of G
+ * \param work workspace of at least rp_features_worksize(nb, d, type) elements
+ */
+template<typename T>
+void rp_features(const T* X, const unsigned long ldx, const unsigned long nb, const unsigned long d,
+                 const T* W, const unsigned long D, const std::string& type,
+                 T* G, const unsigned long ldg, T* work)
+{
+    if(type != "gaussian")
+    {
+        rp_apply_structured_real(X, ldx, nb, d, W, D, type, G, ldg, work);
+        return;
+    }
+
+//    V = X*W;
+    T* V = G + D*ldg;
+    gemm(CblasNoTrans, CblasNoTrans, nb, D, d, (T)1.0, X, ldx, W, d, (T)0.0, V, ldg);
+
+//    G = [cos(V) sin(V)];
+    for(unsigned long j=0; j<D; ++j)
+    {
+        T* Gj = G + j*ldg;
+        T* Vj = V + j*ldg;
+
+        for(unsigned long i=0; i<nb; ++i)
+        {
+            Gj[i] = cos(Vj[i]);
+            Vj[i] = sin(Vj[i]);
+        }
+    }
+}
+
+/**
+ * Computes the predictions scores = G*Wrls of a linear model on the random features G of X,
+ * without storing G. The rows of X are processed in blocks of blocksize rows, and the projections
+ * in chunks of about 256 (whole Hadamard blocks for the structured projections): the features of
+ * a block of rows and a chunk of projections are computed into a small buffer, multiplied by the
+ * corresponding rows of Wrls and discarded. When compiled with OpenMP the blocks of rows are
+ * processed in parallel.
+ *
+ * \param X n-by-d matrix of test inputs
+ * \param n number of rows of X
+ * \param d number of columns of X
+ * \param W projection parameters
+ * \param D number of random projections
+ * \param type projection type
+ * \param Wrls 2D-by-t matrix of coefficients
+ * \param t number of columns of Wrls
+ * \param scores n-by-t output matrix
+ * \param blocksize number of rows of X processed at a time
+ */
+template<typename T>
+void rp_predict_real(const T* X, const unsigned long n, const unsigned long d,
+                     const T* W, const unsigned long D, const std::string& type,
+                     const T* Wrls, const unsigned long t, T* scores, unsigned long blocksize = 256)
+{
+    if(n == 0)
+        return;
+
+    if(D == 0)
+    {
+        for(unsigned long j=0; j<t; ++j)
+            set(scores + j*n, (T)0.0, n);
+        return;
+    }
+
+    const bool structured = (type != "gaussian");
+    const unsigned long p = rp_structured_blocksize(d);
+    const unsigned long chunk = structured? std::max(1ul, 256/p)*p : std::min(256ul, D);
+
+    blocksize = std::max(1ul, std::min(blocksize, n));
+    const long nblocks = static_cast<long>((n+blocksize-1)/blocksize);
+
+#pragma omp parallel
+    {
+        // allocated on the first block of the thread
+        T* Gb = NULL;
+        T* work = NULL;
+
+#pragma omp for schedule(dynamic)
+        for(long b=0; b<nblocks; ++b)
+        {
+            const unsigned long i0 = b*blocksize;
+            const unsigned long nb = std::min(blocksize, n-i0);
+
+            if(Gb == NULL)
+            {
+                Gb = new T[blocksize*2*chunk];
+                work = new T[rp_features_worksize(blocksize, d, type)];
+            }
+
+            for(unsigned long j0=0; j0<D; j0+=chunk)
+            {
+                const unsigned long nc = std::min(chunk, D-j0);
+                const T* Wc = W + (structured? 4*(j0/p)*p : j0*d);
+                const T beta = (j0 == 0)? (T)0.0 : (T)1.0;
+
+                //  Gb = rp_apply_real(X(i0:i0+nb-1,:), W(:,j0:j0+nc-1));
+                rp_features(X+i0, n, nb, d, Wc, nc, type, Gb, nb, work);
+
+                //  scores(i0:i0+nb-1,:) += Gb*Wrls([j0:j0+nc-1, D+j0:D+j0+nc-1],:);
+                gemm(CblasNoTrans, CblasNoTrans, nb, t, nc, (T)1.0, Gb, nb, Wrls+j0, 2*D, beta, scores+i0, n);
+                gemm(CblasNoTrans, CblasNoTrans, nb, t, nc, (T)1.0, Gb+nc*nb, nb, Wrls+D+j0, 2*D, (T)1.0, scores+i0, n);
+            }
+        }
+
+        delete [] Gb;
+        delete [] work;
+    }
+}
+
+/**
+ * Accumulates the products G'*G, in the upper triangle of XtX, and G'*y, in Xty, where G
+ * are the random features of the n rows of X.
+ * The rows are processed in blocks of psize rows, reusing the same feature buffer, and G'*G is
+ * accumulated with SYRK. When compiled with OpenMP the blocks are split statically among the
+ * threads, each summing its own partial products, which are added to XtX and Xty in thread order,
+ * so that the result does not depend on the scheduling.
+ *
+ * \param X n-by-d input matrix, with leading dimension ldx
+ * \param ldx leading dimension of X
+ * \param y n-by-t output matrix, with leading dimension ldy
+ * \param ldy leading dimension of y
+ * \param n number of samples
+ * \param d number of input variables
+ * \param t number of outputs
+ * \param W projection parameters
+ * \param D number of random projections
+ * \param type projection type
+ * \param psize number of rows processed at a time
+ * \param XtX 2D-by-2D matrix, whose upper triangle is updated
+ * \param Xty 2D-by-t matrix, updated
+ */
+template<typename T>
+void rp_accumulate_real(const T* X, const unsigned long ldx, const T* y, const unsigned long ldy,
+                        const unsigned long n, const unsigned long d, const unsigned long t,
+                        const T* W, const unsigned long D, const std::string& type,
+                        unsigned long psize, T* XtX, T* Xty)
+{
+    if(n == 0)
+        return;
+
+    const unsigned long D2 = 2*D;
+    psize = std::max(1ul, std::min(psize, n));
+    const long nblocks = static_cast<long>((n+psize-1)/psize);
+
+#ifdef _OPENMP
+    const int nthreads = static_cast<int>(std::min(static_cast<long>(omp_get_max_threads()), nblocks));
+#else
+    const int nthreads = 1;
+#endif
+
+    // partial products of the threads other than the first one, which updates XtX and Xty directly;
+    // each thread allocates its own on its first block, so that threads left without blocks allocate nothing
+    const unsigned long partialSize = D2*D2 + D2*t;
+    std::vector<T*> partial(nthreads, static_cast<T*>(NULL));
+
+#pragma omp parallel num_threads(nthreads)
+    {
+#ifdef _OPENMP
+        const int tid = omp_get_thread_num();
+#else
+        const int tid = 0;
+#endif
+        T* XtX_t = XtX;
+        T* Xty_t = Xty;
+
+        T* Gi = NULL;
+        T* work = NULL;
+
+#pragma omp for schedule(static)
+        for(long b=0; b<nblocks; ++b)
+        {
+            const unsigned long i0 = b*psize;
+            const unsigned long rows = std::min(psize, n-i0);
+
+            if(Gi == NULL)
+            {
+                Gi = new T[psize*D2];
+                work = new T[rp_features_worksize(psize, d, type)];
+
+                if(tid > 0)
+                {
+                    partial[tid] = new T[partialSize];
+                    set(partial[tid], (T)0.0, partialSize);
+                    XtX_t = partial[tid];
+                    Xty_t = partial[tid] + D2*D2;
+                }
+            }
+
+//            Gi = rp_apply_real(X(i:bend,:),W);
+            rp_features(X+i0, ldx, rows, d, W, D, type, Gi, rows, work);
+
+//            GG = GG + Gi'*Gi;
+            syrk(CblasUpper, CblasTrans, D2, rows, (T)1.0, Gi, rows, (T)1.0, XtX_t, D2);
+
+//            Gy = Gy + Gi'*yi;
+            gemm(CblasTrans, CblasNoTrans, D2, t, rows, (T)1.0, Gi, rows, y+i0, ldy, (T)1.0, Xty_t, D2);
+        }
+
+        delete [] Gi;
+        delete [] work;
+    }
+
+    for(int k=1; k<nthreads; ++k)
+    {
+        const T* XtX_k = partial[k];
+        if(XtX_k == NULL)
+            continue;
+
+        for(unsigned long j=0; j<D2; ++j)
+            axpy(j+1, (T)1.0, XtX_k + j*D2, 1, XtX + j*D2, 1);
+
+        axpy(D2*t, (T)1.0, XtX_k + D2*D2, 1, Xty, 1);
+        delete [] partial[k];
+    }
+}
+
+/**
+ * Draws D random projections and computes the matrices XtX = G'*G and Xty = G'*y,
+ * where G are the random features of X, processing psize rows at a time.
+ *
+ * \param X input data matrix
+ * \param y labels matrix
+ * \param D number of random projections
+ * \param psize number of rows processed at a time
+ * \param XtX 2D-by-2D output matrix
+ * \param Xty 2D-by-t output matrix
+ * \param type projection type, see \ref rp_projections
+ * \param seed seed of the random number generator
+ *
+ * \return the projection parameters
+ */
 template<typename T>
 gMat2D<T>* rp_factorize_large_real(const gMat2D<T> &X, const gMat2D<T> &y, const unsigned long D,
-                                   const unsigned long psize, T* XtX, T*Xty)
+                                   const unsigned long psize, T* XtX, T*Xty,
+                                   const std::string& type = "gaussian", const unsigned long seed = 5489u)
 {
 
 //    d = size(X,2);
@@ -994,7 +1797,7 @@ gMat2D<T>* rp_factorize_large_real(const gMat2D<T> &X, const gMat2D<T> &y, const
     const unsigned long t = y.cols();
 
 //    W = rp_projections(d,D,kernel);
-    gMat2D<T>* W = rp_projections<T>(d, D);
+    gMat2D<T>* W = rp_projections<T>(d, D, type, seed);
 
     const unsigned long D2 = 2*D;
 
@@ -1004,46 +1807,75 @@ gMat2D<T>* rp_factorize_large_real(const gMat2D<T> &X, const gMat2D<T> &y, const
 //    Gy = zeros(D*2,T);
     set(Xty, (T)0.0, D2*t);
 
-
-    T* Xi = new T[psize*d];
-    T* yi = new T[psize*t];
-
-    const T alpha = (T)1.0;
-    const T beta = (T)1.0;
-
 //    for i=1:psize:n
-    for(unsigned long i=0; i< n; i+=psize)
-    {
-//        bend = min(i+psize-1,n);
-        unsigned long bend = std::min(i+psize, n);
-
-//        Gi = rp_apply_real(X(i:bend,:),W);
-//        yi = y(i:bend,:);
-
-        unsigned long rows = bend-i;
+//        GG = GG + Gi'*Gi;
+//        Gy = Gy + Gi'*yi;
+    rp_accumulate_real(X.getData(), n, y.getData(), n, n, d, t, W->getData(), D, type, psize, XtX, Xty);
 
-        const T *X_it = X.getData() + i, *y_it = y.getData() + i;
-        T *Xi_it = Xi, *yi_it = yi;
+    copyUpperToLower(XtX, D2);
 
-        for(unsigned long j=0; j<d; ++j, X_it+=n, Xi_it+=rows)
-            copy(Xi_it, X_it, rows);
+    return W;
+}
 
-        for(unsigned long j=0; j<t; ++j, y_it+=n, yi_it+=rows)
-            copy(yi_it, y_it, rows);
+/**
+ * Draws D random projections and computes the matrices XtX = G'*G and Xty = G'*y,
+ * where G are the random features of the samples delivered by a \ref ChunkReader,
+ * so that datasets that do not fit in memory can be used.
+ * The samples are read chunksize rows at a time into the same buffers, and every chunk
+ * is processed as in \ref rp_accumulate_real.
+ *
+ * \param reader reader of the dataset, read from its current position to the end
+ * \param D number of random projections
+ * \param psize number of rows whose features are computed at a time
+ * \param XtX 2D-by-2D output matrix
+ * \param Xty 2D-by-reader.outputs() output matrix
+ * \param type projection type, see \ref rp_projections
+ * \param seed seed of the random number generator
+ * \param chunksize number of rows read at a time
+ * \param n on exit, the number of samples read
+ *
+ * \return the projection parameters
+ */
+template<typename T>
+gMat2D<T>* rp_factorize_stream_real(ChunkReader<T>& reader, const unsigned long D, const unsigned long psize,
+                                    T* XtX, T* Xty, const std::string& type, const unsigned long seed,
+                                    unsigned long chunksize, unsigned long& n)
+{
+    const unsigned long d = reader.cols();
+    const unsigned long t = reader.outputs();
+    const unsigned long D2 = 2*D;
 
-        gMat2D<T> *Gi = rp_apply_real(Xi, W->getData(), rows, d, D);
+    gMat2D<T>* W = rp_projections<T>(d, D, type, seed);
 
-//        GG = GG + Gi'*Gi;
-        gemm(CblasTrans, CblasNoTrans, D2, D2, rows, alpha, Gi->getData(), rows, Gi->getData(), rows, beta, XtX, D2);
+    set(XtX, (T)0.0, D2*D2);
+    set(Xty, (T)0.0, D2*t);
 
-//        Gy = Gy + Gi'*yi;
-        gemm(CblasTrans, CblasNoTrans, D2, t, rows, alpha, Gi->getData(), rows, yi, rows, beta, Xty, D2);
+    chunksize = std::max(chunksize, psize);
+    T* Xc = new T[chunksize*d];
+    T* yc = new T[chunksize*t];
 
-        delete Gi;
+    n = 0;
+    try
+    {
+        unsigned long rows;
+        while((rows = reader.read(Xc, chunksize, yc, chunksize, chunksize)) > 0)
+        {
+            rp_accumulate_real(Xc, chunksize, yc, chunksize, rows, d, t, W->getData(), D, type, psize, XtX, Xty);
+            n += rows;
+        }
     }
+    catch(...)
+    {
+        delete [] Xc;
+        delete [] yc;
+        delete W;
+        throw;
+    }
+
+    delete [] Xc;
+    delete [] yc;
 
-    delete [] Xi;
-    delete [] yi;
+    copyUpperToLower(XtX, D2);
 
     return W;
 }
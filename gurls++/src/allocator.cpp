@@ -0,0 +1,392 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gurls++/allocator.h"
+#include "gurls++/exceptions.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <sstream>
+
+#ifdef _WIN32
+#include <malloc.h>
+#else
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+#include <boost/thread/mutex.hpp>
+
+namespace gurls {
+
+namespace {
+
+const std::size_t hugePageSize = 2ul << 20;
+
+/**
+ * Prefix stored in front of every buffer, padded to the alignment so that the
+ * address returned to the caller keeps it
+ */
+struct BlockHeader
+{
+    void* base;             // address returned by the system allocator
+    std::size_t capacity;   // usable bytes
+    bool pooled;            // whether the block goes back to the pool when released
+};
+
+const std::size_t headerSize = Allocator::alignment;
+
+struct AllocatorState
+{
+    AllocatorState(): poolLimit(512ul << 20), poolThreshold(256ul << 10), budget(0), hugePages(false), firstTouch(false)
+    {
+        std::memset(&stats, 0, sizeof(stats));
+    }
+
+    boost::mutex mutex;                             // guards all the members below, with or without OpenMP
+    std::multimap<std::size_t, BlockHeader*> pool;   // free blocks by capacity
+
+    MemoryStats stats;
+    std::size_t poolLimit;
+    std::size_t poolThreshold;
+    std::size_t budget;
+    bool hugePages;
+    bool firstTouch;
+};
+
+// never destroyed, since arrays with static storage may be released after the end of main
+AllocatorState& state()
+{
+    static AllocatorState* s = new AllocatorState();
+    return *s;
+}
+
+/**
+ * Rounds a large request up to its size class: 2^k, 1.25*2^k, 1.5*2^k or 1.75*2^k
+ */
+std::size_t sizeClass(const std::size_t bytes)
+{
+    std::size_t p = 1;
+    while((p << 1) <= bytes)
+        p <<= 1;
+
+    const std::size_t step = std::max<std::size_t>(p >> 2, Allocator::alignment);
+    return ((bytes + step - 1)/step)*step;
+}
+
+void* systemAlloc(const std::size_t bytes, const std::size_t align)
+{
+#ifdef _WIN32
+    return _aligned_malloc(bytes, align);
+#else
+    void* ptr = NULL;
+    if(posix_memalign(&ptr, align, bytes) != 0)
+        return NULL;
+    return ptr;
+#endif
+}
+
+void systemFree(void* ptr)
+{
+#ifdef _WIN32
+    _aligned_free(ptr);
+#else
+    std::free(ptr);
+#endif
+}
+
+/**
+ * Writes one element per page with the same static schedule used by the
+ * parallel loops, so that each page is mapped on the node of the thread using it
+ */
+void touchPages(char* buffer, const std::size_t bytes)
+{
+#ifdef _WIN32
+    const long pageSize = 4096;
+#else
+    const long pageSize = sysconf(_SC_PAGESIZE);
+#endif
+    const long npages = static_cast<long>((bytes + pageSize - 1)/pageSize);
+
+#pragma omp parallel for schedule(static)
+    for(long i=0; i<npages; ++i)
+        buffer[i*pageSize] = 0;
+}
+
+}
+
+const std::size_t Allocator::alignment;
+
+void* Allocator::allocate(std::size_t bytes)
+{
+    AllocatorState& s = state();
+
+    BlockHeader* block = NULL;
+    bool fresh = false;
+    bool overBudget = false;
+    unsigned long long inUse = 0;
+    std::size_t budget = 0;
+    bool hugePages = false;
+    bool firstTouch = false;
+    bool pooled = false;
+    std::size_t capacity = 0;
+
+    {
+        boost::mutex::scoped_lock lock(s.mutex);
+
+        pooled = (bytes >= s.poolThreshold);
+        capacity = pooled? sizeClass(bytes): std::max<std::size_t>(bytes, 1);
+
+        budget = s.budget;
+        inUse = s.stats.currentBytes;
+        overBudget = (budget != 0) && (inUse + capacity > budget);
+
+        if(pooled && !overBudget)
+        {
+            std::multimap<std::size_t, BlockHeader*>::iterator it = s.pool.find(capacity);
+            if(it != s.pool.end())
+            {
+                block = it->second;
+                s.pool.erase(it);
+                s.stats.pooledBytes -= capacity;
+                ++s.stats.poolHits;
+            }
+        }
+
+        hugePages = s.hugePages;
+        firstTouch = s.firstTouch;
+    }
+
+    if(overBudget)
+    {
+        std::stringstream str;
+        str << "Memory budget exceeded: a buffer of " << capacity << " bytes was requested with "
+            << inUse << " bytes in use, the budget is " << budget << " bytes";
+        throw gException(str.str());
+    }
+
+    if(block == NULL)
+    {
+        const bool huge = hugePages && (capacity >= hugePageSize);
+        const std::size_t total = capacity + headerSize;
+
+        void* base = systemAlloc(total, huge? hugePageSize: alignment);
+        if(base == NULL)
+            throw gException("Out of memory: failed to allocate a buffer of the requested size");
+
+#if defined(MADV_HUGEPAGE)
+        if(huge)
+            madvise(base, ((total + hugePageSize - 1)/hugePageSize)*hugePageSize, MADV_HUGEPAGE);
+#endif
+
+        block = static_cast<BlockHeader*>(base);
+        block->base = base;
+        block->capacity = capacity;
+        block->pooled = pooled;
+        fresh = true;
+    }
+
+    char* buffer = reinterpret_cast<char*>(block) + headerSize;
+
+    if(fresh && pooled && firstTouch)
+        touchPages(buffer, capacity);
+
+    {
+        boost::mutex::scoped_lock lock(s.mutex);
+
+        ++s.stats.allocations;
+        s.stats.allocatedBytes += capacity;
+        s.stats.currentBytes += capacity;
+        if(s.stats.currentBytes > s.stats.peakBytes)
+            s.stats.peakBytes = s.stats.currentBytes;
+    }
+
+    return buffer;
+}
+
+void Allocator::deallocate(void* ptr)
+{
+    if(ptr == NULL)
+        return;
+
+    AllocatorState& s = state();
+    BlockHeader* block = reinterpret_cast<BlockHeader*>(static_cast<char*>(ptr) - headerSize);
+    const std::size_t capacity = block->capacity;
+
+    bool keep = false;
+    std::multimap<std::size_t, BlockHeader*> evicted;
+
+    {
+        boost::mutex::scoped_lock lock(s.mutex);
+
+        ++s.stats.deallocations;
+        s.stats.currentBytes -= capacity;
+
+        if(block->pooled && capacity <= s.poolLimit)
+        {
+            // the largest free blocks make room for the most recently used one
+            while(s.stats.pooledBytes + capacity > s.poolLimit)
+            {
+                std::multimap<std::size_t, BlockHeader*>::iterator last = s.pool.end();
+                --last;
+                s.stats.pooledBytes -= last->first;
+                evicted.insert(*last);
+                s.pool.erase(last);
+            }
+
+            s.pool.insert(std::make_pair(capacity, block));
+            s.stats.pooledBytes += capacity;
+            keep = true;
+        }
+    }
+
+    for(std::multimap<std::size_t, BlockHeader*>::iterator it = evicted.begin(); it != evicted.end(); ++it)
+        systemFree(it->second->base);
+
+    if(!keep)
+        systemFree(block->base);
+}
+
+MemoryStats Allocator::stats()
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    return s.stats;
+}
+
+void Allocator::resetPeak()
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    s.stats.peakBytes = s.stats.currentBytes;
+}
+
+void Allocator::setBudget(std::size_t bytes)
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    s.budget = bytes;
+}
+
+std::size_t Allocator::getBudget()
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    return s.budget;
+}
+
+std::size_t Allocator::processResidentPeakBytes()
+{
+#ifdef _WIN32
+    return 0;
+#else
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss)*1024;
+#endif
+#endif
+}
+
+void Allocator::releasePool()
+{
+    AllocatorState& s = state();
+    std::multimap<std::size_t, BlockHeader*> released;
+
+    {
+        boost::mutex::scoped_lock lock(s.mutex);
+
+        released.swap(s.pool);
+        s.stats.pooledBytes = 0;
+    }
+
+    for(std::multimap<std::size_t, BlockHeader*>::iterator it = released.begin(); it != released.end(); ++it)
+        systemFree(it->second->base);
+}
+
+void Allocator::setPoolLimit(std::size_t bytes)
+{
+    AllocatorState& s = state();
+
+    {
+        boost::mutex::scoped_lock lock(s.mutex);
+        s.poolLimit = bytes;
+    }
+
+    releasePool();
+}
+
+void Allocator::setPoolThreshold(std::size_t bytes)
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    s.poolThreshold = std::max<std::size_t>(bytes, 1);
+}
+
+void Allocator::setHugePages(bool value)
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    s.hugePages = value;
+}
+
+void Allocator::setFirstTouch(bool value)
+{
+    AllocatorState& s = state();
+    boost::mutex::scoped_lock lock(s.mutex);
+
+    s.firstTouch = value;
+}
+
+}
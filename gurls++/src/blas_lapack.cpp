@@ -81,6 +81,108 @@ GURLS_EXPORT void gemm(const CBLAS_TRANSPOSE TransA, const CBLAS_TRANSPOSE Trans
           const_cast<double*>(C), const_cast<int*>(&ldc));
 }
 
+/**
+  * Specialized version of rot for float buffers
+  */
+template<>
+GURLS_EXPORT void rot(const int N, float *X, const int incX, float *Y, const int incY, const float c, const float s)
+{
+    srot_(const_cast<int*>(&N), X, const_cast<int*>(&incX), Y, const_cast<int*>(&incY), const_cast<float*>(&c), const_cast<float*>(&s));
+}
+
+/**
+  * Specialized version of rotg for float buffers
+  */
+template<>
+GURLS_EXPORT void rotg(float *a, float *b, float *c, float *s)
+{
+    srotg_(a, b, c, s);
+}
+
+/**
+  * Specialized version of rot for double buffers
+  */
+template<>
+GURLS_EXPORT void rot(const int N, double *X, const int incX, double *Y, const int incY, const double c, const double s)
+{
+    drot_(const_cast<int*>(&N), X, const_cast<int*>(&incX), Y, const_cast<int*>(&incY), const_cast<double*>(&c), const_cast<double*>(&s));
+}
+
+/**
+  * Specialized version of rotg for double buffers
+  */
+template<>
+GURLS_EXPORT void rotg(double *a, double *b, double *c, double *s)
+{
+    drotg_(a, b, c, s);
+}
+
+/**
+  * Specialized version of syrk for float buffers
+  */
+template<>
+GURLS_EXPORT void syrk(const CBLAS_UPLO Uplo, const CBLAS_TRANSPOSE Trans,
+          const int N, const int K, const float alpha, const float *A, const int lda,
+          const float beta, float *C, const int ldc)
+{
+    char uplo = BlasUtils::charValue(Uplo);
+    char trans = BlasUtils::charValue(Trans);
+
+    ssyrk_(&uplo, &trans, const_cast<int*>(&N), const_cast<int*>(&K),
+          const_cast<float*>(&alpha), const_cast<float*>(A), const_cast<int*>(&lda),
+          const_cast<float*>(&beta), C, const_cast<int*>(&ldc));
+}
+
+/**
+  * Specialized version of syrk for double buffers
+  */
+template<>
+GURLS_EXPORT void syrk(const CBLAS_UPLO Uplo, const CBLAS_TRANSPOSE Trans,
+          const int N, const int K, const double alpha, const double *A, const int lda,
+          const double beta, double *C, const int ldc)
+{
+    char uplo = BlasUtils::charValue(Uplo);
+    char trans = BlasUtils::charValue(Trans);
+
+    dsyrk_(&uplo, &trans, const_cast<int*>(&N), const_cast<int*>(&K),
+          const_cast<double*>(&alpha), const_cast<double*>(A), const_cast<int*>(&lda),
+          const_cast<double*>(&beta), C, const_cast<int*>(&ldc));
+}
+
+/**
+  * Specialized version of symm for float buffers
+  */
+template<>
+GURLS_EXPORT void symm(const CBLAS_SIDE Side, const CBLAS_UPLO Uplo,
+          const int M, const int N, const float alpha, const float *A, const int lda,
+          const float *B, const int ldb, const float beta, float *C, const int ldc)
+{
+    char side = BlasUtils::charValue(Side);
+    char uplo = BlasUtils::charValue(Uplo);
+
+    ssymm_(&side, &uplo, const_cast<int*>(&M), const_cast<int*>(&N),
+          const_cast<float*>(&alpha), const_cast<float*>(A), const_cast<int*>(&lda),
+          const_cast<float*>(B), const_cast<int*>(&ldb), const_cast<float*>(&beta),
+          C, const_cast<int*>(&ldc));
+}
+
+/**
+  * Specialized version of symm for double buffers
+  */
+template<>
+GURLS_EXPORT void symm(const CBLAS_SIDE Side, const CBLAS_UPLO Uplo,
+          const int M, const int N, const double alpha, const double *A, const int lda,
+          const double *B, const int ldb, const double beta, double *C, const int ldc)
+{
+    char side = BlasUtils::charValue(Side);
+    char uplo = BlasUtils::charValue(Uplo);
+
+    dsymm_(&side, &uplo, const_cast<int*>(&M), const_cast<int*>(&N),
+          const_cast<double*>(&alpha), const_cast<double*>(A), const_cast<int*>(&lda),
+          const_cast<double*>(B), const_cast<int*>(&ldb), const_cast<double*>(&beta),
+          C, const_cast<int*>(&ldc));
+}
+
 /**
   * Specialized version of potrf_ for float buffers
   */
@@ -0,0 +1,104 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gurls++/dataset.h"
+#include "gurls++/exceptions.h"
+
+#include <cstring>
+#include <sstream>
+
+namespace gurls {
+
+DatasetFileHeader::DatasetFileHeader(unsigned long long cols, unsigned long long outputs, unsigned long long chunkRows,
+                                     unsigned int elementSize, bool integer, Layout layout)
+    : version(1), elementSize(elementSize), integer(integer? 1: 0), layout(layout), rows(0), cols(cols), outputs(outputs),
+      chunkRows(chunkRows), chunks(0), statsOffset(0), indexOffset(0)
+{
+    std::memcpy(magic, "GURLSDST", 8);
+    std::memset(padding, 0, sizeof(padding));
+}
+
+unsigned long long DatasetFileHeader::chunkSize(unsigned long long k) const
+{
+    return (k+1 < chunks)? chunkRows: rows - k*chunkRows;
+}
+
+DatasetFileHeader DatasetFileHeader::read(const char* buffer, std::size_t fileSize, const std::string& fileName)
+{
+    DatasetFileHeader header(0, 0, 0, 0, false, COLUMN_CHUNKS);
+
+    if(fileSize < headerSize)
+        throw gException("Invalid file format for " + fileName);
+
+    std::memcpy(&header, buffer, headerSize);
+
+    if(std::memcmp(header.magic, "GURLSDST", 8) != 0 || header.version != 1)
+        throw gException("Invalid file format for " + fileName);
+
+    const unsigned long long width = header.cols + header.outputs;
+    const unsigned long long size = fileSize;
+
+    if(header.elementSize == 0 || header.elementSize > 16 || header.integer > 1
+       || header.layout > ROW_CHUNKS || header.chunkRows == 0
+       || header.chunks != (header.rows + header.chunkRows - 1)/header.chunkRows
+       || header.indexOffset % sizeof(unsigned long long) != 0
+       || header.indexOffset > size || header.chunks > (size - header.indexOffset)/sizeof(unsigned long long)
+       || (header.statsOffset != 0 && (header.statsOffset > size || 2*width > (size - header.statsOffset)/sizeof(double))))
+        throw gException("Invalid file format for " + fileName);
+
+    const unsigned long long* index = reinterpret_cast<const unsigned long long*>(buffer + header.indexOffset);
+    for(unsigned long long k=0; k<header.chunks; ++k)
+    {
+        const unsigned long long rows = header.chunkSize(k);
+
+        if(index[k] < headerSize || index[k] % header.elementSize != 0 || index[k] > size
+           || (width != 0 && rows > (size - index[k])/header.elementSize/width))
+        {
+            std::stringstream str;
+            str << "Chunk " << k << " of file " << fileName << " is out of the file";
+            throw gException(str.str());
+        }
+    }
+
+    return header;
+}
+
+}
@@ -0,0 +1,199 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * author:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "gurls++/mappedfile.h"
+#include "gurls++/exceptions.h"
+
+#include <cstring>
+#include <sstream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace gurls {
+
+MappedFile::MappedFile(const std::string& fileName, AccessHint hint, bool populate)
+    : fileName(fileName), data(NULL), size(0)
+{
+#ifdef _WIN32
+    (void)hint;
+    (void)populate;
+
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if(fileHandle == INVALID_HANDLE_VALUE)
+        throw gException("Could not open file " + fileName);
+
+    LARGE_INTEGER fileSize;
+    if(!GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0)
+    {
+        CloseHandle(fileHandle);
+        throw gException("Could not map file " + fileName);
+    }
+    size = static_cast<std::size_t>(fileSize.QuadPart);
+
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_WRITECOPY, 0, 0, NULL);
+    if(mappingHandle == NULL)
+    {
+        CloseHandle(fileHandle);
+        throw gException("Could not map file " + fileName);
+    }
+
+    data = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_COPY, 0, 0, 0));
+    if(data == NULL)
+    {
+        CloseHandle(mappingHandle);
+        CloseHandle(fileHandle);
+        throw gException("Could not map file " + fileName);
+    }
+#else
+    const int fd = open(fileName.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw gException("Could not open file " + fileName);
+
+    struct stat st;
+    if(fstat(fd, &st) != 0 || st.st_size == 0)
+    {
+        close(fd);
+        throw gException("Could not map file " + fileName);
+    }
+    size = static_cast<std::size_t>(st.st_size);
+
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if(populate)
+        flags |= MAP_POPULATE;
+#endif
+
+    void* ptr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+
+    // the mapping keeps a reference to the file
+    close(fd);
+
+    if(ptr == MAP_FAILED)
+        throw gException("Could not map file " + fileName);
+
+    data = static_cast<char*>(ptr);
+
+    int advice = MADV_NORMAL;
+    switch(hint)
+    {
+    case SEQUENTIAL:
+        advice = MADV_SEQUENTIAL;
+        break;
+    case RANDOM:
+        advice = MADV_RANDOM;
+        break;
+    case WILLNEED:
+        advice = MADV_WILLNEED;
+        break;
+    default:
+        break;
+    }
+
+    if(advice != MADV_NORMAL)
+        madvise(data, size, advice);
+
+#ifndef MAP_POPULATE
+    // touch one byte per page
+    if(populate)
+    {
+        const long pageSize = sysconf(_SC_PAGESIZE);
+        volatile char sum = 0;
+        for(std::size_t i=0; i<size; i+=pageSize)
+            sum += data[i];
+    }
+#endif
+#endif
+}
+
+MappedFile::~MappedFile()
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(mappingHandle);
+    CloseHandle(fileHandle);
+#else
+    munmap(data, size);
+#endif
+}
+
+
+const std::size_t MatrixFileHeader::headerSize;
+
+MatrixFileHeader::MatrixFileHeader(unsigned long long rows, unsigned long long cols, unsigned int elementSize, bool integer)
+    : version(1), elementSize(elementSize), integer(integer? 1: 0), reserved(0), rows(rows), cols(cols)
+{
+    std::memcpy(magic, "GURLSMAT", 8);
+    std::memset(padding, 0, sizeof(padding));
+}
+
+MatrixFileHeader MatrixFileHeader::read(const char* buffer, std::size_t fileSize, unsigned int elementSize, bool integer, const std::string& fileName)
+{
+    MatrixFileHeader header(0, 0, 0, false);
+
+    if(fileSize < headerSize)
+        throw gException("Invalid file format for " + fileName);
+
+    std::memcpy(&header, buffer, headerSize);
+
+    if(std::memcmp(header.magic, "GURLSMAT", 8) != 0 || header.version != 1)
+        throw gException("Invalid file format for " + fileName);
+
+    if(header.elementSize != elementSize || header.integer != (integer? 1u: 0u))
+        throw gException("The element type of " + fileName + " does not match the type of the matrix");
+
+    if(header.cols != 0 && header.rows > (fileSize - headerSize)/elementSize/header.cols)
+    {
+        std::stringstream str;
+        str << "File " << fileName << " is too short for a " << header.rows << " x " << header.cols << " matrix";
+        throw gException(str.str());
+    }
+
+    return header;
+}
+
+}
@@ -54,9 +54,6 @@
 #endif
 #include "gurls++/serialization.h"
 
-#include <boost/algorithm/string/split.hpp>
-#include <boost/algorithm/string/classification.hpp>
-
 using namespace std;
 
 namespace gurls{
@@ -65,7 +62,7 @@ void GurlsOptionsList::setName(std::string newname)
 {
     name = newname;
     removeOpt("Name");
-    (*table)["Name"] = new OptString(newname);
+    addOpt("Name", new OptString(newname));
 }
 
 GurlsOptionsList::GurlsOptionsList(std::string ExpName, bool usedefopt): GurlsOption(OptListOption), name(ExpName)
@@ -122,6 +119,10 @@ GurlsOptionsList::GurlsOptionsList(std::string ExpName, bool usedefopt): GurlsOp
 //        (*table)["nsigma"] =  new OptNumber(10);
         (*table)["eig_percentage"] = new OptNumber(5);
 
+        // Maximum megabytes of GURLS buffers in use during a task, 0 for no limit;
+        // only the buffers of the Allocator count, not the scratch allocated with new T[]
+        (*table)["memorybudget"] = new OptNumber(0);
+
 
     // ======================================================== Pegasos option
         (*table)["subsize"]   = new OptNumber(50);
@@ -137,13 +138,23 @@ GurlsOptionsList::GurlsOptionsList(std::string ExpName, bool usedefopt): GurlsOp
 
 
         GurlsOptionsList * randfeats = new GurlsOptionsList("randfeats");
-        randfeats->table->insert(pair<std::string,GurlsOption*>("D", new OptNumber(500)));
-        randfeats->table->insert(pair<std::string,GurlsOption*>("samplesize", new OptNumber(100)));
+        randfeats->addOpt("D", new OptNumber(500));
+        randfeats->addOpt("samplesize", new OptNumber(100));
+        randfeats->addOpt("type", new OptString("gaussian"));
 
         (*table)["randfeats"] = randfeats;
 
+        GurlsOptionsList * sparsegp = new GurlsOptionsList("sparsegp");
+        sparsegp->addOpt("m", new OptNumber(100));
+        sparsegp->addOpt("approx", new OptString("fitc"));
+        sparsegp->addOpt("selection", new OptString("uniform"));
+        sparsegp->addOpt("seed", new OptNumber(5489));
+
+        (*table)["sparsegp"] = sparsegp;
+
     }
 
+    reindex();
 }
 
 GurlsOptionsList::GurlsOptionsList(const GurlsOptionsList &other): GurlsOption(OptListOption)
@@ -174,18 +185,9 @@ void GurlsOptionsList::printAll()
     std::cout << *this;
 }
 
-bool GurlsOptionsList::hasOpt(string key) const
+bool GurlsOptionsList::hasOpt(const OptKey& key) const
 {
-    //return table->count(key)>0;
-    try
-    {
-        getOpt((key));
-        return true;
-    }
-    catch(gException&)
-    {
-        return false;
-    }
+    return lookup(key, false) != NULL;
 }
 
 void GurlsOptionsList::removeOpt(string key, bool deleteMembers)
@@ -197,6 +199,7 @@ void GurlsOptionsList::removeOpt(string key, bool deleteMembers)
             delete it->second;
 
         table->erase(it);
+        reindex();
     }
 }
 
@@ -251,22 +254,11 @@ string GurlsOptionsList::toString()
     return stream.str();
 }
 
-//template<typename T>
-//GurlsOption* copyOptMatrix(const GurlsOption* toCopy)
-//{
-//    const gMat2D<T> & mat = OptMatrix<gMat2D<T> >::dynacast(toCopy)->getValue();
-
-//    gMat2D<T>* newMat = new gMat2D<T>(mat);
-//    return new OptMatrix<gMat2D<T> >(*newMat);
-//}
-
 template<class MatrixType>
 GurlsOption* copyOptMatrix(const GurlsOption* toCopy)
 {
-    const MatrixType & mat = OptMatrix<MatrixType>::dynacast(toCopy)->getValue();
-
-    MatrixType* newMat = new MatrixType(mat);
-    return new OptMatrix<MatrixType >(*newMat);
+    // the matrix is shared with toCopy until one of them is modified
+    return new OptMatrix<MatrixType>(*OptMatrix<MatrixType>::dynacast(toCopy));
 }
 
 void GurlsOptionsList::copyOpt(string key, const GurlsOptionsList &from)
@@ -358,7 +350,17 @@ void GurlsOptionsList::copyOpt(string key, const GurlsOptionsList &from)
     }
 
     if(newOpt != NULL)
-        addOpt(key, newOpt);
+    {
+        try
+        {
+            addOpt(key, newOpt);
+        }
+        catch (gException & ex)
+        {
+            delete newOpt;
+            throw ex;
+        }
+    }
 }
 
 /**
@@ -384,6 +386,8 @@ bool GurlsOptionsList::addOpt(std::string key, GurlsOption* value)
     if(!res.second)
         throw gException(Exception_Parameter_Already_Definied + " (" + key + ")");
 
+    indexInsert(res.first);
+
     return true;
 }
 
@@ -407,59 +411,138 @@ bool GurlsOptionsList::addOpt(std::string key, std::string value)
     }
 }
 
-GurlsOption* GurlsOptionsList::getOpt(std::string key)
+/**
+  * FNV-1a hash of the characters [begin, end), never 0
+  */
+static std::size_t hashKey(const char* begin, const char* end)
+{
+    std::size_t hash = static_cast<std::size_t>(2166136261u);
+    for(; begin != end; ++begin)
+        hash = (hash ^ static_cast<unsigned char>(*begin)) * static_cast<std::size_t>(16777619u);
+
+    return hash | 1;
+}
+
+void GurlsOptionsList::reindex()
 {
-    if(key.empty())
-        throw gException(Exception_Parameter_Not_Definied_Yet + "( )");
+    std::size_t capacity = 8;
+    while(capacity < 2*table->size())
+        capacity *= 2;
 
-    std::vector<std::string> names;
-    boost::split(names, key, boost::is_any_of("."));
+    hashes.assign(capacity, 0);
+    slots.assign(capacity, table->end());
 
-    GurlsOption* gout = this;
-    ValueType *tab;
+    for(ValueType::iterator it = table->begin(); it != table->end(); ++it)
+        indexInsert(it);
+}
 
-    for(std::vector<std::string>::iterator n_it = names.begin(); n_it != names.end(); ++n_it)
+void GurlsOptionsList::indexInsert(ValueType::iterator it)
+{
+    // the index is kept at most half full
+    if(2*table->size() > hashes.size())
     {
-        tab = GurlsOptionsList::dynacast(gout)->table;
+        reindex();
+        return;
+    }
 
-        std::map<std::string, GurlsOption* >::iterator it = tab->find(*n_it);
+    const std::string& key = it->first;
+    const std::size_t hash = hashKey(key.data(), key.data()+key.size());
+    const std::size_t mask = hashes.size()-1;
 
-        if(it == tab->end())
-            throw gException(Exception_Parameter_Not_Definied_Yet + "( " + *n_it + " )");
+    std::size_t i = hash & mask;
+    while(hashes[i] != 0)
+        i = (i+1) & mask;
 
-        gout = it->second;
+    hashes[i] = hash;
+    slots[i] = it;
+}
+
+GurlsOption* GurlsOptionsList::findLocal(const char* begin, const char* end, std::size_t hash) const
+{
+    if(hashes.empty())
+        return NULL;
+
+    const std::size_t length = end-begin;
+    const std::size_t mask = hashes.size()-1;
+
+    for(std::size_t i = hash & mask; hashes[i] != 0; i = (i+1) & mask)
+    {
+        if(hashes[i] != hash)
+            continue;
+
+        const std::string& key = slots[i]->first;
+        if(key.size() == length && std::equal(begin, end, key.data()))
+            return slots[i]->second;
     }
 
-    return gout;
+    return NULL;
 }
 
-const GurlsOption* GurlsOptionsList::getOpt(std::string key) const
+GurlsOption* GurlsOptionsList::lookup(const OptKey& key, bool throwIfMissing) const
 {
-    if(key.empty())
-        throw gException(Exception_Parameter_Not_Definied_Yet + "( )");
+    const char* begin = key.begin();
+    const char* end = key.end();
 
-    std::vector<std::string> names;
-    boost::split(names, key, boost::is_any_of("."));
+    if(begin == end)
+    {
+        if(throwIfMissing)
+            throw gException(Exception_Parameter_Not_Definied_Yet + "( )");
+
+        return NULL;
+    }
 
-    const GurlsOption* gout = this;
-    ValueType *tab;
+    const GurlsOptionsList* list = this;
 
-    for(std::vector<std::string>::iterator n_it = names.begin(); n_it != names.end(); ++n_it)
+    for(;;)
     {
-        tab = GurlsOptionsList::dynacast(gout)->table;
+        const char* dot = std::find(begin, end, '.');
+        GurlsOption* gout = list->findLocal(begin, dot, hashKey(begin, dot));
+
+        if(gout == NULL)
+        {
+            if(throwIfMissing)
+                throw gException(Exception_Parameter_Not_Definied_Yet + "( " + std::string(begin, dot) + " )");
+
+            return NULL;
+        }
 
-        std::map<std::string, GurlsOption* >::iterator it = tab->find(*n_it);
+        if(dot == end)
+            return gout;
 
-        if(it == tab->end())
-            throw gException(Exception_Parameter_Not_Definied_Yet + "( " + *n_it + " )");
+        if(!gout->isA(OptListOption))
+        {
+            if(throwIfMissing)
+                throw gException(gurls::Exception_Illegal_Dynamic_Cast);
+
+            return NULL;
+        }
 
-        gout = it->second;
+        list = static_cast<const GurlsOptionsList*>(gout);
+        begin = dot+1;
     }
+}
+
+GurlsOption* GurlsOptionsList::getOpt(const OptKey& key)
+{
+    return lookup(key, true);
+}
 
-    return gout;
+const GurlsOption* GurlsOptionsList::getOpt(const OptKey& key) const
+{
+    return lookup(key, true);
+}
+
+GurlsOption* GurlsOptionsList::findOpt(const OptKey& key)
+{
+    return lookup(key, false);
+}
+
+const GurlsOption* GurlsOptionsList::findOpt(const OptKey& key) const
+{
+    return lookup(key, false);
 }
 
-std::string GurlsOptionsList::getOptAsString(std::string key) const
+std::string GurlsOptionsList::getOptAsString(const OptKey& key) const
 {
     return getOptValue<OptString>(key);
 }
@@ -474,7 +557,7 @@ const GurlsOptionsList::ValueType &GurlsOptionsList::getValue() const
     return *table;
 }
 
-double GurlsOptionsList::getOptAsNumber(std::string key) const
+double GurlsOptionsList::getOptAsNumber(const OptKey& key) const
 {
     return getOptValue<OptNumber>(key);
 }
@@ -0,0 +1,60 @@
+#ifndef _GURLS_TEST_SYNTHETICDATA_H_
+#define _GURLS_TEST_SYNTHETICDATA_H_
+
+#include "gmat2d.h"
+
+#include <cmath>
+
+/**
+ * Synthetic regression problems shared by the unit tests. The samples are indexed by i, so that
+ * training, update and test sets are consecutive ranges of the same sequence.
+ */
+namespace synthetic
+{
+
+/**
+ * Returns the element j of the input sample i: sin(0.7*i + 1.3*j) + c*cos(2.9*i*j)
+ */
+inline double input(unsigned long i, unsigned long j, double c = 0.2)
+{
+    return std::sin(0.7*i + 1.3*j) + c*std::cos(2.9*i*j);
+}
+
+/**
+ * Returns the deterministic noise added to the label of the sample i: 0.05*sin(11*i)
+ */
+inline double noise(unsigned long i)
+{
+    return 0.05*std::sin(11.0*i);
+}
+
+/**
+ * Returns the label of the sample i with d variables: sum((1:d).*x) + noise(i)
+ */
+inline double label(unsigned long i, unsigned long d, double c = 0.2)
+{
+    double y = 0;
+    for(unsigned long j=0; j<d; ++j)
+        y += (j+1)*input(i, j, c);
+    return y + noise(i);
+}
+
+/**
+ * Fills the n-by-d matrix X and the n-by-1 labels y with the samples first, ..., first+n-1
+ */
+template<typename T>
+void makeProblem(unsigned long first, unsigned long n, unsigned long d, gurls::gMat2D<T>& X, gurls::gMat2D<T>& y, double c = 0.2)
+{
+    X.resize(n, d);
+    y.resize(n, 1);
+    for(unsigned long i=0; i<n; ++i)
+    {
+        for(unsigned long j=0; j<d; ++j)
+            X.getData()[i+j*n] = static_cast<T>(input(first+i, j, c));
+        y.getData()[i] = static_cast<T>(label(first+i, d, c));
+    }
+}
+
+}
+
+#endif // _GURLS_TEST_SYNTHETICDATA_H_
@@ -0,0 +1,110 @@
+#include "allocator.h"
+#include "exceptions.h"
+
+#include <cstring>
+
+#include <pthread.h>
+
+#define BOOST_TEST_MODULE allocator
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+const int nthreads = 8;
+const int iterations = 2000;
+
+/**
+ * Allocates and releases small and pooled buffers, checking that no other thread writes into them
+ */
+void* churn(void* arg)
+{
+    const unsigned char tag = static_cast<unsigned char>(reinterpret_cast<long>(arg));
+    const std::size_t sizes[] = {24, 1000, 300u << 10, 513u << 10, 2u << 20};
+    const int nsizes = sizeof(sizes)/sizeof(sizes[0]);
+
+    long failures = 0;
+    for(int i=0; i<iterations; ++i)
+    {
+        const std::size_t bytes = sizes[(i + tag) % nsizes];
+        unsigned char* buffer = static_cast<unsigned char*>(Allocator::allocate(bytes));
+        std::memset(buffer, tag, bytes);
+
+        if(i % 97 == 0)
+            Allocator::setPoolThreshold((i % 2)? (64u << 10): (256u << 10));
+
+        for(std::size_t j=0; j<bytes; j+=4093)
+            failures += (buffer[j] != tag);
+
+        Allocator::deallocate(buffer);
+    }
+
+    return reinterpret_cast<void*>(failures);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(ConcurrentAllocations)
+{
+    const MemoryStats before = Allocator::stats();
+
+    pthread_t threads[nthreads];
+    for(long t=0; t<nthreads; ++t)
+        BOOST_REQUIRE_EQUAL(pthread_create(&threads[t], NULL, churn, reinterpret_cast<void*>(t+1)), 0);
+
+    long failures = 0;
+    for(int t=0; t<nthreads; ++t)
+    {
+        void* ret = NULL;
+        pthread_join(threads[t], &ret);
+        failures += reinterpret_cast<long>(ret);
+    }
+
+    const MemoryStats after = Allocator::stats();
+
+    BOOST_CHECK_EQUAL(failures, 0);
+    BOOST_CHECK_EQUAL(after.allocations - before.allocations, static_cast<unsigned long long>(nthreads*iterations));
+    BOOST_CHECK_EQUAL(after.deallocations - before.deallocations, static_cast<unsigned long long>(nthreads*iterations));
+    BOOST_CHECK_EQUAL(after.currentBytes, before.currentBytes);
+
+    Allocator::setPoolThreshold(256u << 10);
+    Allocator::releasePool();
+    BOOST_CHECK_EQUAL(Allocator::stats().pooledBytes, 0ull);
+}
+
+BOOST_AUTO_TEST_CASE(PooledBuffersAreReused)
+{
+    Allocator::releasePool();
+
+    void* first = Allocator::allocate(1u << 20);
+    Allocator::deallocate(first);
+
+    const MemoryStats before = Allocator::stats();
+    void* second = Allocator::allocate((1u << 20) - 100);
+    const MemoryStats after = Allocator::stats();
+
+    BOOST_CHECK(second == first);
+    BOOST_CHECK_EQUAL(after.poolHits - before.poolHits, 1ull);
+    BOOST_CHECK_EQUAL(reinterpret_cast<std::size_t>(second) % Allocator::alignment, 0u);
+
+    Allocator::deallocate(second);
+    Allocator::releasePool();
+}
+
+BOOST_AUTO_TEST_CASE(MemoryBudget)
+{
+    const std::size_t inUse = static_cast<std::size_t>(Allocator::stats().currentBytes);
+
+    {
+        MemoryBudgetScope scope(inUse + (1u << 20));
+        BOOST_CHECK_THROW(Allocator::allocate(2u << 20), gException);
+
+        void* buffer = Allocator::allocate(1000);
+        Allocator::deallocate(buffer);
+    }
+
+    BOOST_CHECK_EQUAL(Allocator::getBudget(), 0u);
+}
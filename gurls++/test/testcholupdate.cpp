@@ -0,0 +1,251 @@
+#include "cholupdateutils.h"
+#include "recrlswrapperchol.h"
+#include "exceptions.h"
+#include "syntheticdata.h"
+
+#include <cmath>
+#include <vector>
+
+#define BOOST_TEST_MODULE cholupdate
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+const int d = 6;
+
+/**
+ * Returns the k-by-d matrix (column-major) of the samples first, ..., first+k-1
+ */
+template<typename T>
+std::vector<T> samples(unsigned long first, int k)
+{
+    std::vector<T> X(k*d);
+    for(int i=0; i<k; ++i)
+        for(int j=0; j<d; ++j)
+            X[i+j*k] = static_cast<T>(synthetic::input(first+i, j));
+    return X;
+}
+
+/**
+ * Returns A + sign*X'*X, for the k-by-d matrix X
+ */
+template<typename T>
+std::vector<T> addGram(const std::vector<T>& A, const std::vector<T>& X, int k, T sign)
+{
+    std::vector<T> B(A);
+    for(int a=0; a<d; ++a)
+        for(int b=0; b<d; ++b)
+            for(int i=0; i<k; ++i)
+                B[a+b*d] += sign*X[i+a*k]*X[i+b*k];
+    return B;
+}
+
+/**
+ * Returns the upper Cholesky factor of A computed from scratch, with the lower part set to zero
+ */
+template<typename T>
+std::vector<T> factor(const std::vector<T>& A)
+{
+    std::vector<T> R(A);
+    int info;
+    char uplo = 'U';
+    int dd = d;
+    potrf_(&uplo, &dd, &R[0], &dd, &info);
+    BOOST_REQUIRE_EQUAL(info, 0);
+
+    for(int j=0; j<d; ++j)
+        for(int i=j+1; i<d; ++i)
+            R[i+j*d] = 0;
+    return R;
+}
+
+/**
+ * Well conditioned symmetric positive definite matrix
+ */
+template<typename T>
+std::vector<T> initialMatrix()
+{
+    std::vector<T> A(d*d, 0);
+    for(int i=0; i<d; ++i)
+        A[i+i*d] = 2;
+    return addGram(A, samples<T>(100, 10), 10, (T)1);
+}
+
+/**
+ * Solves R'*R*x = b in place, for the upper triangular R
+ */
+template<typename T>
+void solve(const std::vector<T>& R, std::vector<T>& b)
+{
+    for(int i=0; i<d; ++i)
+    {
+        for(int j=0; j<i; ++j)
+            b[i] -= R[j+i*d]*b[j];
+        b[i] /= R[i+i*d];
+    }
+    for(int i=d-1; i>=0; --i)
+    {
+        for(int j=i+1; j<d; ++j)
+            b[i] -= R[i+j*d]*b[j];
+        b[i] /= R[i+i*d];
+    }
+}
+
+template<typename T>
+void checkFactor(const std::vector<T>& R, const std::vector<T>& expected, T tol)
+{
+    for(int i=0; i<d*d; ++i)
+        BOOST_CHECK_SMALL(R[i] - expected[i], tol);
+}
+
+template<typename T>
+void checkUpdate(T tol)
+{
+    const std::vector<T> A = initialMatrix<T>();
+    std::vector<T> work(cholupdateWorkSize(d, 5));
+
+    // rank-1 update with a strided vector, taken from a row of a 3-by-d matrix
+    const std::vector<T> X3 = samples<T>(0, 3);
+    std::vector<T> R = factor(A);
+    cholupdate(&R[0], d, &X3[1], 3, &work[0]);
+
+    std::vector<T> x(d);
+    for(int j=0; j<d; ++j)
+        x[j] = X3[1+j*3];
+    checkFactor(R, factor(addGram(A, x, 1, (T)1)), tol);
+
+    // rank-k update
+    const std::vector<T> X = samples<T>(20, 5);
+    R = factor(A);
+    cholupdate(&R[0], d, &X[0], 5, 5, &work[0]);
+    checkFactor(R, factor(addGram(A, X, 5, (T)1)), tol);
+}
+
+template<typename T>
+void checkDowndate(T tol)
+{
+    const std::vector<T> A = initialMatrix<T>();
+    const std::vector<T> X = samples<T>(100, 10);
+    std::vector<T> work(choldowndateWorkSize(d));
+
+    // rank-1 downdate of one of the samples in A
+    std::vector<T> x(d);
+    for(int j=0; j<d; ++j)
+        x[j] = X[3+j*10];
+
+    std::vector<T> R = factor(A);
+    choldowndate(&R[0], d, &x[0], 1, &work[0]);
+    checkFactor(R, factor(addGram(A, x, 1, (T)-1)), tol);
+
+    // rank-k downdate of all of them, back to 2*I
+    R = factor(A);
+    choldowndate(&R[0], d, &X[0], 10, 10, &work[0]);
+
+    std::vector<T> I(d*d, 0);
+    for(int i=0; i<d; ++i)
+        I[i+i*d] = 2;
+    checkFactor(R, factor(I), tol);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(UpdateMatchesFreshFactorization)
+{
+    checkUpdate<double>(1e-10);
+    checkUpdate<float>(1e-4f);
+}
+
+BOOST_AUTO_TEST_CASE(DowndateMatchesFreshFactorization)
+{
+    checkDowndate<double>(1e-10);
+    checkDowndate<float>(1e-4f);
+}
+
+BOOST_AUTO_TEST_CASE(IndefiniteDowndateThrows)
+{
+    // R'*R = 2*I, and x'*x = 2 leaves a singular matrix
+    std::vector<double> R(d*d, 0);
+    for(int i=0; i<d; ++i)
+        R[i+i*d] = std::sqrt(2.0);
+
+    std::vector<double> x(d, 0);
+    x[2] = std::sqrt(2.0);
+
+    const std::vector<double> R0(R);
+    std::vector<double> work(choldowndateWorkSize(d));
+    BOOST_CHECK_THROW(choldowndate(&R[0], d, &x[0], 1, &work[0]), gException);
+
+    // the factor is left unchanged
+    for(int i=0; i<d*d; ++i)
+        BOOST_CHECK_EQUAL(R[i], R0[i]);
+
+    x[2] = 3;
+    BOOST_CHECK_THROW(choldowndate(&R[0], d, &x[0], 1, &work[0]), gException);
+    for(int i=0; i<d*d; ++i)
+        BOOST_CHECK_EQUAL(R[i], R0[i]);
+}
+
+BOOST_AUTO_TEST_CASE(SlidingWindowMatchesBatchSolution)
+{
+    typedef double T;
+    const unsigned long n0 = 50, w = 30;
+    const unsigned long blocks[] = {7, 45, 1, 1, 12};
+
+    RecursiveRLSCholUpdateWrapper<T> wrapper("recursiveRLSChol");
+    wrapper.setWindowSize(w);
+
+    gMat2D<T> X, y;
+    synthetic::makeProblem(0, n0, d, X, y);
+    wrapper.train(X, y);
+
+    // the window is regularized with w*lambda, fixed when training
+    const gMat2D<T>& lambdas = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("paramsel.lambdas");
+    const T reg = w*lambdas.getData()[0];
+
+    unsigned long next = n0;
+    for(unsigned long b=0; b<sizeof(blocks)/sizeof(blocks[0]); ++b)
+    {
+        gMat2D<T> Xb, yb;
+        synthetic::makeProblem(next, blocks[b], d, Xb, yb);
+        wrapper.update(Xb, yb);
+        next += blocks[b];
+
+        // batch solution on the last w samples
+        //  W = (Xw'*Xw + reg*eye(d))\(Xw'*yw);
+        const std::vector<T> Xw = samples<T>(next-w, w);
+        std::vector<T> I(d*d, 0);
+        for(int i=0; i<d; ++i)
+            I[i+i*d] = reg;
+        std::vector<T> Wb(d, 0);
+        for(int j=0; j<d; ++j)
+            for(unsigned long i=0; i<w; ++i)
+                Wb[j] += Xw[i+j*w]*synthetic::label(next-w+i, d);
+
+        const std::vector<T> R = factor(addGram(I, Xw, w, (T)1));
+        solve(R, Wb);
+
+        const gMat2D<T>& W = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+        const gMat2D<T>& Rw = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("optimizer.R");
+        for(int j=0; j<d; ++j)
+            BOOST_CHECK_CLOSE(W.getData()[j], Wb[j], 1e-6);
+        for(int i=0; i<d*d; ++i)
+            BOOST_CHECK_SMALL(Rw.getData()[i] - R[i], 1e-8);
+    }
+
+    // eval uses the windowed estimator
+    gMat2D<T> Xte(1, d);
+    T expected = 0;
+    const gMat2D<T>& W = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+    for(int j=0; j<d; ++j)
+    {
+        Xte.getData()[j] = static_cast<T>(synthetic::input(next, j));
+        expected += Xte.getData()[j]*W.getData()[j];
+    }
+    gMat2D<T>* pred = wrapper.eval(Xte);
+    BOOST_CHECK_CLOSE(pred->getData()[0], expected, 1e-10);
+    delete pred;
+}
@@ -0,0 +1,232 @@
+#include "csvparser.h"
+#include "exceptions.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <boost/random/mersenne_twister.hpp>
+
+#define BOOST_TEST_MODULE csvparser
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+/**
+ * Checks that the token is parsed exactly as strtod and strtof do, or rejected as they do
+ */
+void checkToken(const std::string& token)
+{
+    const char* begin = token.c_str();
+    const char* end = begin + token.size();
+
+    char* stop;
+    const double expected = std::strtod(begin, &stop);
+    const bool expectedValid = !token.empty() && stop == end;
+
+    double value;
+    BOOST_CHECK_MESSAGE(parseCSVFloatingPoint(begin, end, value) == expectedValid, "double validity of '" << token << "'");
+    if(expectedValid)
+        BOOST_CHECK_MESSAGE((std::isnan(value) && std::isnan(expected)) || std::memcmp(&value, &expected, sizeof(double)) == 0,
+                            "double '" << token << "': " << value << " != " << expected);
+
+    const float expectedf = std::strtof(begin, &stop);
+
+    float valuef;
+    BOOST_CHECK_MESSAGE(parseCSVFloatingPoint(begin, end, valuef) == expectedValid, "float validity of '" << token << "'");
+    if(expectedValid)
+        BOOST_CHECK_MESSAGE((std::isnan(valuef) && std::isnan(expectedf)) || std::memcmp(&valuef, &expectedf, sizeof(float)) == 0,
+                            "float '" << token << "': " << valuef << " != " << expectedf);
+}
+
+template<typename T>
+std::vector<T> parseText(const std::string& text, std::size_t nchunks, unsigned long& rows, unsigned long& cols, bool colMajor = true)
+{
+    CSVParser<T> parser(text.data(), text.size(), "test.txt", nchunks);
+    rows = parser.rows();
+    cols = parser.cols();
+
+    std::vector<T> data(rows*cols + 1);
+    parser.parse(&data[0], colMajor);
+    data.pop_back();
+    return data;
+}
+
+bool parseFails(const std::string& text, std::size_t nchunks = 0)
+{
+    try
+    {
+        unsigned long rows, cols;
+        parseText<double>(text, nchunks, rows, cols);
+    }
+    catch(gException&)
+    {
+        return true;
+    }
+    return false;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(FastPathMatchesStrtod)
+{
+    const char* tokens[] = {
+        // exactly representable significands and powers of ten, and the first ones that are not
+        "9007199254740992", "9007199254740993", "18014398509481984", "16777216", "16777217",
+        "1e22", "1e23", "1e-22", "1e-23", "1e10", "1e11", "1e-10", "1e-11", "9007199254740991e22", "9007199254740991e-22",
+        // more than 19 significant digits, with and without trailing zeros
+        "12345678901234567890", "1234567890123456789000", "1234567890123456789.0000", "0.12345678901234567890123",
+        "3.14159265358979323846264338", "00000000000000000000000001.5", "0.000000000000000000000000015",
+        // signs and exponents
+        "0", "-0", "+0", "-0.0", "+5", "-5", "-1.5e-3", "1E5", "2.5e+10", "2.5E-0", "-.5", "5.", ".5e1", "1e0", "1e-0",
+        "4.35", "0.1", "0.3", "123.456", "-987654.321e-3", "1e400", "-1e400", "1e-400", "4.9e-324", "1.7976931348623157e308",
+        "1e100000000", "inf", "-inf", "nan", "0x1p3",
+        // invalid tokens
+        "", "-", "+", ".", "e5", "1e", "1e+", "1e-", "--1", "+-1", "1.2.3", "1e5.5", "abc", "1a", "0x"
+    };
+
+    for(std::size_t i=0; i<sizeof(tokens)/sizeof(tokens[0]); ++i)
+        checkToken(tokens[i]);
+
+    // random significands and exponents around the limits of the fast path
+    boost::mt19937 gen(5489u);
+    for(int i=0; i<20000; ++i)
+    {
+        std::stringstream str;
+        if(gen() % 2)
+            str << '-';
+
+        const int digits = 1 + gen() % 20;
+        const int point = gen() % (digits+1);
+        for(int k=0; k<digits; ++k)
+        {
+            if(k == point && k > 0)
+                str << '.';
+            str << static_cast<char>('0' + gen() % 10);
+        }
+
+        if(gen() % 2)
+            str << ((gen() % 2)? 'e': 'E') << static_cast<int>(gen() % 61) - 30;
+
+        checkToken(str.str());
+    }
+
+    // shortest round-trip representations of random doubles
+    for(int i=0; i<5000; ++i)
+    {
+        const double x = std::ldexp(static_cast<double>(gen()), static_cast<int>(gen() % 200) - 100);
+        char buffer[32];
+        std::sprintf(buffer, "%.17g", x);
+        checkToken(buffer);
+        std::sprintf(buffer, "%.6g", x);
+        checkToken(buffer);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(EmptyLinesAndSeparators)
+{
+    const std::string text = "\n  \n1 2 3\r\n\r\n4,5,6\n\t\n7;8|9  \n\n10\t11 ,12";
+
+    unsigned long rows, cols;
+    const std::vector<double> data = parseText<double>(text, 1, rows, cols);
+    BOOST_REQUIRE_EQUAL(rows, 4ul);
+    BOOST_REQUIRE_EQUAL(cols, 3ul);
+
+    // column-major
+    const double expected[] = {1, 4, 7, 10, 2, 5, 8, 11, 3, 6, 9, 12};
+    for(int i=0; i<12; ++i)
+        BOOST_CHECK_EQUAL(data[i], expected[i]);
+
+    const std::vector<float> rowMajor = parseText<float>(text, 1, rows, cols, false);
+    for(int i=0; i<12; ++i)
+        BOOST_CHECK_EQUAL(rowMajor[i], static_cast<float>(i+1));
+
+    // a text without values
+    parseText<double>("\n \r\n\n", 1, rows, cols);
+    BOOST_CHECK_EQUAL(rows, 0ul);
+    BOOST_CHECK_EQUAL(cols, 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(RaggedRowsAndInvalidValues)
+{
+    BOOST_CHECK(!parseFails("1 2\n3 4\n"));
+    BOOST_CHECK(parseFails("1 2\n3\n"));
+    BOOST_CHECK(parseFails("1 2\n3 4 5\n"));
+    BOOST_CHECK(parseFails("1 2\n\n3 4\n5 6 7"));
+    BOOST_CHECK(parseFails("1 2\n3 x\n"));
+    BOOST_CHECK(parseFails("1 2\n3 1e\n"));
+
+    // the error names the first bad row, counting only the rows with values
+    try
+    {
+        unsigned long rows, cols;
+        parseText<double>("1 2\n\n3 4\n5\n6 7\n", 3, rows, cols);
+        BOOST_ERROR("ragged row accepted");
+    }
+    catch(gException& e)
+    {
+        BOOST_CHECK(e.getMessage().find("row 3 ") != std::string::npos);
+        BOOST_CHECK(e.getMessage().find("test.txt") != std::string::npos);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(ChunkBoundariesMidLine)
+{
+    // lines of different lengths, empty lines and a last line without newline
+    std::stringstream str;
+    const unsigned long nrows = 500, ncols = 7;
+    for(unsigned long i=0; i<nrows; ++i)
+    {
+        for(unsigned long j=0; j<ncols; ++j)
+            str << ((j > 0)? ((i % 3)? " ": ", "): "") << (i*ncols + j)*0.25 - 100;
+
+        if(i % 17 == 0)
+            str << "\n  ";
+        if(i+1 < nrows)
+            str << ((i % 5)? "\n": "\r\n");
+    }
+    const std::string text = str.str();
+
+    unsigned long rows, cols;
+    const std::vector<double> reference = parseText<double>(text, 1, rows, cols);
+    BOOST_REQUIRE_EQUAL(rows, nrows);
+    BOOST_REQUIRE_EQUAL(cols, ncols);
+    for(unsigned long i=0; i<nrows; ++i)
+        for(unsigned long j=0; j<ncols; ++j)
+            BOOST_REQUIRE_EQUAL(reference[i + nrows*j], (i*ncols + j)*0.25 - 100);
+
+    // every number of chunks puts the boundaries in different places of the lines,
+    // including more chunks than lines and than characters
+    const std::size_t chunks[] = {2, 3, 7, 16, 61, 499, 500, 501, 1000, text.size(), text.size()+3};
+    for(std::size_t c=0; c<sizeof(chunks)/sizeof(chunks[0]); ++c)
+    {
+        const std::vector<double> data = parseText<double>(text, chunks[c], rows, cols);
+        BOOST_REQUIRE_EQUAL(rows, nrows);
+        BOOST_REQUIRE_EQUAL(cols, ncols);
+        BOOST_CHECK(data == reference);
+    }
+
+    // a ragged row is found whichever chunk it falls in
+    const std::string ragged = text + "\n1 2";
+    for(std::size_t c=0; c<sizeof(chunks)/sizeof(chunks[0]); ++c)
+        BOOST_CHECK(parseFails(ragged, chunks[c]));
+
+    // the default split, one chunk per thread on texts of at least 64KB
+    std::string large;
+    while(large.size() < (1u << 19))
+        large += text + "\n";
+
+    const std::vector<double> data = parseText<double>(large, 0, rows, cols);
+    BOOST_REQUIRE_EQUAL(cols, ncols);
+    BOOST_REQUIRE_EQUAL(rows % nrows, 0ul);
+    for(unsigned long i=0; i<rows; ++i)
+        BOOST_REQUIRE_EQUAL(data[i], reference[i % nrows]);
+}
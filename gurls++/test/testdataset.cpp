@@ -0,0 +1,255 @@
+#include "dataset.h"
+#include "exceptions.h"
+#include "gmat2d.h"
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#define BOOST_TEST_MODULE dataset
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+const std::string datasetFile("testdataset.bin");
+
+template<typename T>
+void fillDataset(gMat2D<T>& X, gMat2D<T>& y)
+{
+    T* x = X.getData();
+    for(unsigned long i=0; i<X.getSize(); ++i)
+        x[i] = static_cast<T>(std::sin(0.37*i) * (1+i%7));
+
+    T* o = y.getData();
+    for(unsigned long i=0; i<y.getSize(); ++i)
+        o[i] = static_cast<T>(std::cos(0.11*i) - 0.5);
+}
+
+template<typename T>
+void writeDataset(const gMat2D<T>& X, const gMat2D<T>& y, unsigned long chunkRows, DatasetFileHeader::Layout layout)
+{
+    DatasetWriter<T> writer(datasetFile, X.cols(), y.cols(), chunkRows, layout);
+    writer.write(X, y);
+    writer.close();
+}
+
+std::vector<char> loadFile()
+{
+    std::ifstream in(datasetFile.c_str(), std::ios::binary);
+    return std::vector<char>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+}
+
+void saveFile(const std::vector<char>& bytes)
+{
+    std::ofstream out(datasetFile.c_str(), std::ios::binary | std::ios::trunc);
+    out.write(&bytes[0], bytes.size());
+}
+
+bool openFails()
+{
+    try
+    {
+        DatasetChunkReader<double> reader(datasetFile);
+    }
+    catch(gException&)
+    {
+        return true;
+    }
+    return false;
+}
+
+template<typename T>
+void checkRoundTrip(unsigned long chunkRows, DatasetFileHeader::Layout layout)
+{
+    const unsigned long n = 103, d = 5, t = 2;
+
+    gMat2D<T> X(n, d), y(n, t);
+    fillDataset(X, y);
+    writeDataset(X, y, chunkRows, layout);
+
+    DatasetChunkReader<T> reader(datasetFile);
+    BOOST_REQUIRE_EQUAL(reader.rows(), n);
+    BOOST_REQUIRE_EQUAL(reader.cols(), d);
+    BOOST_REQUIRE_EQUAL(reader.outputs(), t);
+
+    gMat2D<T> Xr, yr;
+    reader.readAll(Xr, yr);
+    BOOST_REQUIRE_EQUAL(Xr.rows(), n);
+    BOOST_REQUIRE_EQUAL(yr.cols(), t);
+    BOOST_CHECK(std::memcmp(Xr.getData(), X.getData(), X.getSize()*sizeof(T)) == 0);
+    BOOST_CHECK(std::memcmp(yr.getData(), y.getData(), y.getSize()*sizeof(T)) == 0);
+
+    // Reading in blocks that do not match the chunks must give the same samples
+    reader.rewind();
+    const unsigned long block = 17;
+    std::vector<T> xb(block*d), yb(block*t);
+    unsigned long row = 0, count;
+    while((count = reader.read(&xb[0], block, &yb[0], block, block)) > 0)
+    {
+        for(unsigned long j=0; j<d; ++j)
+            for(unsigned long i=0; i<count; ++i)
+                BOOST_REQUIRE_EQUAL(xb[i+j*block], X.getData()[row+i+j*n]);
+        for(unsigned long j=0; j<t; ++j)
+            for(unsigned long i=0; i<count; ++i)
+                BOOST_REQUIRE_EQUAL(yb[i+j*block], y.getData()[row+i+j*n]);
+        row += count;
+    }
+    BOOST_CHECK_EQUAL(row, n);
+
+    // seek() positions the next read on any sample
+    reader.seek(n-3);
+    BOOST_CHECK_EQUAL(reader.read(&xb[0], block, &yb[0], block, block), 3ul);
+    BOOST_CHECK_EQUAL(xb[2+(d-1)*block], X.getData()[n-1+(d-1)*n]);
+
+    // The stored statistics match the mean and the n-1 normalized std of every column
+    BOOST_REQUIRE(reader.hasStats());
+    gMat2D<T> meanX, stdX, meanY, stdY;
+    reader.getStats(meanX, stdX, meanY, stdY);
+    for(unsigned long j=0; j<d; ++j)
+    {
+        double mean = 0, m2 = 0;
+        for(unsigned long i=0; i<n; ++i)
+            mean += X.getData()[i+j*n];
+        mean /= n;
+        for(unsigned long i=0; i<n; ++i)
+            m2 += (X.getData()[i+j*n]-mean)*(X.getData()[i+j*n]-mean);
+
+        BOOST_CHECK_CLOSE(static_cast<double>(meanX.getData()[j]), mean, 1e-3);
+        BOOST_CHECK_CLOSE(static_cast<double>(stdX.getData()[j]), std::sqrt(m2/(n-1)), 1e-3);
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(RoundTripColumnChunks)
+{
+    checkRoundTrip<double>(10, DatasetFileHeader::COLUMN_CHUNKS);
+    checkRoundTrip<float>(64, DatasetFileHeader::COLUMN_CHUNKS);
+    std::remove(datasetFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(RoundTripRowChunks)
+{
+    checkRoundTrip<double>(10, DatasetFileHeader::ROW_CHUNKS);
+    checkRoundTrip<double>(1000, DatasetFileHeader::ROW_CHUNKS);
+    std::remove(datasetFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(ConvertFloatToDouble)
+{
+    gMat2D<float> X(31, 3), y(31, 1);
+    fillDataset(X, y);
+    writeDataset(X, y, 8, DatasetFileHeader::COLUMN_CHUNKS);
+
+    DatasetChunkReader<double> reader(datasetFile);
+    gMat2D<double> Xr, yr;
+    reader.readAll(Xr, yr);
+    for(unsigned long i=0; i<X.getSize(); ++i)
+        BOOST_REQUIRE_EQUAL(Xr.getData()[i], static_cast<double>(X.getData()[i]));
+
+    std::remove(datasetFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(RewriteFromReader)
+{
+    gMat2D<double> X(50, 4), y(50, 2);
+    fillDataset(X, y);
+    writeDataset(X, y, 7, DatasetFileHeader::ROW_CHUNKS);
+
+    const std::string copyFile("testdataset_copy.bin");
+    {
+        DatasetChunkReader<double> reader(datasetFile);
+        DatasetWriter<double> writer(copyFile, reader.cols(), reader.outputs(), 16);
+        writer.write(reader);
+        writer.close();
+    }
+
+    DatasetChunkReader<double> reader(copyFile);
+    gMat2D<double> Xr, yr;
+    reader.readAll(Xr, yr);
+    BOOST_CHECK(std::memcmp(Xr.getData(), X.getData(), X.getSize()*sizeof(double)) == 0);
+    BOOST_CHECK(std::memcmp(yr.getData(), y.getData(), y.getSize()*sizeof(double)) == 0);
+
+    std::remove(copyFile.c_str());
+    std::remove(datasetFile.c_str());
+}
+
+BOOST_AUTO_TEST_CASE(CorruptedHeader)
+{
+    gMat2D<double> X(40, 3), y(40, 1);
+    fillDataset(X, y);
+    writeDataset(X, y, 16, DatasetFileHeader::COLUMN_CHUNKS);
+
+    const std::vector<char> good = loadFile();
+    BOOST_REQUIRE(!openFails());
+
+    DatasetFileHeader header(0, 0, 0, 0, false, DatasetFileHeader::COLUMN_CHUNKS);
+    std::memcpy(&header, &good[0], DatasetFileHeader::headerSize);
+
+    // Truncated below the header size
+    saveFile(std::vector<char>(good.begin(), good.begin() + 100));
+    BOOST_CHECK(openFails());
+
+    // Wrong magic
+    std::vector<char> bytes = good;
+    bytes[0] = 'X';
+    saveFile(bytes);
+    BOOST_CHECK(openFails());
+
+    // Unknown version
+    DatasetFileHeader bad = header;
+    bad.version = 2;
+    bytes = good;
+    std::memcpy(&bytes[0], &bad, DatasetFileHeader::headerSize);
+    saveFile(bytes);
+    BOOST_CHECK(openFails());
+
+    // Number of chunks inconsistent with rows and chunkRows
+    bad = header;
+    bad.chunks += 1;
+    std::memcpy(&bytes[0], &bad, DatasetFileHeader::headerSize);
+    saveFile(bytes);
+    BOOST_CHECK(openFails());
+
+    // Index past the end of the file
+    bad = header;
+    bad.indexOffset = good.size();
+    std::memcpy(&bytes[0], &bad, DatasetFileHeader::headerSize);
+    saveFile(bytes);
+    BOOST_CHECK(openFails());
+
+    // More rows than the chunks can hold
+    bad = header;
+    bad.rows = 1000000;
+    bad.chunks = (bad.rows + bad.chunkRows - 1)/bad.chunkRows;
+    std::memcpy(&bytes[0], &bad, DatasetFileHeader::headerSize);
+    saveFile(bytes);
+    BOOST_CHECK(openFails());
+
+    // A chunk offset pointing past the end of the file
+    bytes = good;
+    unsigned long long offset = good.size();
+    std::memcpy(&bytes[header.indexOffset], &offset, sizeof(offset));
+    saveFile(bytes);
+    BOOST_CHECK(openFails());
+
+    // Truncated file: the last chunks and the index are missing
+    saveFile(std::vector<char>(good.begin(), good.begin() + good.size()/2));
+    BOOST_CHECK(openFails());
+
+    // Element type not matching the reader
+    gMat2D<int> Xi(4, 2), yi(4, 1);
+    Xi = 1;
+    yi = 0;
+    writeDataset(Xi, yi, 4, DatasetFileHeader::COLUMN_CHUNKS);
+    BOOST_CHECK(openFails());
+
+    std::remove(datasetFile.c_str());
+}
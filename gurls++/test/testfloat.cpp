@@ -0,0 +1,137 @@
+#include "gurls.h"
+#include "recrlswrapper.h"
+#include "syntheticdata.h"
+
+#include <cmath>
+#include <string>
+
+#define BOOST_TEST_MODULE float
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+template<typename T>
+gMat2D<T> runPipeline(const gMat2D<T>& Xtr, const gMat2D<T>& ytr, const gMat2D<T>& Xte, const gMat2D<T>& yte,
+                      const char* kernel, const char* optimizer, const char* pred)
+{
+    OptTaskSequence* seq = new OptTaskSequence();
+    *seq << "split:ho" << "paramsel:hoprimal" << kernel << optimizer << pred << "perf:rmse";
+
+    GurlsOptionsList* process = new GurlsOptionsList("processes", false);
+
+    OptProcess* train = new OptProcess();
+    *train << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave << GURLS::computeNsave << GURLS::ignore << GURLS::ignore;
+    process->addOpt("train", train);
+
+    OptProcess* test = new OptProcess();
+    *test << GURLS::load << GURLS::load << GURLS::load << GURLS::load << GURLS::computeNsave << GURLS::computeNsave;
+    process->addOpt("test", test);
+
+    GurlsOptionsList opt("testfloat", true);
+    opt.addOpt("seq", seq);
+    opt.addOpt("processes", process);
+
+    GURLS G;
+    G.run(Xtr, ytr, opt, std::string("train"));
+    G.run(Xte, yte, opt, std::string("test"));
+
+    // the memory usage of every task is stored with the element type of the pipeline
+    const gMat2D<T>& memory = opt.getOptValue<OptMatrix<gMat2D<T> > >("time.train_memory");
+    BOOST_CHECK_EQUAL(memory.rows(), 4ul);
+
+    // the resident memory row holds the growth during each task, which adds up to at most the
+    // peak of the process (up to the rounding to T)
+    double growth = 0;
+    for(unsigned long i=0; i<memory.cols(); ++i)
+        growth += memory.getData()[4*i+3];
+    BOOST_CHECK_LE(growth, 1.001*Allocator::processResidentPeakBytes());
+
+    return opt.getOptValue<OptMatrix<gMat2D<T> > >("pred");
+}
+
+template<typename T>
+double relativeError(const gMat2D<T>& a, const gMat2D<double>& b)
+{
+    double num = 0, den = 0;
+    for(unsigned long i=0; i<b.getSize(); ++i)
+    {
+        num += (a.getData()[i]-b.getData()[i])*(a.getData()[i]-b.getData()[i]);
+        den += b.getData()[i]*b.getData()[i];
+    }
+    return std::sqrt(num/den);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(PrimalPipeline)
+{
+    gMat2D<float> Xtr, ytr, Xte, yte;
+    gMat2D<double> Xtrd, ytrd, Xted, yted;
+    synthetic::makeProblem(0, 200, 5, Xtr, ytr);
+    synthetic::makeProblem(200, 50, 5, Xte, yte);
+    synthetic::makeProblem(0, 200, 5, Xtrd, ytrd);
+    synthetic::makeProblem(200, 50, 5, Xted, yted);
+
+    const gMat2D<float> pred = runPipeline(Xtr, ytr, Xte, yte, "kernel:linear", "optimizer:rlsprimal", "pred:primal");
+    const gMat2D<double> predd = runPipeline(Xtrd, ytrd, Xted, yted, "kernel:linear", "optimizer:rlsprimal", "pred:primal");
+
+    BOOST_REQUIRE_EQUAL(pred.rows(), 50ul);
+    BOOST_CHECK_LT(relativeError(pred, predd), 1e-3);
+    BOOST_CHECK_LT(relativeError(pred, yted), 1e-1);
+}
+
+BOOST_AUTO_TEST_CASE(RecursiveWrapper)
+{
+    gMat2D<float> Xtr, ytr, Xup, yup, Xte, yte;
+    gMat2D<double> Xtrd, ytrd, Xupd, yupd, Xted, yted;
+    synthetic::makeProblem(0, 100, 4, Xtr, ytr);
+    synthetic::makeProblem(100, 60, 4, Xup, yup);
+    synthetic::makeProblem(160, 30, 4, Xte, yte);
+    synthetic::makeProblem(0, 100, 4, Xtrd, ytrd);
+    synthetic::makeProblem(100, 60, 4, Xupd, yupd);
+    synthetic::makeProblem(160, 30, 4, Xted, yted);
+
+    RecursiveRLSWrapper<float> wrapper("recursiveRLS");
+    RecursiveRLSWrapper<double> wrapperd("recursiveRLS");
+
+    wrapper.setForgettingFactor(0.98);
+    wrapperd.setForgettingFactor(0.98);
+
+    wrapper.train(Xtr, ytr);
+    wrapperd.train(Xtrd, ytrd);
+
+    wrapper.update(Xup, yup);
+    wrapperd.update(Xupd, yupd);
+
+    gMat2D<float>* pred = wrapper.eval(Xte);
+    gMat2D<double>* predd = wrapperd.eval(Xted);
+    BOOST_CHECK_LT(relativeError(*pred, *predd), 1e-3);
+    delete pred;
+    delete predd;
+
+    wrapper.retrain();
+    wrapperd.retrain();
+
+    pred = wrapper.eval(Xte);
+    predd = wrapperd.eval(Xted);
+    BOOST_CHECK_LT(relativeError(*pred, *predd), 1e-3);
+    delete pred;
+    delete predd;
+
+    wrapper.prepareRealTimeUpdate(16);
+    for(unsigned long i=0; i<Xup.rows(); ++i)
+    {
+        float x[4], y = yup.getData()[i];
+        for(unsigned long j=0; j<4; ++j)
+            x[j] = Xup.getData()[i+j*Xup.rows()];
+        wrapper.realTimeUpdate(x, &y);
+    }
+
+    pred = wrapper.eval(Xte);
+    BOOST_CHECK_LT(relativeError(*pred, yted), 1e-1);
+    delete pred;
+}
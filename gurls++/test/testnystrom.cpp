@@ -0,0 +1,91 @@
+#include "gurls.h"
+#include "nystromwrapper.h"
+#include "syntheticdata.h"
+
+#define BOOST_TEST_MODULE nystrom
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+typedef double T;
+
+namespace
+{
+
+const unsigned long d = 4;
+
+/**
+ * Linear regression problem on the synthetic inputs shifted to [0, 2], as the
+ * chi-squared kernel requires non-negative inputs
+ */
+void makeProblem(unsigned long first, unsigned long n, gMat2D<T>& X, gMat2D<T>& y)
+{
+    synthetic::makeProblem(first, n, d, X, y, 0.0);
+    for(unsigned long i=0; i<X.getSize(); ++i)
+        X.getData()[i] += 1;
+    for(unsigned long i=0; i<n; ++i)
+        y.getData()[i] += d*(d+1)/2.0;
+}
+
+/**
+ * Nystrom wrapper with the given kernel type and landmark selection
+ */
+class TestNystromWrapper: public NystromWrapper<T>
+{
+public:
+    TestNystromWrapper(const std::string& kernelType, LandmarkSelection selection): NystromWrapper<T>("nystrom")
+    {
+        GurlsOptionsList* kernel = new GurlsOptionsList("kernel");
+        kernel->addOpt("type", kernelType);
+        this->opt->addOpt("kernel", kernel);
+        this->opt->template getOptAs<GurlsOptionsList>("paramsel")->addOpt("sigma", new OptNumber(2.0));
+
+        this->setProblemType(REGRESSION);
+        this->setParam(20);
+        this->setLandmarkSelection(selection);
+    }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(BlockedEvalMatchesEval)
+{
+    gMat2D<T> X, y, Xte, yte;
+    makeProblem(0, 100, X, y);
+    makeProblem(100, 53, Xte, yte);
+
+    const char* kernels[] = {"rbf", "linear", "chisquared"};
+    for(int k=0; k<3; ++k)
+    {
+        TestNystromWrapper wrapper(kernels[k], NystromWrapper<T>::UNIFORM);
+        wrapper.train(X, y);
+        wrapper.setEvalBlockSize(8);
+
+        gMat2D<T>* pred = wrapper.eval(Xte);
+        gMat2D<T>* blocked = wrapper.eval_largescale(Xte);
+
+        BOOST_REQUIRE_EQUAL(blocked->rows(), 53ul);
+        BOOST_REQUIRE_EQUAL(blocked->cols(), 1ul);
+        for(unsigned long i=0; i<53; ++i)
+            BOOST_CHECK_SMALL(blocked->getData()[i] - pred->getData()[i], 1e-8);
+
+        delete pred;
+        delete blocked;
+    }
+}
+
+BOOST_AUTO_TEST_CASE(LandmarkSelectionRejectsUnsupportedKernels)
+{
+    gMat2D<T> X, y;
+    makeProblem(0, 100, X, y);
+
+    TestNystromWrapper leverage("chisquared", NystromWrapper<T>::LEVERAGE);
+    BOOST_CHECK_THROW(leverage.train(X, y), gException);
+
+    TestNystromWrapper kmeanspp("chisquared", NystromWrapper<T>::KMEANSPP);
+    BOOST_CHECK_THROW(kmeanspp.train_largescale(X, y), gException);
+
+    TestNystromWrapper rbf("rbf", NystromWrapper<T>::KMEANSPP);
+    BOOST_CHECK_NO_THROW(rbf.train(X, y));
+}
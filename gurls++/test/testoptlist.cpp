@@ -0,0 +1,238 @@
+#include "optlist.h"
+#include "options.h"
+#include "optmatrix.h"
+#include "exceptions.h"
+#include "gmat2d.h"
+
+#include <cstdio>
+#include <sstream>
+#include <string>
+
+#define BOOST_TEST_MODULE optlist
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+std::string keyName(int i)
+{
+    std::stringstream str;
+    str << "key" << i;
+    return str.str();
+}
+
+/**
+ * Returns true if adding a number with the given key is refused, without leaking it
+ */
+bool addFails(GurlsOptionsList& opt, const std::string& key)
+{
+    OptNumber* value = new OptNumber(0);
+    try
+    {
+        opt.addOpt(key, value);
+    }
+    catch(gException&)
+    {
+        delete value;
+        return true;
+    }
+    return false;
+}
+
+/**
+ * List filling itself in the constructor, as BGurlsOptionsList does
+ */
+class DerivedOptionsList: public GurlsOptionsList
+{
+public:
+    DerivedOptionsList(): GurlsOptionsList("derived", true)
+    {
+        addOpt("nb_pred", new OptNumber(3));
+
+        GurlsOptionsList* files = new GurlsOptionsList("files");
+        files->addOpt("Xva_filename", "Xva.h5");
+        addOpt("files", files);
+    }
+};
+
+}
+
+BOOST_AUTO_TEST_CASE(AddAndLookup)
+{
+    GurlsOptionsList opt("test");
+
+    // enough keys to grow the index several times
+    for(int i=0; i<200; ++i)
+        opt.addOpt(keyName(i), new OptNumber(i));
+
+    for(int i=0; i<200; ++i)
+    {
+        const std::string key = keyName(i);
+        BOOST_REQUIRE(opt.hasOpt(key));
+        BOOST_CHECK_EQUAL(opt.getOptAsNumber(key), i);
+        BOOST_CHECK_EQUAL(opt.getOptAsNumber(key.c_str()), i);
+    }
+
+    BOOST_CHECK(!opt.hasOpt("key200"));
+    BOOST_CHECK(opt.findOpt("key200") == NULL);
+    BOOST_CHECK_THROW(opt.getOpt("key200"), gException);
+
+    // keys are unique
+    BOOST_CHECK(addFails(opt, "key7"));
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber("key7"), 7);
+}
+
+BOOST_AUTO_TEST_CASE(RemoveAndReAdd)
+{
+    GurlsOptionsList opt("test");
+    for(int i=0; i<50; ++i)
+        opt.addOpt(keyName(i), new OptNumber(i));
+
+    for(int i=0; i<50; i+=2)
+        opt.removeOpt(keyName(i));
+
+    for(int i=0; i<50; ++i)
+        BOOST_CHECK_EQUAL(opt.hasOpt(keyName(i)), (i%2) == 1);
+
+    for(int i=0; i<50; i+=2)
+        opt.addOpt(keyName(i), new OptNumber(-i));
+
+    for(int i=0; i<50; ++i)
+        BOOST_CHECK_EQUAL(opt.getOptAsNumber(keyName(i)), (i%2)? i: -i);
+
+    // removing a missing key is not an error
+    opt.removeOpt("missing");
+    BOOST_CHECK_EQUAL(opt.size(), 51);
+}
+
+BOOST_AUTO_TEST_CASE(Rename)
+{
+    GurlsOptionsList opt("before");
+    opt.addOpt("value", new OptNumber(1));
+
+    opt.setName("after");
+    BOOST_CHECK_EQUAL(opt.getName(), "after");
+    BOOST_CHECK_EQUAL(opt.getOptAsString("Name"), "after");
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber("value"), 1);
+
+    // moving an option to a new key
+    GurlsOption* value = opt.getOpt("value");
+    opt.removeOpt("value", false);
+    opt.addOpt("renamed", value);
+    BOOST_CHECK(!opt.hasOpt("value"));
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber("renamed"), 1);
+}
+
+BOOST_AUTO_TEST_CASE(NestedLookup)
+{
+    GurlsOptionsList opt("test");
+    GurlsOptionsList* a = new GurlsOptionsList("a");
+    GurlsOptionsList* b = new GurlsOptionsList("b");
+    b->addOpt("c", new OptNumber(42));
+    a->addOpt("b", b);
+    opt.addOpt("a", a);
+
+    BOOST_CHECK(opt.hasOpt("a.b.c"));
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber("a.b.c"), 42);
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber(std::string("a.b.c")), 42);
+    BOOST_CHECK(opt.getOptAs<GurlsOptionsList>("a.b") == b);
+
+    BOOST_CHECK(!opt.hasOpt("a.b.d"));
+    BOOST_CHECK(!opt.hasOpt("a.x.c"));
+    BOOST_CHECK(!opt.hasOpt("a.b.c.d"));
+    BOOST_CHECK_THROW(opt.getOpt("a.b.d"), gException);
+
+    // the nested index follows the changes of the nested lists
+    b->removeOpt("c");
+    b->addOpt("d", new OptNumber(7));
+    BOOST_CHECK(!opt.hasOpt("a.b.c"));
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber("a.b.d"), 7);
+}
+
+BOOST_AUTO_TEST_CASE(FilledByDerivedClass)
+{
+    DerivedOptionsList opt;
+
+    BOOST_CHECK_EQUAL(opt.getOptAsNumber("nb_pred"), 3);
+    BOOST_CHECK_EQUAL(opt.getOptAsString("files.Xva_filename"), "Xva.h5");
+    BOOST_CHECK(opt.hasOpt("hoproportion"));
+    BOOST_CHECK(addFails(opt, "nb_pred"));
+}
+
+BOOST_AUTO_TEST_CASE(CopyAndLoad)
+{
+    GurlsOptionsList opt("test", true);
+    GurlsOptionsList* nested = new GurlsOptionsList("nested");
+    nested->addOpt("x", new OptNumber(5));
+    opt.addOpt("nested", nested);
+
+    GurlsOptionsList copy(opt);
+    BOOST_CHECK_EQUAL(copy.size(), opt.size());
+    BOOST_CHECK_EQUAL(copy.getOptAsNumber("nested.x"), 5);
+    BOOST_CHECK_EQUAL(copy.getOptAsNumber("nlambda"), opt.getOptAsNumber("nlambda"));
+
+    const std::string fileName("testoptlist.bin");
+    opt.save(fileName);
+
+    GurlsOptionsList loaded("", false);
+    loaded.load(fileName);
+    std::remove(fileName.c_str());
+
+    BOOST_CHECK_EQUAL(loaded.getName(), "test");
+    BOOST_CHECK_EQUAL(loaded.size(), opt.size());
+    BOOST_CHECK_EQUAL(loaded.getOptAsNumber("nested.x"), 5);
+    BOOST_CHECK_EQUAL(loaded.getOptAsString("hoperf"), "macroavg");
+}
+
+BOOST_AUTO_TEST_CASE(CopyOnWrite)
+{
+    GurlsOptionsList opt("test");
+    gMat2D<double>* M = new gMat2D<double>(3, 2);
+    *M = 1.0;
+    opt.addOpt("M", new OptMatrix<gMat2D<double> >(*M));
+
+    GurlsOptionsList copy(opt);
+
+    const OptMatrix<gMat2D<double> >* original = opt.getOptAs<OptMatrix<gMat2D<double> > >("M");
+    const OptMatrix<gMat2D<double> >* copied = copy.getOptAs<OptMatrix<gMat2D<double> > >("M");
+
+    // the copy shares the matrix until one side writes to it
+    BOOST_CHECK(original->isShared());
+    BOOST_CHECK(copied->isShared());
+    BOOST_CHECK(original->getValue().getData() == copied->getValue().getData());
+
+    copy.getOptValue<OptMatrix<gMat2D<double> > >("M").getData()[0] = 5.0;
+
+    BOOST_CHECK(!original->isShared());
+    BOOST_CHECK(!copied->isShared());
+    BOOST_CHECK_EQUAL(opt.getOptValue<OptMatrix<gMat2D<double> > >("M").getData()[0], 1.0);
+    BOOST_CHECK_EQUAL(copy.getOptValue<OptMatrix<gMat2D<double> > >("M").getData()[0], 5.0);
+
+    // writing to the original leaves a second copy unchanged as well
+    GurlsOptionsList second("second");
+    second.copyOpt("M", opt);
+    opt.getOptValue<OptMatrix<gMat2D<double> > >("M").getData()[1] = 7.0;
+    BOOST_CHECK_EQUAL(second.getOptValue<OptMatrix<gMat2D<double> > >("M").getData()[1], 1.0);
+
+    // the last option sharing the matrix deletes it
+    opt.removeOpt("M");
+    BOOST_CHECK_EQUAL(second.getOptValue<OptMatrix<gMat2D<double> > >("M").getData()[0], 1.0);
+}
+
+BOOST_AUTO_TEST_CASE(CopyOfNonOwningOptionIsDeep)
+{
+    gMat2D<double> M(2, 2);
+    M = 3.0;
+
+    OptMatrix<gMat2D<double> > view(M, false);
+    OptMatrix<gMat2D<double> > copy(view);
+
+    BOOST_CHECK(!view.isShared());
+    BOOST_CHECK(copy.getValue().getData() != M.getData());
+
+    copy.getValue().getData()[0] = 4.0;
+    BOOST_CHECK_EQUAL(M.getData()[0], 3.0);
+}
@@ -0,0 +1,232 @@
+#include "recrlswrapper.h"
+#include "allocator.h"
+#include "syntheticdata.h"
+
+#include <cmath>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#define BOOST_TEST_MODULE recursiverls
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+typedef double T;
+
+/**
+ * Number of calls to operator new and new[] of the test program
+ */
+static unsigned long long allocations = 0;
+
+static void* countedAlloc(std::size_t size)
+{
+    ++allocations;
+    void* p = std::malloc(size? size: 1);
+    if(p == NULL)
+        throw std::bad_alloc();
+    return p;
+}
+
+// out of line, so that GCC does not pair the inlined malloc() and free() with new and delete
+__attribute__((noinline)) void* operator new(std::size_t size) { return countedAlloc(size); }
+__attribute__((noinline)) void* operator new[](std::size_t size) { return countedAlloc(size); }
+__attribute__((noinline)) void operator delete(void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+
+namespace
+{
+
+const unsigned long d = 4;
+
+/**
+ * Returns A'*B for the column-major matrices A and B with n rows
+ */
+std::vector<T> gram(const gMat2D<T>& A, const gMat2D<T>& B)
+{
+    std::vector<T> G(A.cols()*B.cols(), 0);
+    for(unsigned long a=0; a<A.cols(); ++a)
+        for(unsigned long b=0; b<B.cols(); ++b)
+            for(unsigned long i=0; i<A.rows(); ++i)
+                G[a+b*A.cols()] += A.getData()[i+a*A.rows()]*B.getData()[i+b*B.rows()];
+    return G;
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(ForgettingFactorAgesValidationSet)
+{
+    const unsigned long n0 = 40, nblock = 20, nsingle = 10, nrt = 10;
+    const unsigned long N = n0 + nblock + nsingle + nrt;
+    const T beta = 0.8;
+
+    RecursiveRLSWrapper<T> wrapper("recursiveRLS");
+    wrapper.setForgettingFactor(beta);
+
+    gMat2D<T> X, y;
+    synthetic::makeProblem(0, n0, d, X, y);
+    wrapper.train(X, y);
+
+    // validation samples of the initial training set
+    std::vector<bool> validation(N, false);
+    {
+        const gMat2D<unsigned long>& indices = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<unsigned long> > >("split.indices");
+        const unsigned long last = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<unsigned long> > >("split.lasts").getData()[0];
+        for(unsigned long i=last; i<n0; ++i)
+            validation[indices.getData()[i]] = true;
+    }
+
+    synthetic::makeProblem(n0, nblock, d, X, y);
+    wrapper.update(X, y);
+
+    for(unsigned long k=n0+nblock; k<n0+nblock+nsingle; ++k)
+    {
+        gVec<T> x(d), yk(1);
+        for(unsigned long j=0; j<d; ++j)
+            x[j] = synthetic::input(k, j);
+        yk[0] = synthetic::label(k, d);
+        wrapper.update(x, yk);
+    }
+
+    wrapper.prepareRealTimeUpdate(16);
+    for(unsigned long k=n0+nblock+nsingle; k<N; ++k)
+    {
+        T x[d], yk = synthetic::label(k, d);
+        for(unsigned long j=0; j<d; ++j)
+            x[j] = synthetic::input(k, j);
+        wrapper.realTimeUpdate(x, &yk);
+    }
+
+    // one sample every 1/hoproportion is added to the validation set after train()
+    const unsigned long proportion = static_cast<unsigned long>(gurls::round(1.0/wrapper.getOpt().getOptAsNumber("hoproportion")));
+    for(unsigned long k=n0; k<N; ++k)
+        validation[k] = ((k+1) % proportion == 0);
+
+    // expected weighted sums over the validation samples
+    std::vector<T> XvaXva(d*d, 0), Xvayva(d, 0);
+    for(unsigned long k=0; k<N; ++k)
+    {
+        if(!validation[k])
+            continue;
+
+        const T weight = std::pow(beta, static_cast<T>((k < n0)? N-n0: N-1-k));
+        for(unsigned long a=0; a<d; ++a)
+        {
+            for(unsigned long b=0; b<d; ++b)
+                XvaXva[a+b*d] += weight*synthetic::input(k, a)*synthetic::input(k, b);
+            Xvayva[a] += weight*synthetic::input(k, a)*synthetic::label(k, d);
+        }
+    }
+
+    const gMat2D<T>& Xva = wrapper.getValidationInputs();
+    const gMat2D<T>& yva = wrapper.getValidationLabels();
+
+    const std::vector<T> G = gram(Xva, Xva);
+    const std::vector<T> g = gram(Xva, yva);
+    for(unsigned long i=0; i<d*d; ++i)
+        BOOST_CHECK_CLOSE(G[i], XvaXva[i], 1e-8);
+    for(unsigned long i=0; i<d; ++i)
+        BOOST_CHECK_CLOSE(g[i], Xvayva[i], 1e-8);
+
+    // the training part of the decayed Gram matrix stays positive definite
+    const gMat2D<T>& XtX = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("kernel.XtX");
+    gMat2D<T> Q(d, d);
+    for(unsigned long i=0; i<d*d; ++i)
+        Q.getData()[i] = XtX.getData()[i] - G[i];
+
+    int info;
+    char uplo = 'L';
+    int dd = d;
+    potrf_(&uplo, &dd, Q.getData(), &dd, &info);
+    BOOST_CHECK_EQUAL(info, 0);
+
+    wrapper.retrain();
+    gMat2D<T> Xte;
+    synthetic::makeProblem(N, 10, d, Xte, y);
+    gMat2D<T>* pred = wrapper.eval(Xte);
+    for(unsigned long i=0; i<10; ++i)
+        BOOST_CHECK_SMALL(pred->getData()[i] - y.getData()[i], 0.5);
+    delete pred;
+}
+
+BOOST_AUTO_TEST_CASE(RealTimeUpdateKeepsCopiesUnchanged)
+{
+    RecursiveRLSWrapper<T> wrapper("recursiveRLS");
+
+    gMat2D<T> X, y;
+    synthetic::makeProblem(0, 40, d, X, y);
+    wrapper.train(X, y);
+    wrapper.prepareRealTimeUpdate(16);
+
+    // the copy shares the matrices of the estimator with the wrapper
+    const GurlsOptionsList copy(wrapper.getOpt());
+
+    const gMat2D<T>& W = copy.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+    const gMat2D<T>& XtX = copy.getOptValue<OptMatrix<gMat2D<T> > >("kernel.XtX");
+    BOOST_REQUIRE(copy.getOptAs<OptMatrix<gMat2D<T> > >("optimizer.W")->isShared());
+    const gMat2D<T> W0(W), XtX0(XtX);
+
+    for(unsigned long k=40; k<60; ++k)
+    {
+        T x[d], yk = synthetic::label(k, d);
+        for(unsigned long j=0; j<d; ++j)
+            x[j] = synthetic::input(k, j);
+        wrapper.realTimeUpdate(x, &yk);
+    }
+
+    for(unsigned long i=0; i<W.getSize(); ++i)
+        BOOST_CHECK_EQUAL(W.getData()[i], W0.getData()[i]);
+    for(unsigned long i=0; i<XtX.getSize(); ++i)
+        BOOST_CHECK_EQUAL(XtX.getData()[i], XtX0.getData()[i]);
+
+    // while the wrapper has been updated
+    const gMat2D<T>& Wupd = wrapper.getOpt().getOptValue<OptMatrix<gMat2D<T> > >("optimizer.W");
+    BOOST_CHECK(Wupd.getData() != W.getData());
+    BOOST_CHECK(Wupd.getData()[0] != W0.getData()[0]);
+}
+
+BOOST_AUTO_TEST_CASE(RealTimeUpdateDoesNotAllocateAfterUpdateAndRetrain)
+{
+    const unsigned long n0 = 40, nup = 150, nrt = 100, capacity = 5;
+
+    // the validation set holds 38 of 52 allocated rows after the update, and retrain() packs it
+    // before prepareRealTimeUpdate() reserves room for 5 more
+
+    // the same updates, without the real-time path
+    RecursiveRLSWrapper<T> wrapper("recursiveRLS"), reference("reference");
+    wrapper.setForgettingFactor(0.99);
+    reference.setForgettingFactor(0.99);
+
+    gMat2D<T> X, y;
+    synthetic::makeProblem(0, n0, d, X, y);
+    wrapper.train(X, y);
+    reference.train(X, y);
+    wrapper.prepareRealTimeUpdate(capacity);
+
+    synthetic::makeProblem(n0, nup, d, X, y);
+    wrapper.update(X, y);
+    reference.update(X, y);
+    wrapper.retrain();
+    reference.retrain();
+
+    std::vector<T> samples(nrt*d), labels(nrt);
+    for(unsigned long k=0; k<nrt; ++k)
+    {
+        for(unsigned long j=0; j<d; ++j)
+            samples[k*d+j] = synthetic::input(n0+nup+k, j);
+        labels[k] = synthetic::label(n0+nup+k, d);
+    }
+
+    const unsigned long long before = allocations + Allocator::stats().allocations;
+    for(unsigned long k=0; k<nrt; ++k)
+        wrapper.realTimeUpdate(&samples[k*d], &labels[k]);
+    const unsigned long long after = allocations + Allocator::stats().allocations;
+
+    BOOST_CHECK_EQUAL(after-before, 0ull);
+
+    // the validation samples beyond the capacity are discarded
+    BOOST_CHECK_EQUAL(wrapper.getValidationInputs().rows(), reference.getValidationInputs().rows()+capacity);
+}
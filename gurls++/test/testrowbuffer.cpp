@@ -0,0 +1,108 @@
+#include "rowbuffer.h"
+
+#define BOOST_TEST_MODULE rowbuffer
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+namespace
+{
+
+const unsigned long c = 3;
+
+void appendRows(RowBuffer<double>& buffer, unsigned long first, unsigned long n)
+{
+    for(unsigned long i=first; i<first+n; ++i)
+    {
+        const double row[c] = {double(i), 0.5*i, -double(i)};
+        buffer.append(row);
+    }
+}
+
+/**
+ * Checks that the buffer holds the rows first, ..., first+n-1 in order
+ */
+void checkRows(RowBuffer<double>& buffer, unsigned long first, unsigned long n)
+{
+    const gMat2D<double>& M = buffer.view();
+    BOOST_REQUIRE_EQUAL(M.rows(), n);
+    BOOST_REQUIRE_EQUAL(M.cols(), c);
+    for(unsigned long i=0; i<n; ++i)
+    {
+        BOOST_CHECK_EQUAL(M.getData()[i], double(first+i));
+        BOOST_CHECK_EQUAL(M.getData()[i+n], 0.5*(first+i));
+        BOOST_CHECK_EQUAL(M.getData()[i+2*n], -double(first+i));
+    }
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(AppendAndView)
+{
+    RowBuffer<double> buffer(c);
+    BOOST_CHECK(!buffer.hasRoom());
+
+    appendRows(buffer, 0, 1000);
+    checkRows(buffer, 0, 1000);
+
+    // appending after a view
+    appendRows(buffer, 1000, 10);
+    checkRows(buffer, 0, 1010);
+    BOOST_CHECK_EQUAL(buffer.rows(), 1010ul);
+
+    RowBuffer<double> empty(c);
+    BOOST_CHECK_EQUAL(empty.view().rows(), 0ul);
+}
+
+BOOST_AUTO_TEST_CASE(ReserveAfterViewDoesNotReallocate)
+{
+    RowBuffer<double> buffer(c);
+    buffer.reserve(1000);
+    BOOST_REQUIRE_EQUAL(buffer.capacity(), 1000ul);
+
+    appendRows(buffer, 0, 700);
+    checkRows(buffer, 0, 700);
+    const double* data = buffer.view().getData();
+
+    // the view packed the rows: room is reserved again below the allocated size
+    buffer.reserve(800);
+    for(unsigned long i=700; i<800; ++i)
+    {
+        BOOST_REQUIRE(buffer.hasRoom());
+        appendRows(buffer, i, 1);
+    }
+
+    // the reserved rows are used up, but the buffer is not reallocated while it has allocated rows
+    BOOST_CHECK(!buffer.hasRoom());
+    appendRows(buffer, 800, 200);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 1000ul);
+    checkRows(buffer, 0, 1000);
+    BOOST_CHECK(buffer.view().getData() == data);
+
+    // and grows past them
+    appendRows(buffer, 1000, 1);
+    BOOST_CHECK_GT(buffer.capacity(), 1000ul);
+    checkRows(buffer, 0, 1001);
+}
+
+BOOST_AUTO_TEST_CASE(RingBuffer)
+{
+    RowBuffer<double> buffer(c, 50);
+    buffer.reserve(200);
+    BOOST_CHECK_EQUAL(buffer.capacity(), 50ul);
+
+    appendRows(buffer, 0, 50);
+    checkRows(buffer, 0, 50);
+
+    // a full ring buffer always has room and overwrites the oldest rows
+    const double* data = buffer.view().getData();
+    BOOST_CHECK(buffer.hasRoom());
+    appendRows(buffer, 50, 50);
+    checkRows(buffer, 50, 50);
+    BOOST_CHECK(buffer.view().getData() == data);
+
+    buffer.scale(2.0);
+    const gMat2D<double>& M = buffer.view();
+    BOOST_CHECK_EQUAL(M.getData()[0], 100.0);
+}
@@ -0,0 +1,244 @@
+#include "gurls.h"
+#include "gprwrapper.h"
+#include "rbfkernel.h"
+#include "splitho.h"
+#include "predkerneltraintest.h"
+#include "syntheticdata.h"
+
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+#define BOOST_TEST_MODULE sparsegp
+
+#include <boost/test/unit_test.hpp>
+
+using namespace gurls;
+
+typedef double T;
+
+namespace
+{
+
+const unsigned long d = 3;
+const T sigma = 1.5;
+const T noise = 0.1;
+
+/**
+ * Non-linear regression problem on the synthetic inputs scaled by 2
+ */
+void makeProblem(unsigned long first, unsigned long n, gMat2D<T>& X, gMat2D<T>& y)
+{
+    synthetic::makeProblem(first, n, d, X, y, 0.15);
+    for(unsigned long i=0; i<n; ++i)
+    {
+        T target = 0;
+        for(unsigned long j=0; j<d; ++j)
+        {
+            T& x = X.getData()[i+j*n];
+            x *= 2;
+            target += std::sin(x + j);
+        }
+        y.getData()[i] = target + synthetic::noise(first+i);
+    }
+}
+
+/**
+ * Options with fixed noise level and kernel parameter, and as many inducing points as samples
+ */
+GurlsOptionsList* makeOptions(unsigned long n)
+{
+    GurlsOptionsList* opt = new GurlsOptionsList("test", true);
+
+    GurlsOptionsList* paramsel = new GurlsOptionsList("paramsel");
+    gMat2D<T>* lambdas = new gMat2D<T>(1, 1);
+    lambdas->getData()[0] = noise;
+    paramsel->addOpt("lambdas", new OptMatrix<gMat2D<T> >(*lambdas));
+    paramsel->addOpt("sigma", new OptNumber(sigma));
+    opt->addOpt("paramsel", paramsel);
+
+    GurlsOptionsList* kernel = new GurlsOptionsList("kernel");
+    kernel->addOpt("type", "rbf");
+    opt->addOpt("kernel", kernel);
+
+    opt->getOptValue<OptNumber>("nsigma") = 1;
+    opt->getOptValue<OptNumber>("sparsegp.m") = n;
+    opt->getOptValue<OptString>("hoperf") = "rmse";
+
+    return opt;
+}
+
+/**
+ * Trains the optimizer on (X, y) and returns the predictive means and variances on Xte
+ */
+void trainAndPredict(Optimizer<T>& optimizer, const gMat2D<T>& X, const gMat2D<T>& y, const gMat2D<T>& Xte,
+                     GurlsOptionsList& opt, gMat2D<T>& means, gMat2D<T>& vars)
+{
+    opt.removeOpt("optimizer");
+    opt.addOpt("optimizer", optimizer.execute(X, y, opt));
+
+    const gMat2D<T> empty;
+    PredKernelTrainTest<T> predkernel;
+    opt.removeOpt("predkernel");
+    opt.addOpt("predkernel", predkernel.execute(Xte, empty, opt));
+
+    PredGPRegr<T> pred;
+    GurlsOptionsList* result = pred.execute(Xte, empty, opt);
+    const gMat2D<T>& resultMeans = result->getOptValue<OptMatrix<gMat2D<T> > >("means");
+    const gMat2D<T>& resultVars = result->getOptValue<OptMatrix<gMat2D<T> > >("vars");
+    means.resize(resultMeans.rows(), resultMeans.cols());
+    means = resultMeans;
+    vars.resize(resultVars.rows(), resultVars.cols());
+    vars = resultVars;
+    delete result;
+}
+
+void addExactKernel(const gMat2D<T>& X, const gMat2D<T>& y, GurlsOptionsList& opt)
+{
+    KernelRBF<T> rbf;
+    GurlsOptionsList* kernel = rbf.execute(X, y, opt);
+    opt.removeOpt("kernel");
+    opt.addOpt("kernel", kernel);
+}
+
+}
+
+BOOST_AUTO_TEST_CASE(AllInducingPointsMatchExactGP)
+{
+    const unsigned long n = 60, nte = 25;
+    gMat2D<T> X, y, Xte, yte;
+    makeProblem(0, n, X, y);
+    makeProblem(n, nte, Xte, yte);
+
+    GurlsOptionsList* exactOpt = makeOptions(n);
+    addExactKernel(X, y, *exactOpt);
+
+    gMat2D<T> means, vars;
+    RLSGPRegr<T> exact;
+    trainAndPredict(exact, X, y, Xte, *exactOpt, means, vars);
+
+    const char* approximations[] = {"fitc", "dtc"};
+    for(int a=0; a<2; ++a)
+    {
+        GurlsOptionsList* sparseOpt = makeOptions(n);
+        sparseOpt->getOptValue<OptString>("sparsegp.approx") = approximations[a];
+
+        gMat2D<T> sparseMeans, sparseVars;
+        RLSSparseGPRegr<T> sparse;
+        trainAndPredict(sparse, X, y, Xte, *sparseOpt, sparseMeans, sparseVars);
+
+        BOOST_REQUIRE_EQUAL(sparseMeans.rows(), nte);
+        BOOST_REQUIRE_EQUAL(sparseVars.rows(), nte);
+        for(unsigned long i=0; i<nte; ++i)
+        {
+            BOOST_CHECK_SMALL(sparseMeans.getData()[i] - means.getData()[i], 1e-5);
+            BOOST_CHECK_SMALL(sparseVars.getData()[i] - vars.getData()[i], 1e-5);
+        }
+
+        delete sparseOpt;
+    }
+
+    delete exactOpt;
+}
+
+BOOST_AUTO_TEST_CASE(InconsistentSizesThrow)
+{
+    const unsigned long n = 20;
+    gMat2D<T> X, y;
+    makeProblem(0, n, X, y);
+
+    GurlsOptionsList* opt = makeOptions(n);
+    gMat2D<T> means, vars;
+    RLSSparseGPRegr<T> sparse;
+    trainAndPredict(sparse, X, y, X, *opt, means, vars);
+
+    // a test kernel with a different number of rows than the test samples
+    gMat2D<T> Xte;
+    makeProblem(n, 5, Xte, y);
+    const gMat2D<T> empty;
+    PredGPRegr<T> pred;
+    BOOST_CHECK_THROW(pred.execute(Xte, empty, *opt), gException);
+
+    delete opt;
+}
+
+BOOST_AUTO_TEST_CASE(HoldOutSelectionMatchesExactGP)
+{
+    const unsigned long n = 80;
+    gMat2D<T> X, y;
+    makeProblem(0, n, X, y);
+
+    GurlsOptionsList* opt = makeOptions(n);
+    opt->getOptValue<OptNumber>("nlambda") = 8;
+    opt->getOptValue<OptNumber>("nholdouts") = 2;
+
+    // noise levels well above the jitter added to Kmm by the sparse estimator
+    opt->addOpt("lambdamin", new OptNumber(0.02));
+    opt->addOpt("lambdamax", new OptNumber(2));
+
+    SplitHo<T> split;
+    opt->addOpt("split", split.execute(X, y, *opt));
+
+    // the sparse selection only needs the kernel type
+    ParamSelHoSparseGPRegr<T> sparseSelection;
+    GurlsOptionsList* sparseParamsel = sparseSelection.execute(X, y, *opt);
+
+    addExactKernel(X, y, *opt);
+    ParamSelHoGPRegr<T> exactSelection;
+    GurlsOptionsList* exactParamsel = exactSelection.execute(X, y, *opt);
+
+    const gMat2D<T>& sparsePerf = sparseParamsel->getOptValue<OptMatrix<gMat2D<T> > >("perf");
+    const gMat2D<T>& exactPerf = exactParamsel->getOptValue<OptMatrix<gMat2D<T> > >("perf");
+    BOOST_REQUIRE_EQUAL(sparsePerf.getSize(), exactPerf.getSize());
+    for(unsigned long i=0; i<exactPerf.getSize(); ++i)
+        BOOST_CHECK_SMALL(sparsePerf.getData()[i] - exactPerf.getData()[i], 1e-5);
+
+    // the guess with the best median validation accuracy of the exact GP over the two holdouts
+    const T* guesses = exactParamsel->getOptValue<OptMatrix<gMat2D<T> > >("guesses").getData();
+    unsigned long best = 0;
+    for(unsigned long j=1; j<8; ++j)
+        if(exactPerf.getData()[2*j] + exactPerf.getData()[2*j+1] > exactPerf.getData()[2*best] + exactPerf.getData()[2*best+1])
+            best = j;
+
+    BOOST_CHECK_CLOSE(sparseParamsel->getOptValue<OptMatrix<gMat2D<T> > >("lambdas").getData()[0], guesses[2*best], 1e-8);
+    BOOST_CHECK_EQUAL(sparseParamsel->getOptAsNumber("sigma"), sigma);
+
+    delete sparseParamsel;
+    delete exactParamsel;
+    delete opt;
+}
+
+BOOST_AUTO_TEST_CASE(WrapperSelectsWithSparseEstimator)
+{
+    const unsigned long n = 300, nte = 50;
+    gMat2D<T> X, y, Xte, yte;
+    makeProblem(0, n, X, y);
+    makeProblem(n, nte, Xte, yte);
+
+    GPRWrapper<T> wrapper("sparsegp");
+    wrapper.setProblemType(GPRWrapper<T>::REGRESSION);
+    wrapper.setGPMode(GPRWrapper<T>::FITC);
+    wrapper.setNInducing(40);
+    wrapper.setNparams(6);
+    wrapper.setNSigma(4);
+    wrapper.train(X, y);
+
+    // the selection ran on the sparse estimator, without the n-by-n kernel matrix
+    const GurlsOptionsList& opt = wrapper.getOpt();
+    BOOST_CHECK(!opt.hasOpt("kernel.K"));
+    BOOST_CHECK(opt.hasOpt("paramsel.sigma"));
+    BOOST_CHECK_EQUAL(opt.getOptValue<OptMatrix<gMat2D<T> > >("paramsel.perf").cols(), 4ul*6ul);
+    BOOST_CHECK_EQUAL(opt.getOptValue<OptMatrix<gMat2D<T> > >("optimizer.X").rows(), 40ul);
+
+    gMat2D<T>* pred = wrapper.eval(Xte);
+    T err = 0, var = 0;
+    for(unsigned long i=0; i<nte; ++i)
+    {
+        err += (pred->getData()[i] - yte.getData()[i])*(pred->getData()[i] - yte.getData()[i]);
+        var += yte.getData()[i]*yte.getData()[i];
+    }
+    BOOST_CHECK_LT(err, 0.1*var);
+    delete pred;
+
+    std::remove("sparsegp.bin");
+}
@@ -0,0 +1,138 @@
+/*
+ * The GURLS Package in C++
+ *
+ * Copyright (C) 2011-1013, IIT@MIT Lab
+ * All rights reserved.
+ *
+ * authors:  M. Santoro
+ * email:   msantoro@mit.edu
+ * website: http://cbcl.mit.edu/IIT@MIT/IIT@MIT.html
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ *     * Redistributions of source code must retain the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials
+ *       provided with the distribution.
+ *     * Neither the name(s) of the copyright holders nor the names
+ *       of its contributors or of the Massacusetts Institute of
+ *       Technology or of the Italian Institute of Technology may be
+ *       used to endorse or promote products derived from this software
+ *       without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/**
+ * \file
+ * Converts a training set stored as a pair of CSV files, in the format read by
+ * gMat2D::readCSV(), into a dataset file readable by DatasetChunkReader.
+ * The CSV files are read one chunk at a time, hence their size is not limited
+ * by the available memory.
+ *
+ * Usage: csv2dataset Xfile yfile outfile [-float] [-rows] [-nostats] [-chunk N]
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "gurls++/dataset.h"
+#include "gurls++/chunkreader.h"
+#include "gurls++/exceptions.h"
+
+using namespace gurls;
+using namespace std;
+
+static void usage(const char* name)
+{
+    cout << "Usage: " << name << " Xfile yfile outfile [-float] [-rows] [-nostats] [-chunk N]" << endl;
+    cout << "  Xfile     CSV file of the inputs, one sample per line" << endl;
+    cout << "  yfile     CSV file of the outputs, one sample per line" << endl;
+    cout << "  outfile   dataset file to be written" << endl;
+    cout << "  -float    store single precision values (default: double)" << endl;
+    cout << "  -rows     store the samples of every chunk by rows (default: by columns)" << endl;
+    cout << "  -nostats  do not store the means and the standard deviations of the columns" << endl;
+    cout << "  -chunk N  number of samples per chunk (default: 65536)" << endl;
+}
+
+template <typename T>
+static unsigned long convert(const string& Xfile, const string& yfile, const string& outFile,
+                             unsigned long chunkRows, DatasetFileHeader::Layout layout, bool stats)
+{
+    CSVChunkReader<T> reader(Xfile, yfile);
+
+    DatasetWriter<T> writer(outFile, reader.cols(), reader.outputs(), chunkRows, layout, stats);
+    writer.write(reader);
+    writer.close();
+
+    DatasetChunkReader<T> check(outFile);
+    return check.rows();
+}
+
+int main(int argc, char* argv[])
+{
+    if(argc < 4)
+    {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    bool singlePrecision = false;
+    bool stats = true;
+    unsigned long chunkRows = 65536;
+    DatasetFileHeader::Layout layout = DatasetFileHeader::COLUMN_CHUNKS;
+
+    for(int i=4; i<argc; ++i)
+    {
+        if(!strcmp(argv[i], "-float"))
+            singlePrecision = true;
+        else if(!strcmp(argv[i], "-rows"))
+            layout = DatasetFileHeader::ROW_CHUNKS;
+        else if(!strcmp(argv[i], "-nostats"))
+            stats = false;
+        else if(!strcmp(argv[i], "-chunk") && i+1 < argc && atol(argv[i+1]) > 0)
+            chunkRows = atol(argv[++i]);
+        else
+        {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try
+    {
+        unsigned long rows;
+
+        if(singlePrecision)
+            rows = convert<float>(argv[1], argv[2], argv[3], chunkRows, layout, stats);
+        else
+            rows = convert<double>(argv[1], argv[2], argv[3], chunkRows, layout, stats);
+
+        cout << "Written " << rows << " samples to " << argv[3] << endl;
+    }
+    catch (gException& e)
+    {
+        cout << e.getMessage() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}